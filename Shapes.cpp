@@ -4,7 +4,7 @@
 Shape::Shape(String _name) : name(_name) {}
 void Shape::printDetails(bool shouldPrint) {
   if (!shouldPrint) return;
-  writeLog("Shape: Name = %s", name.c_str());
+  LOG_D(UI, "Shape: Name = %s", name.c_str());
 }
 
 // Rectangle implementation
@@ -18,7 +18,7 @@ bool Rectangle::isTouched(int16_t touchX, int16_t touchY) {
 void Rectangle::printDetails(bool shouldPrint) {
   if (!shouldPrint) return;
   Shape::printDetails(shouldPrint);
-  writeLog("Rectangle: X=%d, Y=%d, Width=%d, Height=%d", x, y, width, height);
+  LOG_D(UI, "Rectangle: X=%d, Y=%d, Width=%d, Height=%d", x, y, width, height);
 }
 
 // Ellipse implementation
@@ -33,7 +33,7 @@ bool Ellipse::isTouched(int16_t touchX, int16_t touchY) {
 void Ellipse::printDetails(bool shouldPrint) {
   if (!shouldPrint) return;
   Shape::printDetails(shouldPrint);
-  writeLog("Ellipse: CenterX=%d, CenterY=%d, a=%d, b=%d", centerX, centerY, a, b);
+  LOG_D(UI, "Ellipse: CenterX=%d, CenterY=%d, a=%d, b=%d", centerX, centerY, a, b);
 }
 
 // Circle implementation
@@ -49,5 +49,5 @@ bool Circle::isTouched(int16_t touchX, int16_t touchY) {
 void Circle::printDetails(bool shouldPrint) {
   if (!shouldPrint) return;
   Shape::printDetails(shouldPrint);
-  writeLog("Circle: CenterX=%d, CenterY=%d, Radius=%d", centerX, centerY, radius);
+  LOG_D(UI, "Circle: CenterX=%d, CenterY=%d, Radius=%d", centerX, centerY, radius);
 }
@@ -0,0 +1,139 @@
+#include "block_pool.h"
+#include "draw_functions.h" // For writeLog
+#include "esp_heap_caps.h"
+#include "heap_tags.h"
+#include <WiFiClient.h>
+#include <HTTPClient.h>
+#include "telemetry.h"
+
+BlockPool netBufferPool;
+BlockPool netClientPool;
+BlockPool telemetryPool;
+
+static const size_t BLOCK_ALIGN = 8;
+
+BlockPool::BlockPool()
+  : poolName("unset"), storage(nullptr), blockSize(0), blockCount(0), freeList(nullptr),
+    inUse(0), peakInUse(0), allocs(0), fails(0), lock(portMUX_INITIALIZER_UNLOCKED)
+{
+}
+
+bool BlockPool::begin(const char *name, size_t size, uint16_t count)
+{
+  if (storage)
+    return true;
+
+  poolName = name;
+  blockSize = (max(size, sizeof(FreeBlock)) + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+  blockCount = count;
+
+  // Internal RAM so the blocks are usable for socket I/O
+  storage = (uint8_t *)tagged_malloc_caps(blockSize * blockCount, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!storage)
+  {
+    writeLog("[POOL] %s: failed to reserve %u bytes", poolName, (unsigned)(blockSize * blockCount));
+    blockCount = 0;
+    return false;
+  }
+
+  // Thread every block onto the free list
+  freeList = nullptr;
+  for (int i = blockCount - 1; i >= 0; i--)
+  {
+    FreeBlock *block = (FreeBlock *)(storage + (size_t)i * blockSize);
+    block->next = freeList;
+    freeList = block;
+  }
+  return true;
+}
+
+void *BlockPool::alloc()
+{
+  portENTER_CRITICAL(&lock);
+  FreeBlock *block = freeList;
+  if (block)
+  {
+    freeList = block->next;
+    inUse++;
+    allocs++;
+    if (inUse > peakInUse)
+      peakInUse = inUse;
+  }
+  else
+  {
+    fails++;
+  }
+  portEXIT_CRITICAL(&lock);
+
+  if (!block)
+  {
+    writeLog("[POOL] %s exhausted (%u blocks in use)", poolName, (unsigned)blockCount);
+  }
+  return block;
+}
+
+void BlockPool::release(void *ptr)
+{
+  if (!ptr)
+    return;
+
+  if (!owns(ptr))
+  {
+    writeLog("[POOL] %s: release of foreign pointer %p ignored", poolName, ptr);
+    return;
+  }
+
+  portENTER_CRITICAL(&lock);
+  FreeBlock *block = (FreeBlock *)ptr;
+  block->next = freeList;
+  freeList = block;
+  inUse--;
+  portEXIT_CRITICAL(&lock);
+}
+
+bool BlockPool::owns(const void *ptr) const
+{
+  const uint8_t *p = (const uint8_t *)ptr;
+  return storage && p >= storage && p < storage + blockSize * blockCount &&
+         (size_t)(p - storage) % blockSize == 0;
+}
+
+void BlockPool::getStats(BlockPoolStats &stats) const
+{
+  portENTER_CRITICAL(&lock);
+  stats.name = poolName;
+  stats.blockSize = blockSize;
+  stats.blockCount = blockCount;
+  stats.inUse = inUse;
+  stats.peakInUse = peakInUse;
+  stats.allocs = allocs;
+  stats.fails = fails;
+  portEXIT_CRITICAL(&lock);
+}
+
+bool initMemoryPools()
+{
+  HeapTagScope heapTag(HEAP_TAG_NETWORK); // Every pool feeds the network task
+  size_t clientBlockSize = max(sizeof(WiFiClient), sizeof(HTTPClient));
+  bool ok = netBufferPool.begin("net_buf", NET_BUFFER_BLOCK_SIZE, NET_BUFFER_BLOCK_COUNT);
+  ok = netClientPool.begin("net_client", clientBlockSize, NET_CLIENT_BLOCK_COUNT) && ok;
+  ok = telemetryPool.begin("telemetry", TELEMETRY_BATCH_BUFFER_SIZE, TELEMETRY_BLOCK_COUNT) && ok;
+  logMemoryPools();
+  return ok;
+}
+
+void logMemoryPools()
+{
+  BlockPool *pools[] = { &netBufferPool, &netClientPool, &telemetryPool };
+  for (BlockPool *pool : pools)
+  {
+    BlockPoolStats stats;
+    pool->getStats(stats);
+    LOG_I(MEM, "[POOL] %s - Block: %u x %u, In use: %u, Peak: %u, Allocs: %lu, Fails: %lu",
+      stats.name, (unsigned)stats.blockSize, (unsigned)stats.blockCount, (unsigned)stats.inUse,
+      (unsigned)stats.peakInUse, (unsigned long)stats.allocs, (unsigned long)stats.fails);
+  }
+  LOG_I(MEM, "[POOL] Heap - Free: %u, Largest block: %u",
+    (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+    (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+}
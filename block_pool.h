@@ -0,0 +1,65 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+
+// Fixed-block memory pools.
+// Each pool grabs one contiguous region at boot and hands out equal-sized blocks
+// from a free list, so the camera and telemetry paths never call malloc/new per
+// request and cannot fragment the heap. Alloc/release are O(1) and safe to call
+// from any task. Every pool keeps its own accounting (in use, peak, failures).
+
+struct BlockPoolStats
+{
+  const char *name;
+  uint16_t blockSize;
+  uint16_t blockCount;
+  uint16_t inUse;
+  uint16_t peakInUse;
+  uint32_t allocs;
+  uint32_t fails;     // alloc() calls that found the pool exhausted
+};
+
+class BlockPool
+{
+public:
+  BlockPool();
+  bool begin(const char *name, size_t blockSize, uint16_t blockCount); // Call once at boot
+  void *alloc();               // nullptr when exhausted - never falls back to the heap
+  void release(void *block);   // nullptr is ignored
+  bool owns(const void *block) const;
+  void getStats(BlockPoolStats &stats) const;
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  const char *poolName;
+  uint8_t *storage;
+  size_t blockSize;
+  uint16_t blockCount;
+  FreeBlock *freeList;
+  uint16_t inUse;
+  uint16_t peakInUse;
+  uint32_t allocs;
+  uint32_t fails;
+  mutable portMUX_TYPE lock;
+};
+
+// Pool sizing - one region each, allocated by initMemoryPools()
+#define NET_BUFFER_BLOCK_SIZE 512   // Request/response bodies and upload record scratch
+#define NET_BUFFER_BLOCK_COUNT 6
+#define NET_CLIENT_BLOCK_COUNT 2    // The keep-alive WiFiClient and HTTPClient
+#define TELEMETRY_BLOCK_COUNT 1     // One batch body (TELEMETRY_BATCH_BUFFER_SIZE) in flight
+
+extern BlockPool netBufferPool;
+extern BlockPool netClientPool;
+extern BlockPool telemetryPool;
+
+bool initMemoryPools();  // Call from setup() before any task uses a pool
+void logMemoryPools();   // Per-pool accounting plus the heap's largest free block
+
+#endif // BLOCK_POOL_H
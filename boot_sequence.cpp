@@ -0,0 +1,140 @@
+#include "boot_sequence.h"
+#include "draw_functions.h" // For writeLog
+#include "status_server.h"
+#include "settings_system.h"
+#include "time_service.h"
+#include "heap_tags.h"
+#include <WiFi.h>
+#include <time.h>
+
+extern SettingsSystem flushSettings;
+
+static const char *BOOT_STAGE_NAMES[BOOT_STAGE_COUNT] = {
+  "serial", "relays", "lcd", "tft", "settings", "first_frame", "network_task", "wifi", "sntp"
+};
+
+// Microseconds since reset (raw esp_timer, independent of the mono clock offset)
+static uint64_t stageStartUs[BOOT_STAGE_COUNT];
+static uint64_t stageEndUs[BOOT_STAGE_COUNT];
+static bool wifiStarted = false;
+static bool wifiSlowLogged = false;
+static bool timingsLogged = false;
+
+static uint64_t sinceResetUs()
+{
+  return monoMicros() - MONO_CLOCK_START_OFFSET_MS * 1000ULL;
+}
+
+void bootStageBegin(BootStage stage)
+{
+  stageStartUs[stage] = sinceResetUs();
+  stageEndUs[stage] = 0;
+}
+
+void bootStageEnd(BootStage stage)
+{
+  stageEndUs[stage] = sinceResetUs();
+  writeLog("[BOOT] %s ready in %lums (T+%lums)", BOOT_STAGE_NAMES[stage],
+    (unsigned long)getBootStageMs(stage), (unsigned long)getBootStageEndMs(stage));
+}
+
+void startBackgroundNetwork(const char *ssid, const char *password)
+{
+  writeLog("Connecting to WiFi in the background...");
+  bootStageBegin(BOOT_WIFI);
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(true); // Keep the association alive instead of tearing it down
+  WiFi.begin(ssid, password);
+  wifiStarted = true;
+}
+
+void serviceBoot()
+{
+  if (!wifiStarted || timingsLogged)
+    return;
+  HeapTagScope heapTag(HEAP_TAG_NETWORK);
+
+  if (stageEndUs[BOOT_WIFI] == 0)
+  {
+    if (WiFi.status() != WL_CONNECTED)
+    {
+      if (!wifiSlowLogged && sinceResetUs() - stageStartUs[BOOT_WIFI] > BOOT_WIFI_SLOW_MS * 1000ULL)
+      {
+        writeLog("[BOOT] WiFi not connected after %ds - running offline, still retrying", BOOT_WIFI_SLOW_MS / 1000);
+        wifiSlowLogged = true;
+      }
+      return;
+    }
+
+    bootStageEnd(BOOT_WIFI);
+    writeLog("WiFi connected!");
+    writeLog("IP: %s", WiFi.localIP().toString().c_str());
+    startStatusServer();
+    if (!flushSettings.isSettingsVisible())
+    {
+      drawFlowDetails(); // Refresh the IP line
+    }
+
+    // Configure NTP for Pacific Time (handles PST/PDT automatically)
+    bootStageBegin(BOOT_SNTP);
+    configTime(-8 * 3600, 3600, "pool.ntp.org", "time.nist.gov");
+    writeLog("NTP time sync initiated (Pacific Time)");
+    return;
+  }
+
+  if (stageEndUs[BOOT_SNTP] == 0)
+  {
+    if (!timeServiceSynced())
+      return;
+
+    bootStageEnd(BOOT_SNTP);
+    time_t now = time(nullptr);
+    struct tm *timeinfo = localtime(&now);
+    writeLog("Time synchronized: %04d-%02d-%02d %02d:%02d:%02d",
+      timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
+      timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
+  }
+
+  logBootTimings();
+  timingsLogged = true;
+}
+
+bool bootComplete()
+{
+  for (int i = 0; i < BOOT_STAGE_COUNT; i++)
+  {
+    if (stageEndUs[i] == 0)
+      return false;
+  }
+  return true;
+}
+
+uint32_t getBootStageMs(BootStage stage)
+{
+  if (stageEndUs[stage] == 0)
+    return 0;
+  return (uint32_t)((stageEndUs[stage] - stageStartUs[stage]) / 1000);
+}
+
+uint32_t getBootStageEndMs(BootStage stage)
+{
+  return (uint32_t)(stageEndUs[stage] / 1000);
+}
+
+void logBootTimings()
+{
+  writeLog("[BOOT] === BOOT TIMINGS (ms from reset) ===");
+  for (int i = 0; i < BOOT_STAGE_COUNT; i++)
+  {
+    if (stageEndUs[i] == 0)
+    {
+      writeLog("[BOOT] %-13s pending", BOOT_STAGE_NAMES[i]);
+    }
+    else
+    {
+      writeLog("[BOOT] %-13s took %5lu, done at T+%lu", BOOT_STAGE_NAMES[i],
+        (unsigned long)getBootStageMs((BootStage)i), (unsigned long)getBootStageEndMs((BootStage)i));
+    }
+  }
+  writeLog("[BOOT] Time to first frame: %lums", (unsigned long)getBootStageEndMs(BOOT_FIRST_FRAME));
+}
@@ -0,0 +1,43 @@
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Arduino.h>
+
+// Boot orchestration.
+// setup() brings up the local hardware (relays, LCD, TFT, settings, UI) straight
+// away and only *starts* WiFi. Association, the status server and SNTP are then
+// advanced from serviceBoot() in loop(), so the rig shows its UI in well under a
+// second and runs normally without WiFi. Every stage records its duration from
+// reset so time-to-first-frame can be tracked across firmware changes.
+
+// Optional wait for a USB serial monitor to attach before the first log line
+#ifndef BOOT_SERIAL_WAIT_MS
+#define BOOT_SERIAL_WAIT_MS 0
+#endif
+
+#define BOOT_WIFI_SLOW_MS 15000 // Log (once) when association takes longer than this
+
+enum BootStage
+{
+  BOOT_SERIAL,
+  BOOT_RELAYS,
+  BOOT_LCD,
+  BOOT_TFT,
+  BOOT_SETTINGS,
+  BOOT_FIRST_FRAME,
+  BOOT_NETWORK_TASK,
+  BOOT_WIFI,          // Background - WiFi.begin() to connected
+  BOOT_SNTP,          // Background - connected to first valid wall clock
+  BOOT_STAGE_COUNT
+};
+
+void bootStageBegin(BootStage stage);
+void bootStageEnd(BootStage stage);
+void startBackgroundNetwork(const char *ssid, const char *password); // Non-blocking WiFi.begin()
+void serviceBoot();        // Call every loop() - advances WiFi/SNTP bring-up
+bool bootComplete();       // Every stage, including the background ones, has finished
+uint32_t getBootStageMs(BootStage stage);    // Duration, 0 while pending
+uint32_t getBootStageEndMs(BootStage stage); // Time from reset to stage end, 0 while pending
+void logBootTimings();
+
+#endif // BOOT_SEQUENCE_H
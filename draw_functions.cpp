@@ -2,8 +2,13 @@
 #include "settings_system.h"
 #include <LiquidCrystal_I2C.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
 #include <TJpg_Decoder.h>
+#include "network_task.h"
+#include "block_pool.h"
+#include "telemetry.h"
+#include "event_bus.h"
+#include "heap_tags.h"
+#include "memory_trend.h"
 #include <time.h>
 #include "esp_heap_caps.h"
 #include "esp_log.h"
@@ -30,7 +35,7 @@ enum AnimationType
 // External references
 extern LiquidCrystal_I2C lcd;
 extern int flushCount;
-extern unsigned long workflowStartTime;
+extern uint64_t workflowStartTime;
 extern int currentLCDState;
 extern int totalWasteML;
 const int LCD_RUNNING = 5;
@@ -40,14 +45,12 @@ extern int leftFlushCount;
 extern int rightFlushCount;
 extern int imageCount;
 extern int totalWasteML;
-extern unsigned long workflowStartTime;
+extern uint64_t workflowStartTime;
 
 // Function declarations
-void incrementWasteCounter();
 void incrementLeftFlushCounter();
 void incrementRightFlushCounter();
 void incrementImageCounter();
-void incrementWasteCounter();
 void updateLCDDisplay();
 void generateFlushCountString(char *buffer, size_t bufferSize);
 void generateDurationString(char *buffer, size_t bufferSize);
@@ -57,7 +60,6 @@ extern const char *left02CameraID;
 extern const char *right01CameraID;
 extern const char *right02CameraID;
 extern const char *uploadServerURL;
-String queueCameraRequest(const char *cameraID, const char *imagePrefix);
 
 // Array of camera IDs that should flip vertically
 const char* cameraIDsToFlipVert[] = {
@@ -66,48 +68,18 @@ const char* cameraIDsToFlipVert[] = {
 };
 const int numCamerasToFlip = sizeof(cameraIDsToFlipVert) / sizeof(cameraIDsToFlipVert[0]);
 extern const unsigned long BUTTON_DEBOUNCE_MS;
-extern unsigned long lastButtonPress;
+extern uint64_t lastButtonPress;
 extern SettingsSystem flushSettings;
 extern bool _debugPrintShapeDetails;
-extern HTTPClient* httpClient;
-extern bool wifiNeedsRecreation;
-extern unsigned long lastRightCameraCapture;
 extern int completedWorkflowCycles;
 extern bool firstAnalysisComplete;
-extern unsigned long lastMemoryAnalysis;
+extern uint64_t lastMemoryAnalysis;
 
 // WiFi credentials - external references
 extern const char *ssid;
 extern const char *password;
 
 
-// Logging function for workflow steps - memory optimized
-void writeLog(const char *format, ...)
-{
-  char buffer[256]; // Fixed size buffer to prevent dynamic allocation
-  va_list args;
-  va_start(args, format);
-  vsnprintf(buffer, sizeof(buffer), format, args);
-  va_end(args);
-  
-  // Get actual local server time
-  time_t now = time(0);
-  struct tm *timeinfo = localtime(&now);
-  
-  // Format: YYMMDD.HH:MM:SS.zzz - log message
-  Serial.printf("%02d%02d%02d.%02d:%02d:%02d.%03lu - %s\n", 
-    (timeinfo->tm_year + 1900) % 100,  // YY (last 2 digits of year)
-    timeinfo->tm_mon + 1,              // MM (month 1-12)
-    timeinfo->tm_mday,                 // DD (day 1-31)
-    timeinfo->tm_hour,                 // HH (hour 0-23)
-    timeinfo->tm_min,                  // MM (minute 0-59)
-    timeinfo->tm_sec,                  // SS (second 0-59)
-    millis() % 1000,                   // zzz (milliseconds from system)
-    buffer);
-  
-  // Don't store logs in dynamic memory - just output immediately
-}
-
 // Shared method to generate flush count string in L0000 | R0000 format
 void generateFlushCountString(char *buffer, size_t bufferSize)
 {
@@ -119,13 +91,13 @@ void generateDurationString(char *buffer, size_t bufferSize)
 {
   if (workflowStartTime > 0)
   {
-    unsigned long runtime = (_currentTime - workflowStartTime) / 1000; // seconds
-    int days = runtime / 86400;
+    uint64_t runtime = (_currentTime - workflowStartTime) / 1000; // seconds
+    int days = (int)(runtime / 86400);
     runtime %= 86400;
-    int hours = runtime / 3600;
+    int hours = (int)(runtime / 3600);
     runtime %= 3600;
-    int minutes = runtime / 60;
-    int seconds = runtime % 60;
+    int minutes = (int)(runtime / 60);
+    int seconds = (int)(runtime % 60);
     snprintf(buffer, bufferSize, "%03dDays %02d:%02d:%02d", days, hours, minutes, seconds);
   }
   else
@@ -136,8 +108,8 @@ void generateDurationString(char *buffer, size_t bufferSize)
 
 // Shared method to calculate total gallons based on settings
 float calculateTotalGallons() {
-  int leftOz = flushSettings.getLeftToiletWaterOz();
-  int rightOz = flushSettings.getRightToiletWaterOz();
+  int leftOz = settingsSnapshot().leftWaterOz;
+  int rightOz = settingsSnapshot().rightWaterOz;
   
   float leftGallons = (leftFlushCount * leftOz) / 128.0; // 128 oz = 1 gallon
   float rightGallons = (rightFlushCount * rightOz) / 128.0;
@@ -148,36 +120,36 @@ float calculateTotalGallons() {
 void incrementLeftFlushCounter()
 {
   leftFlushCount++;
-  unsigned long timestamp = millis();
-  writeLog("[COUNT] LEFT FLUSH #%d at T:%lu", leftFlushCount, timestamp);
-  updateLCDDisplay();
+  uint64_t timestamp = monoMillis();
+  writeLog("[COUNT] LEFT FLUSH #%d at T:%llu", leftFlushCount, timestamp);
+  eventPublish(APP_EVENT_FLUSH, Left, leftFlushCount);
 }
 
 void incrementRightFlushCounter()
 {
   rightFlushCount++;
-  unsigned long timestamp = millis();
-  writeLog("[COUNT] RIGHT FLUSH #%d at T:%lu", rightFlushCount, timestamp);
-  updateLCDDisplay();
+  uint64_t timestamp = monoMillis();
+  writeLog("[COUNT] RIGHT FLUSH #%d at T:%llu", rightFlushCount, timestamp);
+  eventPublish(APP_EVENT_FLUSH, Right, rightFlushCount);
 }
 
 void incrementImageCounter()
 {
   imageCount++;
   writeLog("[COUNT] Image: %d", imageCount);
-  updateLCDDisplay();
-  drawFlowDetails();
+  eventPublish(APP_EVENT_IMAGE, TELEMETRY_SIDE_NONE, imageCount);
 }
 
-void incrementWasteCounterInternal()
+static void addWasteDose(Location location)
 {
-  totalWasteML += flushSettings.getWasteQtyPerFlush();
-  writeLog("[COUNT] Waste: %dml (incremented by %dml)", totalWasteML, flushSettings.getWasteQtyPerFlush());
-  incrementWasteCounter(); // Call the main file function to update LCD
+  int doseMl = settingsSnapshot().wasteQtyMl;
+  totalWasteML += doseMl;
+  writeLog("[COUNT] Waste: %dml (incremented by %dml)", totalWasteML, doseMl);
+  eventPublish(APP_EVENT_WASTE_DOSE, location, doseMl);
 }
 
 // Static variables to track timer display updates
-static unsigned long _lastTimerUpdate = 0;
+static uint64_t _lastTimerUpdate = 0;
 static int _lastLeftSeconds = -1;
 static int _lastRightSeconds = -1;
 static bool wasteRepoCompletedLeft = false;
@@ -193,10 +165,10 @@ static bool wasteRepoRightTriggered = false;
 
 // Master clock recalibration system
 struct WorkflowSchedule {
-  unsigned long leftNextFlushTime;
-  unsigned long rightNextFlushTime;
-  unsigned long absoluteWorkflowStart;
-  unsigned long lastRecalibration;
+  uint64_t leftNextFlushTime;
+  uint64_t rightNextFlushTime;
+  uint64_t absoluteWorkflowStart;
+  uint64_t lastRecalibration;
 };
 
 static WorkflowSchedule schedule = {0, 0, 0, 0};
@@ -206,23 +178,23 @@ static const long DRIFT_THRESHOLD_MS = 2000; // 2 seconds
 
 // Dual camera capture state variables
 static bool pendingSecondCapture = false;
-static unsigned long secondCaptureTime = 0;
+static uint64_t secondCaptureTime = 0;
 static const char *pendingCameraID = nullptr;
-static String pendingImagePrefix = "";
+static char pendingImagePrefix[64] = "";
 static Location pendingCaptureLocation = Left;
 static bool isAutomaticCapture = false;
 
 // Camera delay timing variables
 static bool _leftCameraDelayActive = false;
 static bool _rightCameraDelayActive = false;
-static unsigned long _leftCameraDelayStartTime = 0;
-static unsigned long _rightCameraDelayStartTime = 0;
+static uint64_t _leftCameraDelayStartTime = 0;
+static uint64_t _rightCameraDelayStartTime = 0;
 
 // Relay control variables
-static unsigned long relayT1StartTime = 0;
-static unsigned long relayT2StartTime = 0;
-static unsigned long relayP1StartTime = 0;
-static unsigned long relayP2StartTime = 0;
+static uint64_t relayT1StartTime = 0;
+static uint64_t relayT2StartTime = 0;
+static uint64_t relayP1StartTime = 0;
+static uint64_t relayP2StartTime = 0;
 static bool relayT1Active = false;
 static bool relayT2Active = false;
 static bool relayP1Active = false;
@@ -234,7 +206,7 @@ static bool relayP2Active = false;
 #define RELAY_T1_PIN 37
 #define RELAY_T2_PIN 38
 
-void activateRelay(int pin, unsigned long duration, unsigned long *startTime, bool *activeFlag)
+void activateRelay(int pin, uint32_t duration, uint64_t *startTime, bool *activeFlag)
 {
   digitalWrite(pin, HIGH);
   *startTime = _currentTime;
@@ -253,7 +225,7 @@ void updateRelays()
     digitalWrite(RELAY_T2_PIN, LOW);
     relayT2Active = false;
   }
-  int pumpActiveTimeMS = (flushSettings.getWasteQtyPerFlush() * 1000) / PUMP_WASTE_ML_SEC;
+  uint64_t pumpActiveTimeMS = settingsSnapshot().pumpDurationMs;
   if (relayP1Active && _currentTime - relayP1StartTime >= pumpActiveTimeMS)
   {
     digitalWrite(RELAY_P1_PIN, LOW);
@@ -266,83 +238,70 @@ void updateRelays()
   }
 }
 
-String queueCameraRequest(const char *cameraID, const char *imagePrefix)
-{
-  uint32_t memBefore = ESP.getFreeHeap();
-  
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    writeLog("[QUEUE] WiFi not connected!");
-    return "Error: WiFi not connected";
-  }
-
-  if (!httpClient) {
-    httpClient = new HTTPClient();
-    writeLog("[QUEUE] Created new HTTPClient");
-  }
-  
-  // Use char arrays instead of String concatenation
-  char url[256];
-  snprintf(url, sizeof(url), "%s", uploadServerURL);
-  char* lastSlash = strrchr(url, '/');
-  if (lastSlash) {
-    strcpy(lastSlash + 1, "queue_camera");
-  }
-  
-  writeLog("[QUEUE] Camera: %s, URL: %s", cameraID, url);
-
-  httpClient->begin(url);
-  httpClient->addHeader("Content-Type", "application/json");
-  httpClient->setTimeout(3000);
+// Camera status per side (main loop only)
+static CameraStatus cameraStatus[2] = {CAMERA_IDLE, CAMERA_IDLE};
+static uint32_t nextCaptureId = 1;
 
-  // Check if this camera should flip vertically
-  bool shouldFlip = false;
+static bool shouldFlipCamera(const char *cameraID)
+{
   for (int i = 0; i < numCamerasToFlip; i++) {
     if (strcmp(cameraID, cameraIDsToFlipVert[i]) == 0) {
-      shouldFlip = true;
-      break;
+      return true;
     }
   }
+  return false;
+}
 
-  // Use char array for payload
-  char payload[512];
-  snprintf(payload, sizeof(payload), "{\"camera_id\":\"%s\",\"image_prefix\":\"%s\",\"flip_vertical\":%s}", 
-    cameraID, imagePrefix, shouldFlip ? "true" : "false");
-  
-  int httpResponseCode = httpClient->POST(payload);
-  writeLog("[QUEUE] Response code: %d", httpResponseCode);
+static void addCameraTarget(CameraRequest &request, const char *cameraID, const char *imagePrefix)
+{
+  if (request.cameraCount >= MAX_CAMERAS_PER_STATION) return;
+  CameraTarget &camera = request.cameras[request.cameraCount++];
+  snprintf(camera.cameraID, sizeof(camera.cameraID), "%s", cameraID);
+  snprintf(camera.imagePrefix, sizeof(camera.imagePrefix), "%s", imagePrefix);
+  camera.flipVertical = shouldFlipCamera(cameraID);
+}
 
-  char response[128] = "";
-  if (httpResponseCode > 0)
-  {
-    // Use a fixed-size buffer to read the response stream directly
-    // This avoids heap allocation from httpClient->getString()
-    int len = httpClient->getSize();
-    if (len > 0 && len < sizeof(response)) {
-      httpClient->getStream().readBytes((uint8_t*)response, len);
-      response[len] = '\0'; // Null-terminate the string
-    }
-  }
-  else
-  {
-    snprintf(response, sizeof(response), "Queue failed: %d", httpResponseCode);
-    writeLog("[QUEUE] Failed: %d", httpResponseCode);
-  }
+// Completion callback - runs on the main loop via processNetworkResults()
+void onCameraRequestComplete(const CameraResult &result)
+{
+  const char *sideStr = (result.location == Left) ? "LEFT" : "RIGHT";
 
-  writeLog("[QUEUE] Response: %s", response);
+  writeLog("[CAMERA] Capture #%lu (%s) completed - %d/%d accepted, code %d, %d round trip(s) in %lums",
+    (unsigned long)result.captureId, sideStr, result.acceptedCount, result.cameraCount,
+    result.httpCode, result.roundTrips, (unsigned long)result.latencyMs);
 
-  // String objects are now tracked by ESP-IDF heap analysis
-  
-  uint32_t memAfter = ESP.getFreeHeap();
-  writeLog("[QUEUE] Memory - Before: %d After: %d", memBefore, memAfter);
-  
-  return String(response);
+  if (result.acceptedCount == result.cameraCount) {
+    cameraStatus[result.location] = CAMERA_OK;
+    telemetryRecord(EVT_CAPTURE_OK, result.location, result.captureId);
+    incrementImageCounter();
+  } else if (result.deferred) {
+    telemetryRecord(EVT_CAPTURE_DEFERRED, result.location, result.captureId);
+    // Stored in the durable upload queue - counted when the retry is accepted
+    cameraStatus[result.location] = CAMERA_PENDING;
+    writeLog("[CAMERA] Capture #%lu for %s side deferred - %d uploads pending",
+      (unsigned long)result.captureId, sideStr, getPendingUploads());
+    drawFlowDetails();
+  } else if (result.dropped) {
+    // Retryable, but neither the buffer pool nor the upload queue could keep it
+    cameraStatus[result.location] = CAMERA_ERROR;
+    telemetryRecord(EVT_CAPTURE_DROPPED, result.location, result.captureId);
+    writeLog("[CAMERA] Capture #%lu for %s side DROPPED - could not be stored for retry",
+      (unsigned long)result.captureId, sideStr);
+  } else {
+    cameraStatus[result.location] = CAMERA_ERROR;
+    telemetryRecord(EVT_CAPTURE_FAILED, result.location, result.httpCode);
+    writeLog("[CAMERA] Capture #%lu for %s side FAILED", (unsigned long)result.captureId, sideStr);
+  }
+}
+
+CameraStatus getCameraStatus(Location location)
+{
+  return cameraStatus[location];
 }
 
 void captureDualCameras(Location location, bool isAuto)
 {
-  uint32_t memBefore = ESP.getFreeHeap();
-  writeLog("[CAMERA] Starting dual capture - Free heap: %d bytes", memBefore);
+  writeLog("[CAMERA] Starting dual capture - Free heap: %d bytes", ESP.getFreeHeap());
   
   const char *camera01ID = (location == Left) ? left01CameraID : right01CameraID;
   const char *camera02ID = (location == Left) ? left02CameraID : right02CameraID;
@@ -368,7 +327,7 @@ void captureDualCameras(Location location, bool isAuto)
     sprintf(imagePrefix01, "%s_%s_%04d_%s_01", dateStr, timeStr, flushNumber, locationStr);
     sprintf(imagePrefix02, "%s_%s_%04d_%s_02", dateStr, timeStr, flushNumber, locationStr);
     writeLog("[CAMERA] Auto-capturing from both %s cameras (flush #%d, every %d flushes)", 
-      (location == Left ? "left" : "right"), flushNumber, flushSettings.getPicEveryNFlushes());
+      (location == Left ? "left" : "right"), flushNumber, settingsSnapshot().picEveryNFlushes);
   }
   else
   {
@@ -377,48 +336,48 @@ void captureDualCameras(Location location, bool isAuto)
     writeLog("[CAMERA] Manual capture from both %s cameras", (location == Left ? "left" : "right"));
   }
 
-  // Queue both cameras for capture
-  writeLog("[CAMERA] Queuing dual capture from %s cameras", locationStr);
-  
-  writeLog("[CAMERA] Queuing camera 1/2: %s (%s)", camera01ID, locationStr);
-  String queueResponse01 = queueCameraRequest(camera01ID, imagePrefix01);
-  writeLog("[CAMERA] Queue 1/2 response: %s", queueResponse01.c_str());
+  // Queue both cameras as one station request - the network task performs the POST
+  CameraRequest request;
+  memset(&request, 0, sizeof(request));
+  request.location = location;
+  request.captureId = nextCaptureId++;
+  request.queuedAtMs = monoMillis();
+  addCameraTarget(request, camera01ID, imagePrefix01);
+  addCameraTarget(request, camera02ID, imagePrefix02);
 
-  writeLog("[CAMERA] Queuing camera 2/2: %s (%s)", camera02ID, locationStr);
-  String queueResponse02 = queueCameraRequest(camera02ID, imagePrefix02);
-  writeLog("[CAMERA] Queue 2/2 response: %s", queueResponse02.c_str());
+  bool queued = submitCameraRequest(request);
+  cameraStatus[location] = queued ? CAMERA_PENDING : CAMERA_ERROR;
+  if (!queued)
+    telemetryRecord(EVT_CAPTURE_DROPPED, location, request.captureId);
 
-  writeLog("[CAMERA] Dual camera requests QUEUED for %s side", (location == Left) ? "LEFT" : "RIGHT");
-  
-  // ONLY schedule WiFi recreation after RIGHT camera operations AND not already scheduled
-  if (location == Right && !wifiNeedsRecreation) {
-    lastRightCameraCapture = _currentTime;
-    wifiNeedsRecreation = true;
-    writeLog("[CAMERA] Right camera capture completed - WiFi recreation scheduled");
-  }
-  else if (location == Left) {
-    writeLog("[CAMERA] Left camera capture completed - no recreation needed");
-  }
-  
-  uint32_t memAfter = ESP.getFreeHeap();
-  writeLog("[CAMERA] Dual capture completed - Free heap: %d bytes (used: %d bytes)", 
-    memAfter, (memBefore > memAfter) ? (memBefore - memAfter) : 0);
+  writeLog("[CAMERA] Dual capture #%lu %s for %s side (%d pending)", (unsigned long)request.captureId,
+    queued ? "QUEUED" : "DROPPED", (location == Left) ? "LEFT" : "RIGHT", getPendingCameraRequests());
 }
 
 void updatePendingCaptures()
 {
   if (pendingSecondCapture && _currentTime >= secondCaptureTime)
   {
-    writeLog("[CAMERA] Taking picture 2/2 from camera %s (delayed)", pendingCameraID);
-    String queueResponse02 = queueCameraRequest(pendingCameraID, pendingImagePrefix.c_str());
-    writeLog("[CAMERA] Picture 2/2 queued - Response: %s", queueResponse02.c_str());
+    LOG_D(CAMERA, "[CAMERA] Taking picture 2/2 from camera %s (delayed)", pendingCameraID);
+    CameraRequest request;
+    memset(&request, 0, sizeof(request));
+    request.location = pendingCaptureLocation;
+    request.captureId = nextCaptureId++;
+    request.queuedAtMs = monoMillis();
+    addCameraTarget(request, pendingCameraID, pendingImagePrefix);
+
+    bool queued = submitCameraRequest(request);
+    cameraStatus[pendingCaptureLocation] = queued ? CAMERA_PENDING : CAMERA_ERROR;
+    if (!queued)
+      telemetryRecord(EVT_CAPTURE_DROPPED, pendingCaptureLocation, request.captureId);
 
     // Reset pending state
     pendingSecondCapture = false;
     pendingCameraID = nullptr;
-    pendingImagePrefix = "";
+    pendingImagePrefix[0] = '\0';
 
-    writeLog("[CAMERA] Dual camera capture sequence COMPLETED for %s side", (pendingCaptureLocation == Left) ? "LEFT" : "RIGHT");
+    writeLog("[CAMERA] Dual camera capture sequence %s for %s side", queued ? "COMPLETED" : "DROPPED",
+      (pendingCaptureLocation == Left) ? "LEFT" : "RIGHT");
   }
 }
 
@@ -431,8 +390,8 @@ void updateCameraDelays()
     _leftCameraDelayActive = false;
     
     // Trigger dual camera capture immediately (no flash animation)
+    // Image counter is updated by the completion callback
     captureDualCameras(Left, true);
-    incrementImageCounter();
   }
 
   // Check right camera delay - trigger dual capture immediately when delay completes
@@ -442,8 +401,8 @@ void updateCameraDelays()
     _rightCameraDelayActive = false;
     
     // Trigger dual camera capture immediately (no flash animation)
+    // Image counter is updated by the completion callback
     captureDualCameras(Right, true);
-    incrementImageCounter();
   }
 }
 
@@ -711,14 +670,14 @@ void updateLeftFlushBar()
   float remaining = 1.0;
   if (_leftFlushActive)
   {
-    unsigned long elapsed = _currentTime - _leftFlushStartTime;
-    unsigned long totalDuration = flushSettings.getFlushWorkflowRepeat();
+    uint64_t elapsed = _currentTime - _leftFlushStartTime;
+    unsigned long totalDuration = settingsSnapshot().cycleMs;
     remaining = max(0.0f, 1.0f - (float)elapsed / (float)totalDuration);
   }
   else if (_timerLeftRunning && _currentTime >= _timerLeftStartTime)
   {
-    unsigned long elapsed = _currentTime - _timerLeftStartTime;
-    unsigned long totalDuration = flushSettings.getFlushWorkflowRepeat();
+    uint64_t elapsed = _currentTime - _timerLeftStartTime;
+    unsigned long totalDuration = settingsSnapshot().cycleMs;
     remaining = max(0.0f, 1.0f - (float)elapsed / (float)totalDuration);
   }
 
@@ -749,22 +708,22 @@ void updateRightFlushBar()
   float remaining = 1.0;
   if (_rightFlushActive)
   {
-    unsigned long elapsed = _currentTime - _rightFlushStartTime;
-    unsigned long totalDuration = flushSettings.getFlushWorkflowRepeat();
+    uint64_t elapsed = _currentTime - _rightFlushStartTime;
+    unsigned long totalDuration = settingsSnapshot().cycleMs;
     remaining = max(0.0f, 1.0f - (float)elapsed / (float)totalDuration);
   }
   else if (_timerRightRunning && _currentTime < _timerRightStartTime)
   {
     // Waiting for next flush - show countdown to start
-    unsigned long timeUntilStart = _timerRightStartTime - _currentTime;
-    unsigned long totalDuration = flushSettings.getFlushWorkflowRepeat();
+    uint64_t timeUntilStart = _timerRightStartTime - _currentTime;
+    unsigned long totalDuration = settingsSnapshot().cycleMs;
     remaining = min(1.0f, (float)timeUntilStart / (float)totalDuration);
   }
   else if (_timerRightRunning && _currentTime >= _timerRightStartTime)
   {
     // Between flushes - count down from time lapse
-    unsigned long elapsed = _currentTime - _timerRightStartTime;
-    unsigned long totalDuration = flushSettings.getFlushWorkflowRepeat();
+    uint64_t elapsed = _currentTime - _timerRightStartTime;
+    unsigned long totalDuration = settingsSnapshot().cycleMs;
     remaining = max(0.0f, 1.0f - (float)elapsed / (float)totalDuration);
   }
 
@@ -856,32 +815,32 @@ void drawFlowDetails()
 
   // Flush Time Lapse
   tft.setCursor(5, yPos);
-  tft.print("Flush Workflow Repeat: " + String(flushSettings.getFlushWorkflowRepeat() / 1000) + "s");
+  tft.print("Flush Workflow Repeat: " + String(settingsSnapshot().cycleMs / 1000) + "s");
   yPos += 10;
 
   // Waste per Flush
   tft.setCursor(5, yPos);
-  tft.print("Waste/Flush: " + String(flushSettings.getWasteQtyPerFlush()) + "ml");
+  tft.print("Waste/Flush: " + String(settingsSnapshot().wasteQtyMl) + "ml");
   yPos += 10;
 
   // Waste Pump Delay
   tft.setCursor(5, yPos);
-  tft.print("Pump Delay: " + String(flushSettings.getWasteRepoTriggerDelayMs() / 1000) + "s");
+  tft.print("Pump Delay: " + String(settingsSnapshot().wasteRepoDelayMs / 1000) + "s");
   yPos += 10;
 
   // Camera Pic Delay
   tft.setCursor(5, yPos);
-  tft.print("Cam Pic Delay: " + String(flushSettings.getCameraTriggerAfterFlushMs()) + "ms");
+  tft.print("Cam Pic Delay: " + String(settingsSnapshot().cameraDelayMs) + "ms");
   yPos += 10;
 
   // Flushes before picture
   tft.setCursor(5, yPos);
-  tft.print("Flushes b4 pic: " + String(flushSettings.getPicEveryNFlushes()));
+  tft.print("Flushes b4 pic: " + String(settingsSnapshot().picEveryNFlushes));
   yPos += 10;
 
-  // IP Address
+  // IP Address and pending uploads
   tft.setCursor(5, yPos);
-  tft.print("IP: " + WiFi.localIP().toString());
+  tft.print("IP: " + WiFi.localIP().toString() + "  Pending: " + String(getPendingUploads()));
 }
 
 void drawMainDisplay()
@@ -939,7 +898,7 @@ void updateAnimations()
   updateCameraDelays();
 
   // Update duration every second
-  static unsigned long lastDurationUpdate = 0;
+  static uint64_t lastDurationUpdate = 0;
   if (_currentTime - lastDurationUpdate >= 1000)
   {
     updateDuration();
@@ -949,8 +908,8 @@ void updateAnimations()
   // Only update flush bars when there's actual progress to show
   static bool lastLeftFlushActive = false;
   static bool lastRightFlushActive = false;
-  static unsigned long lastLeftBarUpdate = 0;
-  static unsigned long lastRightBarUpdate = 0;
+  static uint64_t lastLeftBarUpdate = 0;
+  static uint64_t lastRightBarUpdate = 0;
 
   // Update left bar only when state changes or every 100ms during active flush
   if (_leftFlushActive != lastLeftFlushActive ||
@@ -977,34 +936,34 @@ void updateAnimations()
   }
   
   // Debug flush states every 30 seconds
-  static unsigned long lastFlushDebug = 0;
+  static uint64_t lastFlushDebug = 0;
   if (_currentTime - lastFlushDebug > 30000)
   {
-    writeLog("[FLUSH_DEBUG] LF_Active:%d RF_Active:%d LF_Start:%lu RF_Start:%lu", 
+    LOG_D(TIMER, "[FLUSH_DEBUG] LF_Active:%d RF_Active:%d LF_Start:%llu RF_Start:%llu", 
       _leftFlushActive, _rightFlushActive, _leftFlushStartTime, _rightFlushStartTime);
     lastFlushDebug = _currentTime;
   }
 }
 
-unsigned long getRealTimeMillis()
+uint64_t getRealTimeMillis()
 {
-  // Use millis() + offset for now (could be replaced with NTP/RTC)
-  return millis() + masterClockOffset;
+  // Use the monotonic clock + offset for now (could be replaced with NTP/RTC)
+  return monoMillis() + masterClockOffset;
 }
 
 void recalibrateWorkflowTiming()
 {
   if (!_flushFlowActive) return;
   
-  unsigned long realTime = getRealTimeMillis();
+  uint64_t realTime = getRealTimeMillis();
   schedule.lastRecalibration = realTime;
   
   // Just validate counters without aggressive corrections
   validateFlushCounts();
   
   // Log timing status for monitoring
-  unsigned long runtime = realTime - schedule.absoluteWorkflowStart;
-  writeLog("[RECAL] Runtime: %lus, L:%d R:%d", runtime/1000, leftFlushCount, rightFlushCount);
+  uint64_t runtime = realTime - schedule.absoluteWorkflowStart;
+  writeLog("[RECAL] Runtime: %llus, L:%d R:%d", runtime/1000, leftFlushCount, rightFlushCount);
 }
 
 void validateFlushCounts()
@@ -1016,8 +975,7 @@ void validateFlushCounts()
   {
     writeLog("Correcting right count from %d to %d", rightFlushCount, leftFlushCount);
     rightFlushCount = leftFlushCount;
-    updateLCDDisplay();
-    drawFlowDetails();
+    eventPublish(APP_EVENT_COUNTS_CORRECTED, Right, rightFlushCount);
   }
   
   // Log current state for monitoring
@@ -1031,8 +989,8 @@ void initializeFlushFlow()
   workflowStartTime = _currentTime;
   _initialRightFlushStarted = false;
   
-  unsigned long flushDurationSec = flushSettings.getFlushWorkflowRepeat() / 1000;
-  unsigned long rightFlushDelayMs = flushSettings.getRightToiletFlushDelaySec() * 1000;
+  unsigned long flushDurationSec = settingsSnapshot().cycleMs / 1000;
+  unsigned long rightFlushDelayMs = settingsSnapshot().rightFlushDelayMs;
   
   writeLog("[INIT] Workflow started - duration:%lus", flushDurationSec);
 
@@ -1064,8 +1022,8 @@ void flushToilet(Location location)
     _leftFlushStartTime = _currentTime;
     _flushLeft = true;
     wasteRepoLeftTriggered = false; // Reset waste repo trigger flag
-    activateRelay(RELAY_T1_PIN, flushSettings.getFlushRelayTimeLapse(), &relayT1StartTime, &relayT1Active);
-    writeLog("[DEBUG] Left flush active - start time: %lu", _leftFlushStartTime);
+    activateRelay(RELAY_T1_PIN, settingsSnapshot().flushRelayMs, &relayT1StartTime, &relayT1Active);
+    LOG_D(TIMER, "[DEBUG] Left flush active - start time: %llu", _leftFlushStartTime);
   }
   else
   {
@@ -1073,8 +1031,8 @@ void flushToilet(Location location)
     _rightFlushStartTime = _currentTime;
     _flushRight = true;
     wasteRepoRightTriggered = false; // Reset waste repo trigger flag
-    activateRelay(RELAY_T2_PIN, flushSettings.getFlushRelayTimeLapse(), &relayT2StartTime, &relayT2Active);
-    writeLog("[DEBUG] Right flush active - start time: %lu", _rightFlushStartTime);
+    activateRelay(RELAY_T2_PIN, settingsSnapshot().flushRelayMs, &relayT2StartTime, &relayT2Active);
+    LOG_D(TIMER, "[DEBUG] Right flush active - start time: %llu", _rightFlushStartTime);
   }
 }
 
@@ -1086,76 +1044,76 @@ void updateFlushFlow()
   // Handle active flush cycles - manage waste repo and camera triggers
   if (_leftFlushActive)
   {
-    unsigned long leftElapsed = _currentTime - _leftFlushStartTime;
+    uint64_t leftElapsed = _currentTime - _leftFlushStartTime;
 
     // Trigger waste repo after 7-second delay (one-time only)
-    unsigned long wasteDelay = flushSettings.getWasteRepoTriggerDelayMs();
+    unsigned long wasteDelay = settingsSnapshot().wasteRepoDelayMs;
     if (leftElapsed >= wasteDelay && !_animateWasteRepoLeft && !wasteRepoLeftTriggered)
     {
-      writeLog("[WASTE] Left waste repo triggered after %lums delay", wasteDelay);
+      LOG_I(WASTE, "[WASTE] Left waste repo triggered after %lums delay", wasteDelay);
       _animateWasteRepoLeft = true;
       wasteRepoLeftTriggered = true;
     }
 
     // End left flush after duration
-    if (leftElapsed >= flushSettings.getFlushWorkflowRepeat())
+    if (leftElapsed >= settingsSnapshot().cycleMs)
     {
       _leftFlushActive = false;
       wasteRepoLeftTriggered = false;
       _animateWasteRepoLeft = false;
-      writeLog("[FLUSH] Left flush completed after %lums", leftElapsed);
+      writeLog("[FLUSH] Left flush completed after %llums", leftElapsed);
 
       // Trigger camera if needed
-      if ((leftFlushCount % flushSettings.getPicEveryNFlushes() == 0) && !_flashCameraLeft)
+      if ((leftFlushCount % settingsSnapshot().picEveryNFlushes == 0) && !_flashCameraLeft)
       {
-        writeLog("[CAMERA] Scheduling left camera (flush #%d, every %d flushes)", leftFlushCount, flushSettings.getPicEveryNFlushes());
+        LOG_D(CAMERA, "[CAMERA] Scheduling left camera (flush #%d, every %d flushes)", leftFlushCount, settingsSnapshot().picEveryNFlushes);
         _leftCameraDelayStartTime = _currentTime;
         _leftCameraDelayActive = true;
       }
       else
       {
-        writeLog("[CAMERA] Left camera NOT triggered - flush #%d, modulo=%d, every=%d", leftFlushCount, leftFlushCount % flushSettings.getPicEveryNFlushes(), flushSettings.getPicEveryNFlushes());
+        LOG_D(CAMERA, "[CAMERA] Left camera NOT triggered - flush #%d, modulo=%d, every=%d", leftFlushCount, leftFlushCount % settingsSnapshot().picEveryNFlushes, settingsSnapshot().picEveryNFlushes);
       }
     }
   }
 
   if (_rightFlushActive)
   {
-    unsigned long rightElapsed = _currentTime - _rightFlushStartTime;
+    uint64_t rightElapsed = _currentTime - _rightFlushStartTime;
 
     // Trigger waste repo after 7-second delay (one-time only)
-    unsigned long wasteDelay = flushSettings.getWasteRepoTriggerDelayMs();
+    unsigned long wasteDelay = settingsSnapshot().wasteRepoDelayMs;
     if (rightElapsed >= wasteDelay && !_animateWasteRepoRight && !wasteRepoRightTriggered)
     {
-      writeLog("[WASTE] Right waste repo triggered after %lums delay", wasteDelay);
+      LOG_I(WASTE, "[WASTE] Right waste repo triggered after %lums delay", wasteDelay);
       _animateWasteRepoRight = true;
       wasteRepoRightTriggered = true;
     }
 
     // End right flush after duration
-    if (rightElapsed >= flushSettings.getFlushWorkflowRepeat())
+    if (rightElapsed >= settingsSnapshot().cycleMs)
     {
       _rightFlushActive = false;
       wasteRepoRightTriggered = false;
       _animateWasteRepoRight = false;
-      writeLog("[FLUSH] Right flush completed after %lums", rightElapsed);
+      writeLog("[FLUSH] Right flush completed after %llums", rightElapsed);
 
       // Trigger camera if needed
-      if ((rightFlushCount % flushSettings.getPicEveryNFlushes() == 0) && !_flashCameraRight)
+      if ((rightFlushCount % settingsSnapshot().picEveryNFlushes == 0) && !_flashCameraRight)
       {
-        writeLog("[CAMERA] Scheduling right camera (flush #%d, every %d flushes)", rightFlushCount, flushSettings.getPicEveryNFlushes());
+        LOG_D(CAMERA, "[CAMERA] Scheduling right camera (flush #%d, every %d flushes)", rightFlushCount, settingsSnapshot().picEveryNFlushes);
         _rightCameraDelayStartTime = _currentTime;
         _rightCameraDelayActive = true;
       }
       else
       {
-        writeLog("[CAMERA] Right camera NOT triggered - flush #%d, modulo=%d, every=%d", rightFlushCount, rightFlushCount % flushSettings.getPicEveryNFlushes(), flushSettings.getPicEveryNFlushes());
+        LOG_D(CAMERA, "[CAMERA] Right camera NOT triggered - flush #%d, modulo=%d, every=%d", rightFlushCount, rightFlushCount % settingsSnapshot().picEveryNFlushes, settingsSnapshot().picEveryNFlushes);
       }
     }
   }
 
   // Handle initial right toilet start (only once)
-  unsigned long rightFlushDelayMs = flushSettings.getRightToiletFlushDelaySec() * 1000;
+  unsigned long rightFlushDelayMs = settingsSnapshot().rightFlushDelayMs;
   if (!_rightFlushActive && !_initialRightFlushStarted &&
       _currentTime - _flushFlowStartTime >= rightFlushDelayMs)
   {
@@ -1268,16 +1226,15 @@ void updateCameraFlashAnimation(Location location)
       bool isAuto = _flushFlowActive;
       writeLog("[CAMERA] Flash animation completed for %s side - triggering dual capture", (location == Left) ? "left" : "right");
 
-      // Execute dual camera capture with delay
+      // Queue dual camera capture - image counter updates on completion
       captureDualCameras(location, isAuto);
-      incrementImageCounter(); // Increment image counter
     }
   }
 }
 
 // Separate timing variables for each waste repo animation
-static unsigned long wasteRepoLeftStartTime = 0;
-static unsigned long wasteRepoRightStartTime = 0;
+static uint64_t wasteRepoLeftStartTime = 0;
+static uint64_t wasteRepoRightStartTime = 0;
 static bool wasteRepoLeftActive = false;
 static bool wasteRepoRightActive = false;
 
@@ -1309,26 +1266,28 @@ void resetWasteRepoStates()
 void MemorySnapshot::capture() {
   freeHeap = esp_get_free_heap_size();
   minFreeHeap = esp_get_minimum_free_heap_size();
-  trackedObjects = 0; // Simplified - ESP-IDF handles tracking
-  timestamp = millis();
+  trackedObjects = heapTaggedBlocks(); // Live new and pool-region blocks across all subsystems
+  timestamp = monoMillis();
 }
 
 void MemorySnapshot::compare(MemorySnapshot& previous) {
-  writeLog("[MEM_COMPARE] === MEMORY CHANGE ANALYSIS ===");
-  writeLog("[MEM_COMPARE] Free heap: %d -> %d (change: %d)", 
+  LOG_I(MEM, "[MEM_COMPARE] === MEMORY CHANGE ANALYSIS ===");
+  LOG_I(MEM, "[MEM_COMPARE] Free heap: %d -> %d (change: %d)", 
            previous.freeHeap, freeHeap, (int)(freeHeap - previous.freeHeap));
-  writeLog("[MEM_COMPARE] Min free: %d -> %d (change: %d)", 
+  LOG_I(MEM, "[MEM_COMPARE] Min free: %d -> %d (change: %d)", 
            previous.minFreeHeap, minFreeHeap, (int)(minFreeHeap - previous.minFreeHeap));
-  writeLog("[MEM_COMPARE] Time elapsed: %lu ms", timestamp - previous.timestamp);
+  LOG_I(MEM, "[MEM_COMPARE] Tracked objects: %d -> %d (change: %d)",
+           previous.trackedObjects, trackedObjects, (int)(trackedObjects - previous.trackedObjects));
+  LOG_I(MEM, "[MEM_COMPARE] Time elapsed: %llu ms", timestamp - previous.timestamp);
 }
 
 void logMemoryObjects() {
-  writeLog("[MEM_ANALYSIS] === ESP-IDF HEAP ANALYSIS ===");
+  LOG_I(MEM, "[MEM_ANALYSIS] === ESP-IDF HEAP ANALYSIS ===");
   
   // Basic heap info
   size_t free_heap = esp_get_free_heap_size();
   size_t min_free_heap = esp_get_minimum_free_heap_size();
-  writeLog("[MEM_ANALYSIS] Free Heap: %u bytes, Min Free: %u bytes", free_heap, min_free_heap);
+  LOG_I(MEM, "[MEM_ANALYSIS] Free Heap: %u bytes, Min Free: %u bytes", free_heap, min_free_heap);
   
   // Detailed heap breakdown by capability
   const uint32_t caps_to_check[] = {
@@ -1347,14 +1306,17 @@ void logMemoryObjects() {
     multi_heap_info_t info;
     heap_caps_get_info(&info, caps_to_check[i]);
     
-    writeLog("[MEM_ANALYSIS] %s - Free: %u, Largest: %u, Allocated: %u", 
+    LOG_I(MEM, "[MEM_ANALYSIS] %s - Free: %u, Largest: %u, Allocated: %u", 
              cap_names[i], 
              info.total_free_bytes, 
              info.largest_free_block,
              info.total_allocated_bytes);
   }
   
-  writeLog("[MEM_ANALYSIS] === END ANALYSIS ===");
+  logMemoryPools();
+  logHeapTags();
+  logMemoryTrend();
+  LOG_I(MEM, "[MEM_ANALYSIS] === END ANALYSIS ===");
 }
 
 void checkMemoryAnalysisTrigger() {
@@ -1363,12 +1325,12 @@ void checkMemoryAnalysisTrigger() {
   if (!firstAnalysisComplete && imageCount >= 2) {
     shouldAnalyze = true;
     firstAnalysisComplete = true;
-    writeLog("[MEM_TRIGGER] First workflow complete - triggering analysis");
+    LOG_I(MEM, "[MEM_TRIGGER] First workflow complete - triggering analysis");
   }
   else if (firstAnalysisComplete && (completedWorkflowCycles % 3 == 0) && 
            _currentTime - lastMemoryAnalysis > 300000) {
     shouldAnalyze = true;
-    writeLog("[MEM_TRIGGER] Cycle %d complete - triggering analysis", completedWorkflowCycles);
+    LOG_I(MEM, "[MEM_TRIGGER] Cycle %d complete - triggering analysis", completedWorkflowCycles);
   }
   
   if (shouldAnalyze) {
@@ -1377,77 +1339,20 @@ void checkMemoryAnalysisTrigger() {
   }
 }
 
-HTTPClient* createTrackedHTTPClient() {
-  size_t beforeHeap = esp_get_free_heap_size();
-  HTTPClient* client = new HTTPClient();
-  size_t afterHeap = esp_get_free_heap_size();
-  
-  writeLog("[HTTP_TRACK] HTTPClient created - heap change: %d bytes", (int)(beforeHeap - afterHeap));
-  return client;
-}
-
-void destroyTrackedHTTPClient(HTTPClient* client) {
-  if (!client) return;
-  
-  size_t beforeHeap = esp_get_free_heap_size();
-  client->end();
-  delete client;
-  size_t afterHeap = esp_get_free_heap_size();
-  
-  writeLog("[HTTP_TRACK] HTTPClient destroyed - heap change: %d bytes", (int)(afterHeap - beforeHeap));
-}
-
-void recreateNetworkObjects()
-{
-  size_t beforeHeap = esp_get_free_heap_size();
-  writeLog("[WIFI_RESET] Starting WiFi/HTTP recreation - Free: %u", beforeHeap);
-  
-  // Destroy existing HTTP client with tracking
-  if (httpClient) {
-    destroyTrackedHTTPClient(httpClient);
-    httpClient = nullptr;
-  }
-  
-  // Disconnect and reconnect WiFi
-  WiFi.disconnect(true);
-  delay(100);
-  writeLog("[WIFI_RESET] WiFi disconnected");
-  
-  WiFi.begin(ssid, password);
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20) {
-    delay(500);
-    attempts++;
-  }
-  
-  if (WiFi.status() == WL_CONNECTED) {
-    writeLog("[WIFI_RESET] WiFi reconnected - IP: %s", WiFi.localIP().toString().c_str());
-  } else {
-    writeLog("[WIFI_RESET] WiFi reconnection failed");
-  }
-  
-  // Create new HTTP client with tracking
-  httpClient = createTrackedHTTPClient();
-  
-  wifiNeedsRecreation = false;
-  size_t afterHeap = esp_get_free_heap_size();
-  writeLog("[WIFI_RESET] Completed - Free: %u (recovered: %d bytes)", afterHeap, (int)(afterHeap - beforeHeap));
-}
-
 void updateWasteRepoAnimation(Location location)
 {
   AnimationState *anim = &_animStates[WASTE_REPO][location];
   bool *animateFlag = (location == Left) ? &_animateWasteRepoLeft : &_animateWasteRepoRight;
-  unsigned long *startTime = (location == Left) ? &wasteRepoLeftStartTime : &wasteRepoRightStartTime;
+  uint64_t *startTime = (location == Left) ? &wasteRepoLeftStartTime : &wasteRepoRightStartTime;
   bool *activeFlag = (location == Left) ? &wasteRepoLeftActive : &wasteRepoRightActive;
 
   if (*animateFlag && !*activeFlag)
   {
     const char *side = (location == Left) ? "Left" : "Right";
-    int pumpActiveTimeMS = (flushSettings.getWasteQtyPerFlush() * 1000) / PUMP_WASTE_ML_SEC;
-    writeLog("%s waste repo animation and relay started", side);
-    writeLog("Waste qty: %dml, Pump rate: %dml/s, Duration: %dms", 
-      flushSettings.getWasteQtyPerFlush(), PUMP_WASTE_ML_SEC, pumpActiveTimeMS);
+    int pumpActiveTimeMS = settingsSnapshot().pumpDurationMs;
+    LOG_I(WASTE, "%s waste repo animation and relay started", side);
+    LOG_I(WASTE, "Waste qty: %dml, Pump rate: %dml/s, Duration: %dms", 
+      settingsSnapshot().wasteQtyMl, PUMP_WASTE_ML_SEC, pumpActiveTimeMS);
 
     *activeFlag = true;
     anim->active = true;
@@ -1471,14 +1376,14 @@ void updateWasteRepoAnimation(Location location)
 
   if (*activeFlag && anim->active)
   {
-    unsigned long elapsed = _currentTime - *startTime;
-    int pumpActiveTimeMS = (flushSettings.getWasteQtyPerFlush() * 1000) / PUMP_WASTE_ML_SEC;
+    uint64_t elapsed = _currentTime - *startTime;
+    uint64_t pumpActiveTimeMS = settingsSnapshot().pumpDurationMs;
 
     // Check if animation should stop after pump active time
     if (elapsed >= pumpActiveTimeMS)
     {
       const char *side = (location == Left) ? "Left" : "Right";
-      writeLog("%s waste repo animation and relay completed after %lums", side, elapsed);
+      LOG_I(WASTE, "%s waste repo animation and relay completed after %llums", side, elapsed);
 
       // Reset all flags to allow repeated manual activation
       *activeFlag = false;
@@ -1490,17 +1395,12 @@ void updateWasteRepoAnimation(Location location)
       *startTime = 0;
       
       // Increment waste counter when animation completes
-      totalWasteML += flushSettings.getWasteQtyPerFlush();
-      writeLog("[COUNT] Waste: %dml (incremented by %dml)", totalWasteML, flushSettings.getWasteQtyPerFlush());
-      
-      // Update both LCD and TFT displays
-      updateLCDDisplay();
-      drawFlowDetails();
+      addWasteDose(location);
 
       drawToilet(location);    // Update toilet to show final state (stage 5)
       drawWasteRepo(location); // Ensure waste repo shows default image
 
-      writeLog("%s waste repo ready for next activation", side);
+      LOG_D(WASTE, "%s waste repo ready for next activation", side);
       return;
     }
 
@@ -1510,7 +1410,7 @@ void updateWasteRepoAnimation(Location location)
       anim->stage++;
       anim->lastTime = _currentTime;
       const char *side = (location == Left) ? "Left" : "Right";
-      // writeLog("%s waste repo stage %d/5, elapsed: %lums", side, anim->stage + 1, elapsed); // Too verbose
+      LOG_V(WASTE, "%s waste repo stage %d/5, elapsed: %llums", side, anim->stage + 1, elapsed);
 
       // Reset stage to continue cycling until pump duration completes
       if (anim->stage >= WASTE_REPO_ANIM_TOTAL_STAGES)
@@ -1527,14 +1427,14 @@ void toggleTimers()
 {
   if (_drawTriangle) // Triangle visible = start flush flow when clicked
   {
-    unsigned long timestamp = millis();
-    writeLog("[BUTTON] START clicked at T:%lu", timestamp);
+    uint64_t timestamp = monoMillis();
+    writeLog("[BUTTON] START clicked at T:%llu", timestamp);
     _drawTriangle = false; // Switch to square
     drawStartStopButton();
 
     initializeFlushFlow();
+    eventPublish(APP_EVENT_WORKFLOW_START, TELEMETRY_SIDE_NONE, 0); // LCD shows the running state
     drawLeftFlushBar(); // Initialize left flush bar
-    updateLCDDisplay(); // Update LCD to show running state
   }
   else // Square visible = pause/stop when clicked
   {
@@ -1551,8 +1451,7 @@ void toggleTimers()
     _timerLeftRunning = false;
     _timerRightRunning = false;
 
-    // Reset counters display
-    updateLCDDisplay(); // Update LCD to show stopped state
+    eventPublish(APP_EVENT_WORKFLOW_STOP, TELEMETRY_SIDE_NONE, 0); // LCD shows the stopped state
 
     // Reset animation states and stages
     _animStates[TOILET][Left].active = false;
@@ -1598,7 +1497,7 @@ void toggleTimers()
 
 void updateTimers()
 {
-  static unsigned long lastDebugLog = 0;
+  static uint64_t lastDebugLog = 0;
   
   // Track completed workflow cycles
   static int lastLeftCount = 0;
@@ -1606,27 +1505,29 @@ void updateTimers()
   
   if (leftFlushCount > lastLeftCount && rightFlushCount > lastRightCount) {
     completedWorkflowCycles++;
+    eventPublish(APP_EVENT_CYCLE_COMPLETE, TELEMETRY_SIDE_NONE, completedWorkflowCycles);
     lastLeftCount = leftFlushCount;
     lastRightCount = rightFlushCount;
     writeLog("[WORKFLOW] Completed cycle %d (L:%d R:%d)", completedWorkflowCycles, leftFlushCount, rightFlushCount);
+    memoryTrendRecordCycle(completedWorkflowCycles);
   }
   
   // Update left timer - unified timer-driven system
   if (_timerLeftRunning)
   {
-    unsigned long elapsed = (_currentTime - _timerLeftStartTime) / 1000;
-    unsigned long totalTimeSeconds = flushSettings.getFlushWorkflowRepeat() / 1000;
+    uint64_t elapsed = (_currentTime - _timerLeftStartTime) / 1000;
+    unsigned long totalTimeSeconds = settingsSnapshot().cycleMs / 1000;
     
     if (elapsed < totalTimeSeconds)
     {
-      unsigned long remaining = totalTimeSeconds - elapsed;
+      uint64_t remaining = totalTimeSeconds - elapsed;
       _timerLeftMinutes = remaining / 60;
       _timerLeftSeconds = remaining % 60;
       
       // Debug log every 10 seconds
       if (_currentTime - lastDebugLog >= 10000)
       {
-        writeLog("[TIMER] Left: %02d:%02d (elapsed:%lus)", _timerLeftMinutes, _timerLeftSeconds, elapsed);
+        LOG_D(TIMER, "[TIMER] Left: %02d:%02d (elapsed:%llus)", _timerLeftMinutes, _timerLeftSeconds, elapsed);
         lastDebugLog = _currentTime;
       }
     }
@@ -1634,25 +1535,33 @@ void updateTimers()
     {
       // Timer reached 00:00 - trigger new cycle immediately
       writeLog("[CYCLE] Left timer reached 00:00 - starting new cycle");
+
+      // Cycle boundary - settings edited during the last cycle take effect here
+      if (flushSettings.applyPendingSettings())
+      {
+        totalTimeSeconds = settingsSnapshot().cycleMs / 1000;
+        if (!flushSettings.isSettingsVisible())
+          drawFlowDetails();
+      }
       
       // 1. Check if previous flush should trigger camera
-      if ((leftFlushCount % flushSettings.getPicEveryNFlushes() == 0))
+      if ((leftFlushCount % settingsSnapshot().picEveryNFlushes == 0))
       {
-        writeLog("[CAMERA] Triggering left camera after 25s delay (flush #%d, every %d flushes)", leftFlushCount, flushSettings.getPicEveryNFlushes());
+        writeLog("[CAMERA] Triggering left camera after 25s delay (flush #%d, every %d flushes)", leftFlushCount, settingsSnapshot().picEveryNFlushes);
         
         // Schedule dual camera capture after 25-second delay
         pendingSecondCapture = false; // Reset any pending capture
-        unsigned long cameraDelay = flushSettings.getCameraTriggerAfterFlushMs();
+        unsigned long cameraDelay = settingsSnapshot().cameraDelayMs;
         
         // Schedule first camera immediately after delay
         _leftCameraDelayStartTime = _currentTime + cameraDelay;
         _leftCameraDelayActive = true;
         
-        writeLog("[CAMERA] Left dual capture scheduled in %lums", cameraDelay);
+        LOG_D(CAMERA, "[CAMERA] Left dual capture scheduled in %lums", cameraDelay);
       }
       else
       {
-        writeLog("[CAMERA] Left camera NOT triggered - flush #%d, modulo=%d, every=%d", leftFlushCount, leftFlushCount % flushSettings.getPicEveryNFlushes(), flushSettings.getPicEveryNFlushes());
+        LOG_D(CAMERA, "[CAMERA] Left camera NOT triggered - flush #%d, modulo=%d, every=%d", leftFlushCount, leftFlushCount % settingsSnapshot().picEveryNFlushes, settingsSnapshot().picEveryNFlushes);
       }
       
       // 2. Reset timer to full duration
@@ -1677,12 +1586,12 @@ void updateTimers()
     }
     else
     {
-      unsigned long elapsed = (_currentTime - _timerRightStartTime) / 1000;
-      unsigned long totalTimeSeconds = flushSettings.getFlushWorkflowRepeat() / 1000;
+      uint64_t elapsed = (_currentTime - _timerRightStartTime) / 1000;
+      unsigned long totalTimeSeconds = settingsSnapshot().cycleMs / 1000;
       
       if (elapsed < totalTimeSeconds)
       {
-        unsigned long remaining = totalTimeSeconds - elapsed;
+        uint64_t remaining = totalTimeSeconds - elapsed;
         _timerRightMinutes = remaining / 60;
         _timerRightSeconds = remaining % 60;
       }
@@ -1692,23 +1601,23 @@ void updateTimers()
         writeLog("[CYCLE] Right timer reached 00:00 - starting new cycle");
         
         // 1. Check if previous flush should trigger camera
-        if ((rightFlushCount % flushSettings.getPicEveryNFlushes() == 0))
+        if ((rightFlushCount % settingsSnapshot().picEveryNFlushes == 0))
         {
-          writeLog("[CAMERA] Triggering right camera after 25s delay (flush #%d, every %d flushes)", rightFlushCount, flushSettings.getPicEveryNFlushes());
+          writeLog("[CAMERA] Triggering right camera after 25s delay (flush #%d, every %d flushes)", rightFlushCount, settingsSnapshot().picEveryNFlushes);
           
           // Schedule dual camera capture after 25-second delay
           pendingSecondCapture = false; // Reset any pending capture
-          unsigned long cameraDelay = flushSettings.getCameraTriggerAfterFlushMs();
+          unsigned long cameraDelay = settingsSnapshot().cameraDelayMs;
           
           // Schedule first camera immediately after delay
           _rightCameraDelayStartTime = _currentTime + cameraDelay;
           _rightCameraDelayActive = true;
           
-          writeLog("[CAMERA] Right dual capture scheduled in %lums", cameraDelay);
+          LOG_D(CAMERA, "[CAMERA] Right dual capture scheduled in %lums", cameraDelay);
         }
         else
         {
-          writeLog("[CAMERA] Right camera NOT triggered - flush #%d, modulo=%d, every=%d", rightFlushCount, rightFlushCount % flushSettings.getPicEveryNFlushes(), flushSettings.getPicEveryNFlushes());
+          LOG_D(CAMERA, "[CAMERA] Right camera NOT triggered - flush #%d, modulo=%d, every=%d", rightFlushCount, rightFlushCount % settingsSnapshot().picEveryNFlushes, settingsSnapshot().picEveryNFlushes);
         }
         
         // 2. Reset timer to full duration
@@ -4,9 +4,8 @@
 #include <TFT_eSPI.h>
 #include "Shapes.h"
 #include "global_vars.h"
-
-// Global logging function
-void writeLog(const char *format, ...);
+#include "network_task.h"
+#include "log_service.h" // Global logging: writeLog() and the LOG_x() category macros
 
 // Function prototypes
 void drawSaniLogo();
@@ -33,6 +32,8 @@ void updateLeftFlushBar();
 void drawRightFlushBar();
 void updateRightFlushBar();
 void captureDualCameras(Location location, bool isAuto);
+void onCameraRequestComplete(const CameraResult &result);
+CameraStatus getCameraStatus(Location location);
 void updatePendingCaptures();
 void updateCameraDelays();
 void incrementLeftFlushCounter();
@@ -45,6 +46,6 @@ float calculateTotalGallons(); // Shared gallon calculation function
 // Timer recalibration functions
 void recalibrateWorkflowTiming();
 void validateFlushCounts();
-unsigned long getRealTimeMillis();
+uint64_t getRealTimeMillis();
 
 #endif // DRAW_FUNCTIONS_H
\ No newline at end of file
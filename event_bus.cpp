@@ -0,0 +1,85 @@
+#include "event_bus.h"
+#include "log_service.h"
+
+static_assert(APP_EVENT_TYPE_COUNT <= 32, "Event masks hold one bit per type");
+
+struct Subscriber
+{
+  uint32_t mask;
+  AppEventHandler onEvent;  // Set for event subscribers
+  AppFrameHandler onFrame;  // Set for frame subscribers
+  uint32_t pendingEvents;   // Bits seen since the last dispatch
+  uint16_t pendingCount;
+};
+
+static Subscriber subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+static uint8_t subscriberCount = 0;
+static EventBusStats busStats = {};
+
+static bool addSubscriber(uint32_t mask, AppEventHandler onEvent, AppFrameHandler onFrame)
+{
+  if (subscriberCount >= EVENT_BUS_MAX_SUBSCRIBERS)
+  {
+    writeLog("[EVENTS] Subscriber table full (%d)", EVENT_BUS_MAX_SUBSCRIBERS);
+    return false;
+  }
+  subscribers[subscriberCount++] = { mask, onEvent, onFrame, 0, 0 };
+  return true;
+}
+
+bool eventBusSubscribe(uint32_t mask, AppEventHandler handler)
+{
+  return addSubscriber(mask, handler, nullptr);
+}
+
+bool eventBusSubscribeFrame(uint32_t mask, AppFrameHandler handler)
+{
+  return addSubscriber(mask, nullptr, handler);
+}
+
+void eventPublish(AppEventType type, uint8_t side, int32_t value)
+{
+  AppEvent event = { type, side, value };
+  uint32_t bit = APP_EVENT_BIT(type);
+  busStats.published++;
+
+  for (uint8_t i = 0; i < subscriberCount; i++)
+  {
+    Subscriber &subscriber = subscribers[i];
+    if (!(subscriber.mask & bit))
+      continue;
+    if (subscriber.onEvent)
+    {
+      subscriber.onEvent(event);
+    }
+    else
+    {
+      subscriber.pendingEvents |= bit;
+      subscriber.pendingCount++;
+    }
+  }
+  LOG_V(UI, "[EVENTS] type %d side %d value %ld", type, side, (long)value);
+}
+
+// A handler may publish again (a redraw that bumps a counter); those events land
+// in the next frame rather than re-running this one
+void eventBusDispatchFrame()
+{
+  for (uint8_t i = 0; i < subscriberCount; i++)
+  {
+    Subscriber &subscriber = subscribers[i];
+    if (!subscriber.pendingEvents)
+      continue;
+    uint32_t events = subscriber.pendingEvents;
+    busStats.coalesced += subscriber.pendingCount - 1;
+    subscriber.pendingEvents = 0;
+    subscriber.pendingCount = 0;
+    busStats.frameCalls++;
+    subscriber.onFrame(events);
+  }
+}
+
+void getEventBusStats(EventBusStats &stats)
+{
+  stats = busStats;
+}
@@ -0,0 +1,60 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <Arduino.h>
+
+// Loop-task publish/subscribe for counter and workflow changes.
+// Code that changes a counter publishes a typed event and goes on - it no longer
+// calls the LCD, TFT or telemetry itself. Two kinds of subscriber:
+//   event subscribers get every event as it is published (telemetry, which must
+//     not lose any), and
+//   frame subscribers get one call per loop() pass listing which event types
+//     occurred, so a burst of changes costs each display a single refresh.
+// eventBusDispatchFrame() at the end of loop() closes the frame. Publishing and
+// dispatch both happen on the loop task; there is no locking.
+
+#define EVENT_BUS_MAX_SUBSCRIBERS 8
+
+enum AppEventType : uint8_t
+{
+  APP_EVENT_FLUSH,            // value: side flush count
+  APP_EVENT_WASTE_DOSE,       // value: ml added to the waste total
+  APP_EVENT_IMAGE,            // value: image count
+  APP_EVENT_CYCLE_COMPLETE,   // value: completed cycle number
+  APP_EVENT_COUNTS_CORRECTED, // value: corrected right flush count
+  APP_EVENT_WORKFLOW_START,
+  APP_EVENT_WORKFLOW_STOP,
+  APP_EVENT_TYPE_COUNT
+};
+
+#define APP_EVENT_BIT(type) (1u << (type))
+#define APP_EVENTS_ALL ((1u << APP_EVENT_TYPE_COUNT) - 1)
+#define APP_EVENTS_COUNTERS                                                                          \
+  (APP_EVENT_BIT(APP_EVENT_FLUSH) | APP_EVENT_BIT(APP_EVENT_WASTE_DOSE) | APP_EVENT_BIT(APP_EVENT_IMAGE) | \
+    APP_EVENT_BIT(APP_EVENT_COUNTS_CORRECTED))
+#define APP_EVENTS_WORKFLOW (APP_EVENT_BIT(APP_EVENT_WORKFLOW_START) | APP_EVENT_BIT(APP_EVENT_WORKFLOW_STOP))
+
+struct AppEvent
+{
+  AppEventType type;
+  uint8_t side;  // Left, Right or TELEMETRY_SIDE_NONE
+  int32_t value;
+};
+
+typedef void (*AppEventHandler)(const AppEvent &event);
+typedef void (*AppFrameHandler)(uint32_t events); // APP_EVENT_BIT()s seen this frame
+
+struct EventBusStats
+{
+  uint32_t published;
+  uint32_t frameCalls;  // Frame subscriber calls
+  uint32_t coalesced;   // Events folded into another event's frame call
+};
+
+bool eventBusSubscribe(uint32_t mask, AppEventHandler handler);      // false when the table is full
+bool eventBusSubscribeFrame(uint32_t mask, AppFrameHandler handler);
+void eventPublish(AppEventType type, uint8_t side, int32_t value);
+void eventBusDispatchFrame(); // Once per loop() pass, after everything that publishes
+void getEventBusStats(EventBusStats &stats);
+
+#endif // EVENT_BUS_H
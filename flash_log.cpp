@@ -0,0 +1,369 @@
+#include "flash_log.h"
+#include "log_service.h"
+#include "storage.h"
+#include "heap_tags.h"
+#include "time_base.h"
+#include <LittleFS.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <atomic>
+
+static const uint32_t FLASH_LOG_MAGIC = 0x474C4653; // "SFLG"
+static const uint32_t FLASH_LOG_TASK_STACK_SIZE = 4096;
+static const UBaseType_t FLASH_LOG_TASK_PRIORITY = tskIDLE_PRIORITY + 1;
+static const BaseType_t FLASH_LOG_TASK_CORE = 0;
+
+// First bytes of every segment file; the log bytes follow
+struct SegmentHeader
+{
+  uint32_t magic;
+  uint32_t seq;      // Increases by one per segment started, never reused
+  uint32_t reserved[2];
+};
+
+// A filled page on its way to the writer task. ticket is non-zero for pages
+// handed over because of flashLogRequestFlush().
+struct PageSubmit
+{
+  uint8_t page;
+  uint16_t length;
+  uint32_t ticket;
+};
+
+// Double-buffered pages: the log task fills one while the writer writes the other
+static uint8_t pages[2][FLASH_LOG_PAGE_SIZE];
+static std::atomic<bool> pageBusy[2];
+static uint8_t fillPage = 0;
+static size_t fillUsed = 0;
+static uint64_t fillStartedMs = 0;
+static uint32_t flushHandled = 0;
+static QueueHandle_t pageQueue = nullptr;
+static std::atomic<uint32_t> flushRequested(0);
+static std::atomic<uint32_t> flushCompleted(0);
+
+// Ring state - written by the writer task, snapshotted by readers under ringLock
+static portMUX_TYPE ringLock = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t segmentSeq[FLASH_LOG_SEGMENTS];  // 0 = empty
+static uint32_t segmentSize[FLASH_LOG_SEGMENTS]; // Including the header
+static uint8_t currentSegment = 0;
+static File segmentFile;
+static volatile bool ringReady = false;
+static FlashLogStats stats = {};
+
+static void segmentPath(uint8_t segment, char *path, size_t size)
+{
+  snprintf(path, size, "%s/%u.bin", FLASH_LOG_DIR, (unsigned)segment);
+}
+
+static uint32_t storedBytes()
+{
+  uint32_t total = 0;
+  for (int i = 0; i < FLASH_LOG_SEGMENTS; i++)
+  {
+    if (segmentSeq[i] != 0)
+      total += segmentSize[i] - sizeof(SegmentHeader);
+  }
+  return total;
+}
+
+// ================== Writer task ==================
+
+static bool startSegment(uint8_t segment, uint32_t seq)
+{
+  if (segmentFile)
+    segmentFile.close();
+
+  char path[24];
+  segmentPath(segment, path, sizeof(path));
+  segmentFile = LittleFS.open(path, FILE_WRITE); // Truncates the oldest segment
+  SegmentHeader header = { FLASH_LOG_MAGIC, seq, { 0, 0 } };
+  bool ok = segmentFile && segmentFile.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+
+  portENTER_CRITICAL(&ringLock);
+  currentSegment = segment;
+  segmentSeq[segment] = ok ? seq : 0;
+  segmentSize[segment] = sizeof(header);
+  portEXIT_CRITICAL(&ringLock);
+  stats.newestSegmentSeq = seq;
+  return ok;
+}
+
+static bool openRing()
+{
+  if (!storageBegin())
+  {
+    writeLog("[FLASHLOG] No LittleFS - flash log disabled");
+    return false;
+  }
+  if (!LittleFS.exists(FLASH_LOG_DIR))
+    LittleFS.mkdir(FLASH_LOG_DIR);
+
+  // Find the newest valid segment; anything unreadable counts as empty
+  int newest = -1;
+  for (int i = 0; i < FLASH_LOG_SEGMENTS; i++)
+  {
+    char path[24];
+    segmentPath(i, path, sizeof(path));
+    segmentSeq[i] = 0;
+    segmentSize[i] = 0;
+    if (!LittleFS.exists(path))
+      continue;
+
+    File file = LittleFS.open(path, FILE_READ);
+    SegmentHeader header;
+    if (file && file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) && header.magic == FLASH_LOG_MAGIC &&
+        header.seq != 0)
+    {
+      segmentSeq[i] = header.seq;
+      segmentSize[i] = min((uint32_t)file.size(), (uint32_t)FLASH_LOG_SEGMENT_SIZE);
+      if (newest < 0 || header.seq > segmentSeq[newest])
+        newest = i;
+    }
+    file.close();
+  }
+
+  bool ok;
+  if (newest < 0)
+  {
+    ok = startSegment(0, 1);
+  }
+  else
+  {
+    char path[24];
+    segmentPath(newest, path, sizeof(path));
+    segmentFile = LittleFS.open(path, FILE_APPEND);
+    currentSegment = newest;
+    stats.newestSegmentSeq = segmentSeq[newest];
+    ok = (bool)segmentFile;
+  }
+  if (!ok)
+  {
+    writeLog("[FLASHLOG] Could not open a segment in %s - flash log disabled", FLASH_LOG_DIR);
+    return false;
+  }
+
+  stats.bytesStored = storedBytes();
+  writeLog("[FLASHLOG] Ready - segment #%lu, %lu KB of %d KB stored", (unsigned long)stats.newestSegmentSeq,
+    (unsigned long)(stats.bytesStored / 1024), FLASH_LOG_SEGMENTS * FLASH_LOG_SEGMENT_SIZE / 1024);
+  return true;
+}
+
+static void writePage(const uint8_t *data, size_t length)
+{
+  uint64_t startUs = monoMicros();
+
+  if (segmentSize[currentSegment] + length > FLASH_LOG_SEGMENT_SIZE)
+  {
+    uint8_t next = (currentSegment + 1) % FLASH_LOG_SEGMENTS;
+    if (!startSegment(next, stats.newestSegmentSeq + 1))
+    {
+      stats.writeErrors++;
+      return;
+    }
+  }
+
+  size_t written = segmentFile.write(data, length);
+  segmentFile.flush();
+  if (written != length)
+    stats.writeErrors++;
+
+  portENTER_CRITICAL(&ringLock);
+  segmentSize[currentSegment] += written;
+  portEXIT_CRITICAL(&ringLock);
+
+  stats.bytesStored = storedBytes();
+  stats.pagesWritten++;
+  uint32_t elapsedUs = (uint32_t)(monoMicros() - startUs);
+  if (elapsedUs > stats.maxWriteUs)
+    stats.maxWriteUs = elapsedUs;
+}
+
+static void flashLogTask(void *parameter)
+{
+  HeapTagScope heapTag(HEAP_TAG_LOGGING);
+  ringReady = openRing();
+  stats.ready = ringReady;
+
+  PageSubmit submit;
+  for (;;)
+  {
+    if (xQueueReceive(pageQueue, &submit, portMAX_DELAY) != pdTRUE)
+      continue;
+    if (ringReady && submit.length > 0)
+      writePage(pages[submit.page], submit.length);
+    pageBusy[submit.page] = false;
+    if (submit.ticket != 0)
+      flushCompleted = submit.ticket;
+  }
+}
+
+void flashLogBegin()
+{
+  if (!FLASH_LOG_ENABLED || pageQueue)
+    return;
+
+  pageQueue = xQueueCreate(2, sizeof(PageSubmit));
+  if (!pageQueue)
+    return;
+  xTaskCreatePinnedToCore(flashLogTask, "flashlog", FLASH_LOG_TASK_STACK_SIZE, nullptr, FLASH_LOG_TASK_PRIORITY,
+    nullptr, FLASH_LOG_TASK_CORE);
+}
+
+// ================== Log task side ==================
+
+// Hand the fill page to the writer; fails while the writer still owns the other page
+static bool submitPage(uint32_t ticket)
+{
+  uint8_t other = fillPage ^ 1;
+  if (pageBusy[other])
+    return false;
+
+  PageSubmit submit = { fillPage, (uint16_t)fillUsed, ticket };
+  pageBusy[fillPage] = true;
+  if (xQueueSend(pageQueue, &submit, 0) != pdTRUE)
+  {
+    pageBusy[fillPage] = false;
+    return false;
+  }
+  fillPage = other;
+  fillUsed = 0;
+  return true;
+}
+
+void flashLogAppend(const uint8_t *data, size_t length)
+{
+  if (!pageQueue)
+    return;
+
+  while (length > 0)
+  {
+    if (fillUsed == FLASH_LOG_PAGE_SIZE && !submitPage(0))
+    {
+      stats.droppedBytes += length; // Never wait on flash from the log task
+      return;
+    }
+    if (fillUsed == 0)
+      fillStartedMs = monoMillis();
+
+    size_t copy = min(length, FLASH_LOG_PAGE_SIZE - fillUsed);
+    memcpy(pages[fillPage] + fillUsed, data, copy);
+    fillUsed += copy;
+    data += copy;
+    length -= copy;
+  }
+
+  if (fillUsed == FLASH_LOG_PAGE_SIZE)
+    submitPage(0);
+}
+
+void flashLogIdle()
+{
+  if (!pageQueue)
+    return;
+
+  if (fillUsed == FLASH_LOG_PAGE_SIZE)
+  {
+    submitPage(0);
+    return;
+  }
+
+  uint32_t requested = flushRequested;
+  if (requested != flushHandled)
+  {
+    if (submitPage(requested))
+      flushHandled = requested;
+    return;
+  }
+
+  if (fillUsed > 0 && monoMillis() - fillStartedMs >= FLASH_LOG_IDLE_FLUSH_MS)
+    submitPage(0);
+}
+
+uint32_t flashLogRequestFlush()
+{
+  return ++flushRequested;
+}
+
+bool flashLogFlushed(uint32_t ticket)
+{
+  return !ringReady || (int32_t)(flushCompleted - ticket) >= 0;
+}
+
+// ================== Readers ==================
+
+bool flashLogOpenReader(FlashLogReader &reader)
+{
+  reader.segmentCount = 0;
+  reader.position = 0;
+  reader.offset = 0;
+  if (!ringReady)
+    return false;
+
+  uint32_t seqs[FLASH_LOG_SEGMENTS];
+  portENTER_CRITICAL(&ringLock);
+  memcpy(seqs, segmentSeq, sizeof(seqs));
+  memcpy(reader.segmentSizes, segmentSize, sizeof(reader.segmentSizes));
+  portEXIT_CRITICAL(&ringLock);
+
+  // Oldest first (insertion sort - at most FLASH_LOG_SEGMENTS entries)
+  for (uint8_t i = 0; i < FLASH_LOG_SEGMENTS; i++)
+  {
+    if (seqs[i] == 0)
+      continue;
+    uint8_t at = reader.segmentCount++;
+    while (at > 0 && seqs[reader.order[at - 1]] > seqs[i])
+    {
+      reader.order[at] = reader.order[at - 1];
+      at--;
+    }
+    reader.order[at] = i;
+  }
+  return reader.segmentCount > 0;
+}
+
+size_t flashLogRead(FlashLogReader &reader, uint8_t *buffer, size_t size)
+{
+  while (reader.position < reader.segmentCount)
+  {
+    uint8_t segment = reader.order[reader.position];
+    if (!reader.file)
+    {
+      char path[24];
+      segmentPath(segment, path, sizeof(path));
+      reader.file = LittleFS.open(path, FILE_READ);
+      reader.offset = sizeof(SegmentHeader);
+      if (!reader.file || !reader.file.seek(reader.offset))
+      {
+        reader.position++;
+        continue;
+      }
+    }
+
+    // A segment recycled since the reader opened just reads short
+    if (reader.offset < reader.segmentSizes[segment])
+    {
+      size_t n = reader.file.read(buffer, min(size, (size_t)(reader.segmentSizes[segment] - reader.offset)));
+      if (n > 0)
+      {
+        reader.offset += n;
+        return n;
+      }
+    }
+    reader.file.close();
+    reader.position++;
+  }
+  return 0;
+}
+
+void flashLogCloseReader(FlashLogReader &reader)
+{
+  if (reader.file)
+    reader.file.close();
+  reader.position = reader.segmentCount;
+}
+
+void getFlashLogStats(FlashLogStats &out)
+{
+  out = stats;
+}
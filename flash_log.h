@@ -0,0 +1,68 @@
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Persistent log ring on LittleFS for post-mortem analysis.
+// Everything the log task writes to Serial (text lines or LOG_BINARY_MODE frames)
+// is also copied into a RAM page; full pages are handed to a writer task that
+// appends them to a ring of segment files, so flash writes happen one page at a
+// time and never on the control loop or the log task. LittleFS spreads the
+// writes across the whole partition. When the newest segment is full the oldest
+// one is rewritten, so the last FLASH_LOG_SEGMENTS * FLASH_LOG_SEGMENT_SIZE bytes
+// survive reboots. If the writer falls behind, new bytes are dropped and counted
+// rather than waiting.
+// Download with GET /log on the status server (tools/log_fetch.py).
+
+#ifndef FLASH_LOG_ENABLED
+#define FLASH_LOG_ENABLED 1
+#endif
+
+#define FLASH_LOG_DIR "/log"
+#define FLASH_LOG_SEGMENTS 8                  // Segment files in the ring
+#define FLASH_LOG_SEGMENT_SIZE (64 * 1024)    // Bytes per segment (8 x 64 KB = 512 KB kept)
+#define FLASH_LOG_PAGE_SIZE 4096              // One flash sector per write
+#define FLASH_LOG_IDLE_FLUSH_MS 30000         // Write a partial page after this long
+
+struct FlashLogStats
+{
+  bool ready;
+  uint32_t newestSegmentSeq;
+  uint32_t bytesStored;   // Across all segments
+  uint32_t pagesWritten;  // This boot
+  uint32_t droppedBytes;  // Writer still busy with both pages
+  uint32_t writeErrors;
+  uint32_t maxWriteUs;    // Slowest page write
+};
+
+// Reads the ring oldest segment first, up to the size each segment had when
+// the reader was opened
+struct FlashLogReader
+{
+  uint8_t order[FLASH_LOG_SEGMENTS];
+  uint8_t segmentCount;
+  uint8_t position;
+  uint32_t offset;
+  uint32_t segmentSizes[FLASH_LOG_SEGMENTS];
+  File file;
+};
+
+void flashLogBegin(); // Start the writer task - mounting happens there, off the boot path
+
+// Log task only: copy bytes written to Serial into the current page
+void flashLogAppend(const uint8_t *data, size_t length);
+void flashLogIdle();  // Log task only: hand over a partial page when due
+
+// Ask for the partial page to be written now; flashLogFlushed(ticket) turns true
+// once it is on flash
+uint32_t flashLogRequestFlush();
+bool flashLogFlushed(uint32_t ticket);
+
+bool flashLogOpenReader(FlashLogReader &reader);
+size_t flashLogRead(FlashLogReader &reader, uint8_t *buffer, size_t size); // 0 at the end
+void flashLogCloseReader(FlashLogReader &reader);
+
+void getFlashLogStats(FlashLogStats &stats);
+
+#endif // FLASH_LOG_H
@@ -43,22 +43,22 @@ bool _drawTriangle = true;
 int _timerLeftMinutes = 0;
 int _timerLeftSeconds = 0;
 bool _timerLeftRunning = false;
-unsigned long _timerLeftStartTime = 0;
+uint64_t _timerLeftStartTime = 0;
 int _timerRightMinutes = 0;
 int _timerRightSeconds = 0;
 bool _timerRightRunning = false;
-unsigned long _timerRightStartTime = 0;
-unsigned long _currentTime = 0; // Global time for all animations
+uint64_t _timerRightStartTime = 0;
+uint64_t _currentTime = 0; // Global monotonic time (ms) for all animations and scheduling
 
 // Flush flow state variables
 bool _flushFlowActive = false;
-unsigned long _flushFlowStartTime = 0;
+uint64_t _flushFlowStartTime = 0;
 bool _initialRightFlushStarted = false;
 int _flushCount = 0;
 bool _leftFlushActive = false;
 bool _rightFlushActive = false;
-unsigned long _leftFlushStartTime = 0;
-unsigned long _rightFlushStartTime = 0;
+uint64_t _leftFlushStartTime = 0;
+uint64_t _rightFlushStartTime = 0;
 
 // Animation states [AnimationType][Location] - 0=Toilet, 1=Camera, 2=WasteRepo
 AnimationState _animStates[3][2] = {
@@ -84,7 +84,7 @@ const int RELAY_T2_PIN = 38;
 const unsigned long BUTTON_DEBOUNCE_MS = 300;
 
 // UI state variables
-unsigned long lastButtonPress = 0;
+uint64_t lastButtonPress = 0;
 
 // TFT object
 TFT_eSPI tft = TFT_eSPI();
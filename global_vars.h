@@ -3,7 +3,7 @@
 
 #include <TFT_eSPI.h>
 #include <LiquidCrystal_I2C.h>
-#include <HTTPClient.h>
+#include "time_base.h"
 
 // Forward declaration of Shape class
 class Shape;
@@ -68,30 +68,30 @@ extern bool _drawTriangle;
 extern int _timerLeftMinutes;
 extern int _timerLeftSeconds;
 extern bool _timerLeftRunning;
-extern unsigned long _timerLeftStartTime;
+extern uint64_t _timerLeftStartTime;
 extern int _timerRightMinutes;
 extern int _timerRightSeconds;
 extern bool _timerRightRunning;
-extern unsigned long _timerRightStartTime;
-extern unsigned long _currentTime;
+extern uint64_t _timerRightStartTime;
+extern uint64_t _currentTime; // Monotonic ms from monoMillis()
 
 // UI state variables
-extern unsigned long lastButtonPress;
+extern uint64_t lastButtonPress;
 
 // Flush flow state variables
 extern bool _flushFlowActive;
-extern unsigned long _flushFlowStartTime;
+extern uint64_t _flushFlowStartTime;
 extern bool _initialRightFlushStarted;
 extern int _flushCount;
 extern bool _leftFlushActive;
 extern bool _rightFlushActive;
-extern unsigned long _leftFlushStartTime;
-extern unsigned long _rightFlushStartTime;
+extern uint64_t _leftFlushStartTime;
+extern uint64_t _rightFlushStartTime;
 
 // Animation state structure
 struct AnimationState {
   int stage;
-  unsigned long lastTime;
+  uint64_t lastTime;
   bool active;
 };
 
@@ -115,24 +115,22 @@ extern Shape *_wasteRepoLeftShape;
 extern Shape *_wasteRepoRightShape;
 extern Shape *_hamburgerShape;
 
-// WiFi/HTTP object management
-extern HTTPClient* httpClient;
+// Emergency network recycle request (serviced by the network task)
 extern bool wifiNeedsRecreation;
-extern unsigned long lastRightCameraCapture;
 
 // Simplified memory snapshot for ESP-IDF analysis
 struct MemorySnapshot {
   size_t freeHeap;
   size_t minFreeHeap;
   size_t trackedObjects;
-  unsigned long timestamp;
+  uint64_t timestamp;
   
   void capture();
   void compare(MemorySnapshot& previous);
 };
 extern int completedWorkflowCycles;
 extern bool firstAnalysisComplete;
-extern unsigned long lastMemoryAnalysis;
+extern uint64_t lastMemoryAnalysis;
 
 // Location enum
 enum Location
@@ -0,0 +1,298 @@
+#include "heap_tags.h"
+#include "log_service.h"
+#include "time_base.h"
+#include <atomic>
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+
+#if defined(ESP_PLATFORM)
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#endif
+
+static const int HEAP_TAG_TASK_SLOTS = 12; // Tasks that can hold a scope at once
+
+static const char *HEAP_TAG_NAMES[HEAP_TAG_COUNT] = { "untagged", "network", "ui", "settings", "logging" };
+
+struct TagCounters
+{
+  std::atomic<uint32_t> liveBytes;
+  std::atomic<uint32_t> peakBytes;
+  std::atomic<uint32_t> liveBlocks;
+  std::atomic<uint32_t> allocs;
+  std::atomic<uint32_t> frees;
+};
+
+static TagCounters counters[HEAP_TAG_COUNT];
+
+// ================== Current tag per task ==================
+// thread_local is not usable here: global constructors allocate before the
+// scheduler has set up per-task storage. A short table keyed by task handle
+// works from the first instruction.
+
+struct TaskTagSlot
+{
+  std::atomic<void *> task;
+  volatile HeapTag tag;
+};
+
+static TaskTagSlot taskTags[HEAP_TAG_TASK_SLOTS];
+
+static inline void *currentTaskKey()
+{
+#if defined(ESP_PLATFORM)
+  return (void *)xTaskGetCurrentTaskHandle();
+#else
+  static thread_local char key;
+  return &key;
+#endif
+}
+
+static TaskTagSlot *findSlot(void *task, bool claim)
+{
+  if (!task)
+    return nullptr;
+  for (int i = 0; i < HEAP_TAG_TASK_SLOTS; i++)
+  {
+    if (taskTags[i].task.load(std::memory_order_acquire) == task)
+      return &taskTags[i];
+  }
+  if (!claim)
+    return nullptr;
+  for (int i = 0; i < HEAP_TAG_TASK_SLOTS; i++)
+  {
+    void *expected = nullptr;
+    if (taskTags[i].task.compare_exchange_strong(expected, task, std::memory_order_acq_rel))
+    {
+      taskTags[i].tag = HEAP_TAG_UNTAGGED;
+      return &taskTags[i];
+    }
+  }
+  return nullptr; // Table full - this task stays untagged
+}
+
+HeapTag heapTagCurrent()
+{
+  TaskTagSlot *slot = findSlot(currentTaskKey(), false);
+  return slot ? slot->tag : HEAP_TAG_UNTAGGED;
+}
+
+HeapTagScope::HeapTagScope(HeapTag tag) : previous(HEAP_TAG_UNTAGGED)
+{
+  TaskTagSlot *slot = findSlot(currentTaskKey(), true);
+  if (slot)
+  {
+    previous = slot->tag;
+    slot->tag = tag;
+  }
+}
+
+HeapTagScope::~HeapTagScope()
+{
+  TaskTagSlot *slot = findSlot(currentTaskKey(), false);
+  if (slot)
+    slot->tag = previous;
+}
+
+const char *heapTagName(HeapTag tag)
+{
+  return (tag < HEAP_TAG_COUNT) ? HEAP_TAG_NAMES[tag] : "?";
+}
+
+// ================== Tagged allocation ==================
+
+#if HEAP_TAGS_ENABLED
+
+static const uint16_t HEAP_TAG_MAGIC = 0x48A7;
+
+// Sits immediately before the pointer handed out
+struct AllocHeader
+{
+  uint32_t size;
+  uint16_t magic;
+  uint8_t tag;
+  uint8_t reserved;
+};
+
+// Prefix size that keeps the returned pointer aligned like malloc's
+static const size_t HEADER_SPACE =
+  alignof(max_align_t) > sizeof(AllocHeader) ? alignof(max_align_t) : sizeof(AllocHeader);
+
+static inline AllocHeader *headerOf(void *ptr)
+{
+  return (AllocHeader *)((uint8_t *)ptr - sizeof(AllocHeader));
+}
+
+static void charge(uint8_t tag, uint32_t size)
+{
+  TagCounters &c = counters[tag];
+  uint32_t live = c.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+  c.liveBlocks.fetch_add(1, std::memory_order_relaxed);
+  c.allocs.fetch_add(1, std::memory_order_relaxed);
+  uint32_t peak = c.peakBytes.load(std::memory_order_relaxed);
+  while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+  {
+  }
+}
+
+static void discharge(uint8_t tag, uint32_t size)
+{
+  TagCounters &c = counters[tag];
+  c.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+  c.liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+  c.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void *allocTagged(size_t size, uint32_t caps)
+{
+#if defined(ESP_PLATFORM)
+  uint8_t *raw = (uint8_t *)(caps ? heap_caps_malloc(size + HEADER_SPACE, caps) : malloc(size + HEADER_SPACE));
+#else
+  (void)caps;
+  uint8_t *raw = (uint8_t *)malloc(size + HEADER_SPACE);
+#endif
+  if (!raw)
+    return nullptr;
+
+  void *ptr = raw + HEADER_SPACE;
+  AllocHeader *header = headerOf(ptr);
+  header->size = (uint32_t)size;
+  header->magic = HEAP_TAG_MAGIC;
+  header->tag = heapTagCurrent();
+  header->reserved = 0;
+  charge(header->tag, header->size);
+  return ptr;
+}
+
+static void freeTagged(void *ptr)
+{
+  if (!ptr)
+    return;
+
+  AllocHeader *header = headerOf(ptr);
+  if (header->magic != HEAP_TAG_MAGIC || header->tag >= HEAP_TAG_COUNT)
+  {
+    free(ptr); // Not one of ours
+    return;
+  }
+  discharge(header->tag, header->size);
+  header->magic = 0;
+  free((uint8_t *)ptr - HEADER_SPACE);
+}
+
+// heap_caps blocks go back through free() like any other
+void *tagged_malloc_caps(size_t size, uint32_t caps)
+{
+  return allocTagged(size, caps);
+}
+
+void tagged_free(void *ptr)
+{
+  freeTagged(ptr);
+}
+
+// Replacements for the global allocation functions. Aligned (std::align_val_t)
+// overloads are left to the library.
+static void *newTagged(size_t size)
+{
+  void *ptr = allocTagged(size ? size : 1, 0);
+  if (!ptr)
+  {
+#if __cpp_exceptions
+    throw std::bad_alloc();
+#else
+    abort();
+#endif
+  }
+  return ptr;
+}
+
+void *operator new(size_t size) { return newTagged(size); }
+void *operator new[](size_t size) { return newTagged(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return allocTagged(size ? size : 1, 0); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return allocTagged(size ? size : 1, 0); }
+void operator delete(void *ptr) noexcept { freeTagged(ptr); }
+void operator delete[](void *ptr) noexcept { freeTagged(ptr); }
+void operator delete(void *ptr, size_t) noexcept { freeTagged(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { freeTagged(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { freeTagged(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { freeTagged(ptr); }
+
+#else // !HEAP_TAGS_ENABLED
+
+static const size_t HEADER_SPACE = 0;
+
+#if defined(ESP_PLATFORM)
+void *tagged_malloc_caps(size_t size, uint32_t caps) { return heap_caps_malloc(size, caps); }
+#else
+void *tagged_malloc_caps(size_t size, uint32_t) { return malloc(size); }
+#endif
+void tagged_free(void *ptr) { free(ptr); }
+
+#endif // HEAP_TAGS_ENABLED
+
+// ================== Reporting ==================
+
+void getHeapTagStats(HeapTag tag, HeapTagStats &stats)
+{
+  const TagCounters &c = counters[tag < HEAP_TAG_COUNT ? tag : HEAP_TAG_UNTAGGED];
+  stats.liveBytes = c.liveBytes.load(std::memory_order_relaxed);
+  stats.peakBytes = c.peakBytes.load(std::memory_order_relaxed);
+  stats.liveBlocks = c.liveBlocks.load(std::memory_order_relaxed);
+  stats.allocs = c.allocs.load(std::memory_order_relaxed);
+  stats.frees = c.frees.load(std::memory_order_relaxed);
+}
+
+uint32_t heapTaggedBlocks()
+{
+  uint32_t total = 0;
+  for (int i = 0; i < HEAP_TAG_COUNT; i++)
+    total += counters[i].liveBlocks.load(std::memory_order_relaxed);
+  return total;
+}
+
+uint32_t heapTaggedBytes()
+{
+  uint32_t total = 0;
+  for (int i = 0; i < HEAP_TAG_COUNT; i++)
+    total += counters[i].liveBytes.load(std::memory_order_relaxed);
+  return total;
+}
+
+void logHeapTags()
+{
+  static uint64_t lastReportMs = 0;
+  static uint32_t lastAllocs[HEAP_TAG_COUNT];
+
+  uint64_t nowMs = monoMillis();
+  uint64_t elapsedMs = nowMs - lastReportMs;
+  if (elapsedMs == 0)
+    elapsedMs = 1;
+
+  // Used heap that no tag accounts for: ESP-IDF/WiFi/lwIP, String, headers
+  uint32_t blocks = heapTaggedBlocks();
+  uint32_t tracked = heapTaggedBytes();
+#if defined(ESP_PLATFORM)
+  int32_t used = (int32_t)(ESP.getHeapSize() - ESP.getFreeHeap());
+#else
+  int32_t used = (int32_t)(tracked + blocks * HEADER_SPACE); // No heap total on the host
+#endif
+  LOG_I(MEM, "[HEAP_TAGS] Tracked: %lu bytes in %lu blocks (+%lu header bytes), untracked: %ld bytes",
+    (unsigned long)tracked, (unsigned long)blocks, (unsigned long)(blocks * HEADER_SPACE),
+    (long)(used - (int32_t)tracked - (int32_t)(blocks * HEADER_SPACE)));
+
+  for (int i = 0; i < HEAP_TAG_COUNT; i++)
+  {
+    HeapTagStats stats;
+    getHeapTagStats((HeapTag)i, stats);
+    uint32_t perMinute = (uint32_t)((uint64_t)(stats.allocs - lastAllocs[i]) * 60000ULL / elapsedMs);
+    LOG_I(MEM, "[HEAP_TAGS] %-8s live: %6lu peak: %6lu blocks: %4lu allocs/min: %lu", HEAP_TAG_NAMES[i],
+      (unsigned long)stats.liveBytes, (unsigned long)stats.peakBytes, (unsigned long)stats.liveBlocks,
+      (unsigned long)perMinute);
+    lastAllocs[i] = stats.allocs;
+  }
+  lastReportMs = nowMs;
+}
@@ -0,0 +1,74 @@
+#ifndef HEAP_TAGS_H
+#define HEAP_TAGS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-subsystem heap accounting.
+// The global operator new/delete are replaced (heap_tags.cpp) and every block
+// gets a small header recording its size and the tag of the scope that
+// allocated it. The block pools reserve their regions through tagged_malloc_caps()
+// and are charged the same way. The current tag is per task: put a HeapTagScope
+// at the top of a task function, or around a block of UI/settings work, and
+// everything that block allocates is charged to that tag.
+// Nothing else in the sketch calls malloc directly; what ESP-IDF internals and
+// Arduino String allocate is not seen, and the report shows it as the untracked
+// remainder of used heap.
+// Nothing here depends on the Arduino core or ESP-IDF outside ESP_PLATFORM:
+// on the host the task key falls back to a thread_local and the report has no
+// heap total, so host tests (tools/host_tests) link the hooks unchanged.
+
+#ifndef HEAP_TAGS_ENABLED
+#define HEAP_TAGS_ENABLED 1
+#endif
+
+enum HeapTag : uint8_t
+{
+  HEAP_TAG_UNTAGGED, // No scope active (setup(), loop() housekeeping, libraries)
+  HEAP_TAG_NETWORK,  // Network task, status server, WiFi bring-up
+  HEAP_TAG_UI,       // Drawing, shapes, touch handling, LCD
+  HEAP_TAG_SETTINGS, // Settings screen and Preferences
+  HEAP_TAG_LOGGING,  // Log and flash log tasks
+  HEAP_TAG_COUNT
+};
+
+struct HeapTagStats
+{
+  uint32_t liveBytes;   // Requested bytes currently allocated (headers excluded)
+  uint32_t peakBytes;
+  uint32_t liveBlocks;
+  uint32_t allocs;      // Since boot
+  uint32_t frees;
+};
+
+// Charges allocations made on this task to tag until the scope ends (scopes nest)
+class HeapTagScope
+{
+public:
+  explicit HeapTagScope(HeapTag tag);
+  ~HeapTagScope();
+
+  HeapTagScope(const HeapTagScope &) = delete;
+  HeapTagScope &operator=(const HeapTagScope &) = delete;
+
+private:
+  HeapTag previous;
+};
+
+HeapTag heapTagCurrent();
+const char *heapTagName(HeapTag tag);
+
+// heap_caps_malloc() with the same accounting as operator new, for regions that
+// need a memory class (caps are ignored off-target); only free with tagged_free()
+void *tagged_malloc_caps(size_t size, uint32_t caps);
+void tagged_free(void *ptr);
+
+void getHeapTagStats(HeapTag tag, HeapTagStats &stats);
+uint32_t heapTaggedBlocks(); // Live blocks across all tags
+uint32_t heapTaggedBytes();
+
+// writeLog() one line per tag: live, peak, blocks and allocations per minute since
+// the previous report
+void logHeapTags();
+
+#endif // HEAP_TAGS_H
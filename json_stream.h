@@ -0,0 +1,461 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <Arduino.h>
+
+// Zero-allocation streaming JSON.
+// JsonWriter prints a document straight to any Print (socket, fixed buffer) as it is
+// built - nothing is held in memory beyond a nesting bitmask. Keys go through JKEY(),
+// which rejects at compile time any literal that would need escaping, so keys are
+// emitted verbatim. JsonReader is a pull tokenizer that walks a mutable buffer and
+// unescapes strings in place; token text points into the caller's buffer.
+
+// ================== Keys ==================
+
+struct JsonKey
+{
+  const char *str;
+};
+
+constexpr bool jsonKeyIsSafe(const char *key, size_t length)
+{
+  if (length == 0)
+    return false;
+  for (size_t i = 0; i < length; i++)
+  {
+    char c = key[i];
+    if (c == '"' || c == '\\' || (unsigned char)c < 0x20)
+      return false;
+  }
+  return true;
+}
+
+#define JKEY(literal) \
+  ([]() { \
+    static_assert(jsonKeyIsSafe(literal, sizeof(literal) - 1), "JSON key must be non-empty and need no escaping: " literal); \
+    return JsonKey{literal}; \
+  }())
+
+// ================== Fixed buffer output ==================
+
+// Print into a caller-owned char array. Always NUL-terminated; overflow() tells
+// whether anything was cut off.
+class FixedBufferPrint : public Print
+{
+public:
+  FixedBufferPrint(char *buffer, size_t size) : buffer(buffer), size(size), used(0), overflowed(false)
+  {
+    if (size > 0)
+      buffer[0] = '\0';
+  }
+
+  size_t write(uint8_t c) override
+  {
+    if (used + 1 >= size)
+    {
+      overflowed = true;
+      return 0;
+    }
+    buffer[used++] = (char)c;
+    buffer[used] = '\0';
+    return 1;
+  }
+
+  size_t write(const uint8_t *data, size_t length) override
+  {
+    size_t room = (size > used + 1) ? size - used - 1 : 0;
+    size_t copy = (length < room) ? length : room;
+    memcpy(buffer + used, data, copy);
+    used += copy;
+    if (size > 0)
+      buffer[used] = '\0';
+    if (copy < length)
+      overflowed = true;
+    return copy;
+  }
+
+  size_t length() const { return used; }
+  bool overflow() const { return overflowed; }
+
+private:
+  char *buffer;
+  size_t size;
+  size_t used;
+  bool overflowed;
+};
+
+// ================== Writer ==================
+
+class JsonWriter
+{
+public:
+  explicit JsonWriter(Print &out) : out(out), depth(0), needComma(0), written(0) {}
+
+  // Containers - the keyed forms open a member of the enclosing object
+  void beginObject() { separator(); open('{'); }
+  void beginObject(JsonKey key) { writeKey(key); open('{'); }
+  void endObject() { close('}'); }
+  void beginArray() { separator(); open('['); }
+  void beginArray(JsonKey key) { writeKey(key); open('['); }
+  void endArray() { close(']'); }
+
+  // Object members
+  void field(JsonKey key, const char *value) { writeKey(key); writeString(value); }
+  void field(JsonKey key, bool value) { writeKey(key); writeRaw(value ? "true" : "false"); }
+  void field(JsonKey key, int value) { writeKey(key); writeSigned(value); }
+  void field(JsonKey key, long value) { writeKey(key); writeSigned(value); }
+  void field(JsonKey key, unsigned int value) { writeKey(key); writeUnsigned(value); }
+  void field(JsonKey key, unsigned long value) { writeKey(key); writeUnsigned(value); }
+  void field(JsonKey key, unsigned long long value) { writeKey(key); writeUnsigned(value); }
+  void fieldNull(JsonKey key) { writeKey(key); writeRaw("null"); }
+
+  // Array elements
+  void value(const char *value) { separator(); writeString(value); }
+  void value(int value) { separator(); writeSigned(value); }
+  void value(long value) { separator(); writeSigned(value); }
+  void value(unsigned long long value) { separator(); writeUnsigned(value); }
+  void value(bool value) { separator(); writeRaw(value ? "true" : "false"); }
+
+  size_t bytesWritten() const { return written; }
+
+private:
+  static const int MAX_DEPTH = 16;
+
+  Print &out;
+  uint8_t depth;
+  uint16_t needComma; // Bit n set when level n already has a member
+  size_t written;
+
+  void writeRaw(const char *text) { written += out.print(text); }
+  void writeChar(char c) { written += out.write((uint8_t)c); }
+
+  void separator()
+  {
+    if (depth == 0)
+      return;
+    uint16_t bit = 1u << (depth - 1);
+    if (needComma & bit)
+      writeChar(',');
+    needComma |= bit;
+  }
+
+  void open(char c)
+  {
+    writeChar(c);
+    if (depth < MAX_DEPTH)
+    {
+      depth++;
+      needComma &= ~(1u << (depth - 1));
+    }
+  }
+
+  void close(char c)
+  {
+    if (depth > 0)
+      depth--;
+    writeChar(c);
+  }
+
+  void writeKey(JsonKey key)
+  {
+    separator();
+    writeChar('"');
+    writeRaw(key.str);
+    writeRaw("\":");
+  }
+
+  void writeUnsigned(unsigned long long value)
+  {
+    char digits[21];
+    int pos = sizeof(digits);
+    digits[--pos] = '\0';
+    do
+    {
+      digits[--pos] = (char)('0' + value % 10);
+      value /= 10;
+    } while (value > 0);
+    writeRaw(digits + pos);
+  }
+
+  void writeSigned(long long value)
+  {
+    if (value < 0)
+    {
+      writeChar('-');
+      writeUnsigned((unsigned long long)(-(value + 1)) + 1);
+    }
+    else
+    {
+      writeUnsigned((unsigned long long)value);
+    }
+  }
+
+  void writeString(const char *text)
+  {
+    if (!text)
+    {
+      writeRaw("null");
+      return;
+    }
+    writeChar('"');
+    const char *run = text;
+    for (const char *p = text; *p; p++)
+    {
+      unsigned char c = (unsigned char)*p;
+      if (c != '"' && c != '\\' && c >= 0x20)
+        continue;
+      // Flush the clean run, then the escape
+      written += out.write((const uint8_t *)run, p - run);
+      run = p + 1;
+      char escape[7];
+      switch (c)
+      {
+      case '"':  strcpy(escape, "\\\""); break;
+      case '\\': strcpy(escape, "\\\\"); break;
+      case '\n': strcpy(escape, "\\n"); break;
+      case '\r': strcpy(escape, "\\r"); break;
+      case '\t': strcpy(escape, "\\t"); break;
+      default:   snprintf(escape, sizeof(escape), "\\u%04x", c); break;
+      }
+      writeRaw(escape);
+    }
+    const char *end = run + strlen(run);
+    written += out.write((const uint8_t *)run, end - run);
+    writeChar('"');
+  }
+};
+
+// ================== Reader ==================
+
+enum JsonToken : uint8_t
+{
+  JSON_BEGIN_OBJECT,
+  JSON_END_OBJECT,
+  JSON_BEGIN_ARRAY,
+  JSON_END_ARRAY,
+  JSON_KEY,
+  JSON_STRING,
+  JSON_NUMBER,
+  JSON_TRUE,
+  JSON_FALSE,
+  JSON_NULL,
+  JSON_END,   // Input exhausted
+  JSON_ERROR  // Malformed input - the reader stays in this state
+};
+
+class JsonReader
+{
+public:
+  // buffer is modified in place (strings are unescaped and NUL-terminated where they end)
+  JsonReader(char *buffer, size_t length) : pos(buffer), end(buffer + length), tokenText(nullptr), lastToken(JSON_END), depth(0), objectLevels(0) {}
+
+  JsonToken next()
+  {
+    if (lastToken == JSON_ERROR)
+      return JSON_ERROR;
+
+    skipSeparators();
+    if (pos >= end || *pos == '\0')
+      return lastToken = (depth == 0) ? JSON_END : JSON_ERROR;
+
+    char c = *pos;
+    tokenText = pos;
+    switch (c)
+    {
+    case '{':
+      pos++;
+      push(true);
+      return lastToken = JSON_BEGIN_OBJECT;
+    case '[':
+      pos++;
+      push(false);
+      return lastToken = JSON_BEGIN_ARRAY;
+    case '}':
+    case ']':
+      pos++;
+      if (depth > 0)
+        depth--;
+      afterColon = false;
+      return lastToken = (c == '}') ? JSON_END_OBJECT : JSON_END_ARRAY;
+    case '"':
+    {
+      bool isKey = inObject() && !afterColon;
+      if (!readString())
+        return lastToken = JSON_ERROR;
+      if (isKey)
+      {
+        skipWhitespace();
+        if (pos >= end || *pos != ':')
+          return lastToken = JSON_ERROR;
+        pos++;
+        afterColon = true;
+        return lastToken = JSON_KEY;
+      }
+      afterColon = false;
+      return lastToken = JSON_STRING;
+    }
+    default:
+      afterColon = false;
+      if (matchLiteral("true"))
+        return lastToken = JSON_TRUE;
+      if (matchLiteral("false"))
+        return lastToken = JSON_FALSE;
+      if (matchLiteral("null"))
+        return lastToken = JSON_NULL;
+      if (c == '-' || (c >= '0' && c <= '9'))
+      {
+        readNumber();
+        return lastToken = JSON_NUMBER;
+      }
+      return lastToken = JSON_ERROR;
+    }
+  }
+
+  // Text of the last key/string token (NUL-terminated, in the input buffer).
+  // For numbers it points at the first digit - use asLong().
+  const char *text() const { return tokenText; }
+  long asLong() const { return tokenText ? strtol(tokenText, nullptr, 10) : 0; }
+
+  // Skip the value that follows a key (or the current array element), including nested containers
+  bool skipValue()
+  {
+    JsonToken token = next();
+    if (token == JSON_BEGIN_OBJECT || token == JSON_BEGIN_ARRAY)
+    {
+      uint8_t target = depth - 1;
+      while (depth > target)
+      {
+        token = next();
+        if (token == JSON_ERROR || token == JSON_END)
+          return false;
+      }
+    }
+    return token != JSON_ERROR && token != JSON_END;
+  }
+
+  // Advance to the named member of the current object; the reader is left before its value
+  bool findKey(const char *key)
+  {
+    for (;;)
+    {
+      JsonToken token = next();
+      if (token == JSON_KEY)
+      {
+        if (strcmp(tokenText, key) == 0)
+          return true;
+        if (!skipValue())
+          return false;
+      }
+      else if (token != JSON_BEGIN_OBJECT)
+      {
+        return false;
+      }
+    }
+  }
+
+private:
+  static const int MAX_DEPTH = 16;
+
+  char *pos;
+  char *end;
+  char *tokenText;
+  JsonToken lastToken;
+  uint8_t depth;
+  uint16_t objectLevels; // Bit n set when level n is an object
+  bool afterColon = false;
+
+  void push(bool isObject)
+  {
+    if (depth < MAX_DEPTH)
+    {
+      if (isObject)
+        objectLevels |= (1u << depth);
+      else
+        objectLevels &= ~(1u << depth);
+    }
+    depth++;
+    afterColon = false;
+  }
+
+  bool inObject() const
+  {
+    return depth > 0 && depth <= MAX_DEPTH && (objectLevels & (1u << (depth - 1)));
+  }
+
+  void skipWhitespace()
+  {
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\r' || *pos == '\n'))
+      pos++;
+  }
+
+  void skipSeparators()
+  {
+    skipWhitespace();
+    if (pos < end && *pos == ',')
+    {
+      pos++;
+      afterColon = false;
+      skipWhitespace();
+    }
+  }
+
+  bool matchLiteral(const char *literal)
+  {
+    size_t length = strlen(literal);
+    if ((size_t)(end - pos) < length || strncmp(pos, literal, length) != 0)
+      return false;
+    pos += length;
+    return true;
+  }
+
+  // Numbers are not terminated in place (that would eat the following separator);
+  // asLong() stops at the first non-numeric character
+  void readNumber()
+  {
+    while (pos < end && ((*pos && strchr("+-.eE", *pos)) || (*pos >= '0' && *pos <= '9')))
+      pos++;
+  }
+
+  // Unescape in place; the token text starts after the opening quote
+  bool readString()
+  {
+    char *read = pos + 1;
+    char *write = read;
+    tokenText = read;
+    while (read < end && *read != '"')
+    {
+      char c = *read++;
+      if (c == '\\' && read < end)
+      {
+        char e = *read++;
+        switch (e)
+        {
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'u':
+          // Only the ASCII range is kept; anything else becomes '?'
+          if (end - read >= 4)
+          {
+            char hex[5] = { read[0], read[1], read[2], read[3], '\0' };
+            long code = strtol(hex, nullptr, 16);
+            c = (code > 0 && code < 0x80) ? (char)code : '?';
+            read += 4;
+          }
+          break;
+        default: c = e; break; // \" \\ \/
+        }
+      }
+      *write++ = c;
+    }
+    if (read >= end)
+      return false;
+    *write = '\0'; // Lands on or before the closing quote
+    pos = read + 1;
+    return true;
+  }
+};
+
+#endif // JSON_STREAM_H
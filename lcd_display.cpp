@@ -0,0 +1,154 @@
+#include "lcd_display.h"
+#include "log_service.h"
+#include "heap_tags.h"
+#include "time_base.h"
+#include <LiquidCrystal_I2C.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+extern LiquidCrystal_I2C lcd;
+
+static const uint32_t LCD_TASK_STACK_SIZE = 3072;
+static const UBaseType_t LCD_TASK_PRIORITY = tskIDLE_PRIORITY + 1;
+static const BaseType_t LCD_TASK_CORE = 0;
+static const int LCD_CURSOR_MOVE_COST = 1; // setCursor is one command byte
+
+// Wanted text, written by lcdSetLines() on any task
+static portMUX_TYPE lcdLock = portMUX_INITIALIZER_UNLOCKED;
+static char wanted[LCD_ROWS][LCD_COLS];
+
+// What the panel shows and where its cursor is - only the flushing task touches these
+static char shown[LCD_ROWS][LCD_COLS];
+static int cursorRow = -1;
+static int cursorCol = 0;
+static uint64_t lastFlushMs = 0;
+
+static TaskHandle_t lcdTaskHandle = nullptr;
+static LcdStats lcdStats = {};
+
+static void fillRow(char *row, const char *text)
+{
+  int i = 0;
+  for (; text && text[i] && i < LCD_COLS; i++)
+    row[i] = text[i];
+  for (; i < LCD_COLS; i++)
+    row[i] = ' ';
+}
+
+static void lcdTask(void *parameter)
+{
+  HeapTagScope heapTag(HEAP_TAG_UI);
+
+  for (;;)
+  {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    uint64_t sinceLast = monoMillis() - lastFlushMs;
+    if (sinceLast < LCD_MIN_FLUSH_INTERVAL_MS)
+    {
+      vTaskDelay(pdMS_TO_TICKS(LCD_MIN_FLUSH_INTERVAL_MS - sinceLast));
+      ulTaskNotifyTake(pdTRUE, 0); // Updates made while waiting are covered by this flush
+    }
+    lcdFlushNow();
+  }
+}
+
+void lcdBegin()
+{
+  // lcd.init() has just cleared the panel
+  memset(shown, ' ', sizeof(shown));
+  memset(wanted, ' ', sizeof(wanted));
+  cursorRow = -1;
+
+  if (lcdTaskHandle)
+    return;
+  xTaskCreatePinnedToCore(lcdTask, "lcd", LCD_TASK_STACK_SIZE, nullptr, LCD_TASK_PRIORITY, &lcdTaskHandle,
+    LCD_TASK_CORE);
+}
+
+void lcdSetLines(const char *line1, const char *line2)
+{
+  char rows[LCD_ROWS][LCD_COLS];
+  fillRow(rows[0], line1);
+  fillRow(rows[1], line2);
+
+  portENTER_CRITICAL(&lcdLock);
+  memcpy(wanted, rows, sizeof(wanted));
+  lcdStats.requests++;
+  portEXIT_CRITICAL(&lcdLock);
+
+  if (lcdTaskHandle)
+    xTaskNotifyGive(lcdTaskHandle);
+}
+
+bool lcdFlushNow()
+{
+  char next[LCD_ROWS][LCD_COLS];
+  portENTER_CRITICAL(&lcdLock);
+  memcpy(next, wanted, sizeof(next));
+  portEXIT_CRITICAL(&lcdLock);
+
+  uint64_t startUs = monoMicros();
+  uint32_t chars = 0;
+  uint32_t moves = 0;
+  for (int row = 0; row < LCD_ROWS; row++)
+  {
+    int col = 0;
+    while (col < LCD_COLS)
+    {
+      if (next[row][col] == shown[row][col])
+      {
+        col++;
+        continue;
+      }
+
+      // Extend the run over gaps too short to be worth a cursor move
+      int last = col;
+      for (int i = col + 1; i < LCD_COLS && i - last <= LCD_CURSOR_MOVE_COST + 1; i++)
+      {
+        if (next[row][i] != shown[row][i])
+          last = i;
+      }
+
+      if (row != cursorRow || col != cursorCol)
+      {
+        lcd.setCursor(col, row);
+        moves++;
+      }
+      for (int i = col; i <= last; i++)
+      {
+        lcd.write((uint8_t)next[row][i]);
+        shown[row][i] = next[row][i];
+      }
+      chars += last - col + 1;
+      cursorRow = row;
+      cursorCol = last + 1; // Past column 15 the address runs off-screen, not onto the next row
+      col = last + 1;
+    }
+  }
+
+  lastFlushMs = monoMillis();
+  if (chars == 0)
+  {
+    lcdStats.unchanged++;
+    return false;
+  }
+
+  uint32_t elapsedUs = (uint32_t)(monoMicros() - startUs);
+  lcdStats.flushes++;
+  lcdStats.chars += chars;
+  lcdStats.cursorMoves += moves;
+  lcdStats.lcdBytes += chars + moves * LCD_CURSOR_MOVE_COST;
+  lcdStats.lastFlushUs = elapsedUs;
+  if (elapsedUs > lcdStats.maxFlushUs)
+    lcdStats.maxFlushUs = elapsedUs;
+  LOG_V(UI, "[LCD] %lu chars, %lu cursor moves in %luus", (unsigned long)chars, (unsigned long)moves,
+    (unsigned long)elapsedUs);
+  return true;
+}
+
+void getLcdStats(LcdStats &stats)
+{
+  portENTER_CRITICAL(&lcdLock);
+  stats = lcdStats;
+  portEXIT_CRITICAL(&lcdLock);
+}
@@ -0,0 +1,38 @@
+#ifndef LCD_DISPLAY_H
+#define LCD_DISPLAY_H
+
+#include <Arduino.h>
+
+// Shadow-buffered driver for the 16x2 I2C LCD.
+// Callers only replace the wanted text (lcdSetLines), which costs a copy and a
+// task notification - no I2C. The LCD task keeps a copy of what the panel shows
+// and, at most once per LCD_MIN_FLUSH_INTERVAL_MS, writes just the characters that
+// differ: each changed run gets one cursor move (skipped when the cursor is
+// already there) and runs separated by a single unchanged character are written
+// as one, since rewriting that character costs the same as moving the cursor.
+// The panel is never cleared after lcd.init(). Several updates inside one
+// interval coalesce into a single flush of the latest text.
+
+#define LCD_COLS 16
+#define LCD_ROWS 2
+#define LCD_MIN_FLUSH_INTERVAL_MS 100 // Caps panel writes at 10 per second
+#define LCD_I2C_BYTES_PER_LCD_BYTE 12 // LiquidCrystal_I2C: 2 nibbles x 3 expander writes x (address + data)
+
+struct LcdStats
+{
+  uint32_t requests;    // lcdSetLines() calls
+  uint32_t flushes;     // Flushes that wrote something
+  uint32_t unchanged;   // Flushes that found the panel already showing the text
+  uint32_t chars;       // Characters written
+  uint32_t cursorMoves;
+  uint32_t lcdBytes;    // HD44780 bytes (characters + cursor commands)
+  uint32_t lastFlushUs;
+  uint32_t maxFlushUs;
+};
+
+void lcdBegin();                                       // After lcd.init() - starts the LCD task
+void lcdSetLines(const char *line1, const char *line2); // Padded/truncated to 16 columns, never blocks
+bool lcdFlushNow(); // Write the pending difference on the calling task; true if anything was written
+void getLcdStats(LcdStats &stats);
+
+#endif // LCD_DISPLAY_H
@@ -0,0 +1,844 @@
+#include "log_service.h"
+#include "time_base.h"
+#include "time_service.h"
+#include "flash_log.h"
+#include "heap_tags.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <stdarg.h>
+#include <time.h>
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+static const uint32_t LOG_TASK_STACK_SIZE = 4096;
+static const UBaseType_t LOG_TASK_PRIORITY = tskIDLE_PRIORITY + 1;
+static const BaseType_t LOG_TASK_CORE = 0;          // Keep UART work off the loop() core
+static const uint32_t LOG_IDLE_POLL_MS = 5;
+static const uint32_t LOG_STATS_INTERVAL_MS = 300000;
+
+struct LogRecord
+{
+  const char *format;  // Literal format string - never copied
+  uint64_t monoUs;
+  uint16_t payloadLength;
+  bool truncated;
+  uint8_t payload[LOG_PAYLOAD_SIZE];
+};
+
+struct LogCell
+{
+  std::atomic<uint32_t> sequence;
+  LogRecord record;
+};
+
+static LogCell cells[LOG_RING_SLOTS];
+static std::atomic<uint32_t> enqueuePos(0);
+static std::atomic<uint32_t> dequeuePos(0);
+static LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_POLICY;
+static TaskHandle_t logTaskHandle = nullptr;
+
+uint8_t logRuntimeLevel[LOG_CATEGORY_COUNT] = {
+  LOG_RUNTIME_LEVEL, LOG_RUNTIME_LEVEL, LOG_RUNTIME_LEVEL, LOG_RUNTIME_LEVEL, LOG_RUNTIME_LEVEL, LOG_RUNTIME_LEVEL
+};
+static_assert(LOG_CATEGORY_COUNT == 6, "Update logRuntimeLevel and LOG_CATEGORY_NAMES");
+
+static const char *LOG_CATEGORY_NAMES[LOG_CATEGORY_COUNT] = { "camera", "timer", "waste", "mem", "net", "ui" };
+
+// Statistics - relaxed atomics, written by every producer
+static std::atomic<uint32_t> statEnqueued(0);
+static std::atomic<uint32_t> statDropped(0);
+static std::atomic<uint32_t> statBlocked(0);
+static std::atomic<uint32_t> statTruncated(0);
+static std::atomic<uint32_t> statHighWater(0);
+static std::atomic<uint32_t> statMaxCallerUs(0);
+static std::atomic<uint32_t> statCallerUsTotal(0);
+static uint32_t statBytesOut = 0; // Drain task only
+
+// Cell sequence numbers must be primed before the first writeLog(), which can run
+// from other static constructors - so this runs as early as C++ allows
+static struct LogRingInit
+{
+  LogRingInit()
+  {
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++)
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+} logRingInit __attribute__((init_priority(101)));
+
+// ================== Argument capture ==================
+
+enum LogLength
+{
+  LEN_DEFAULT,
+  LEN_CHAR,
+  LEN_SHORT,
+  LEN_LONG,
+  LEN_LONG_LONG,
+  LEN_SIZE,
+  LEN_PTRDIFF,
+  LEN_INTMAX,
+  LEN_LONG_DOUBLE
+};
+
+// Parsed "%[flags][width][.precision][length]conv"; '*' width/precision are args
+struct LogSpec
+{
+  const char *start;
+  const char *end;     // One past the conversion character
+  bool starWidth;
+  bool starPrecision;
+  LogLength length;
+  char conversion;
+};
+
+static const char *parseSpec(const char *p, LogSpec &spec)
+{
+  spec.start = p++;
+  spec.starWidth = false;
+  spec.starPrecision = false;
+  while (*p && strchr("-+ #0", *p))
+    p++;
+  if (*p == '*')
+  {
+    spec.starWidth = true;
+    p++;
+  }
+  while (*p >= '0' && *p <= '9')
+    p++;
+  if (*p == '.')
+  {
+    p++;
+    if (*p == '*')
+    {
+      spec.starPrecision = true;
+      p++;
+    }
+    while (*p >= '0' && *p <= '9')
+      p++;
+  }
+
+  spec.length = LEN_DEFAULT;
+  switch (*p)
+  {
+  case 'h':
+    p++;
+    spec.length = LEN_SHORT;
+    if (*p == 'h')
+    {
+      p++;
+      spec.length = LEN_CHAR;
+    }
+    break;
+  case 'l':
+    p++;
+    spec.length = LEN_LONG;
+    if (*p == 'l')
+    {
+      p++;
+      spec.length = LEN_LONG_LONG;
+    }
+    break;
+  case 'z': p++; spec.length = LEN_SIZE; break;
+  case 't': p++; spec.length = LEN_PTRDIFF; break;
+  case 'j': p++; spec.length = LEN_INTMAX; break;
+  case 'L': p++; spec.length = LEN_LONG_DOUBLE; break;
+  }
+
+  spec.conversion = *p;
+  spec.end = *p ? p + 1 : p;
+  return spec.end;
+}
+
+static inline bool isIntegerConversion(char c)
+{
+  return c && strchr("diouxXc", c);
+}
+
+static inline bool isFloatConversion(char c)
+{
+  return c && strchr("fFeEgGaA", c);
+}
+
+static bool putBytes(LogRecord &record, const void *data, size_t length)
+{
+  if (record.payloadLength + length > LOG_PAYLOAD_SIZE)
+  {
+    record.truncated = true;
+    return false;
+  }
+  memcpy(record.payload + record.payloadLength, data, length);
+  record.payloadLength += length;
+  return true;
+}
+
+static uint64_t readIntegerArg(va_list *args, LogLength length)
+{
+  switch (length)
+  {
+  case LEN_LONG: return (uint64_t)va_arg(*args, long);
+  case LEN_LONG_LONG: return (uint64_t)va_arg(*args, long long);
+  case LEN_SIZE: return (uint64_t)va_arg(*args, size_t);
+  case LEN_PTRDIFF: return (uint64_t)va_arg(*args, ptrdiff_t);
+  case LEN_INTMAX: return (uint64_t)va_arg(*args, intmax_t);
+  default: return (uint64_t)va_arg(*args, int);
+  }
+}
+
+static void captureArgs(LogRecord &record, va_list *args)
+{
+  record.payloadLength = 0;
+  record.truncated = false;
+
+  for (const char *p = record.format; *p;)
+  {
+    if (*p != '%')
+    {
+      p++;
+      continue;
+    }
+    if (p[1] == '%')
+    {
+      p += 2;
+      continue;
+    }
+
+    LogSpec spec;
+    p = parseSpec(p, spec);
+
+    // '*' arguments are consumed even when the payload is full, to keep va_list in step
+    if (spec.starWidth)
+    {
+      int64_t width = va_arg(*args, int);
+      putBytes(record, &width, sizeof(width));
+    }
+    if (spec.starPrecision)
+    {
+      int64_t precision = va_arg(*args, int);
+      putBytes(record, &precision, sizeof(precision));
+    }
+
+    if (isIntegerConversion(spec.conversion))
+    {
+      uint64_t value = readIntegerArg(args, spec.length);
+      putBytes(record, &value, sizeof(value));
+    }
+    else if (isFloatConversion(spec.conversion))
+    {
+      double value = (spec.length == LEN_LONG_DOUBLE) ? (double)va_arg(*args, long double) : va_arg(*args, double);
+      putBytes(record, &value, sizeof(value));
+    }
+    else if (spec.conversion == 'p')
+    {
+      uint64_t value = (uintptr_t)va_arg(*args, void *);
+      putBytes(record, &value, sizeof(value));
+    }
+    else if (spec.conversion == 's')
+    {
+      // Deep copy - the caller's buffer may be gone by the time the drain task runs
+      const char *text = va_arg(*args, const char *);
+      if (!text)
+        text = "(null)";
+      size_t room = (record.payloadLength < LOG_PAYLOAD_SIZE) ? LOG_PAYLOAD_SIZE - record.payloadLength - 1 : 0;
+      size_t length = strnlen(text, 255);
+      if (length > room)
+      {
+        length = room;
+        record.truncated = true;
+      }
+      if (record.payloadLength < LOG_PAYLOAD_SIZE)
+      {
+        record.payload[record.payloadLength++] = (uint8_t)length;
+        memcpy(record.payload + record.payloadLength, text, length);
+        record.payloadLength += length;
+      }
+    }
+    else if (spec.conversion == 'n')
+    {
+      (void)va_arg(*args, int *);
+    }
+  }
+}
+
+// ================== Ring (Vyukov bounded MPMC) ==================
+
+static LogCell *claimCell(uint32_t &pos)
+{
+  pos = enqueuePos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    LogCell *cell = &cells[pos & (LOG_RING_SLOTS - 1)];
+    uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+    int32_t diff = (int32_t)(sequence - pos);
+    if (diff == 0)
+    {
+      if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        return cell;
+    }
+    else if (diff < 0)
+    {
+      return nullptr; // Full
+    }
+    else
+    {
+      pos = enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+static bool dequeue(LogRecord &out)
+{
+  uint32_t pos = dequeuePos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    LogCell *cell = &cells[pos & (LOG_RING_SLOTS - 1)];
+    uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+    int32_t diff = (int32_t)(sequence - (pos + 1));
+    if (diff == 0)
+    {
+      if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        out = cell->record;
+        cell->sequence.store(pos + LOG_RING_SLOTS, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+    {
+      return false; // Empty
+    }
+    else
+    {
+      pos = dequeuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void writeLog(const char *format, ...)
+{
+  uint64_t startUs = monoMicros();
+
+  uint32_t pos;
+  LogCell *cell = claimCell(pos);
+  if (!cell)
+  {
+    if (overflowPolicy == LOG_DROP_OLDEST)
+    {
+      LogRecord discarded;
+      if (dequeue(discarded))
+        statDropped.fetch_add(1, std::memory_order_relaxed);
+      cell = claimCell(pos);
+    }
+    else if (overflowPolicy == LOG_BLOCK && xTaskGetCurrentTaskHandle() != logTaskHandle)
+    {
+      statBlocked.fetch_add(1, std::memory_order_relaxed);
+      for (uint32_t waited = 0; !cell && waited < LOG_BLOCK_MAX_MS; waited++)
+      {
+        vTaskDelay(pdMS_TO_TICKS(1));
+        cell = claimCell(pos);
+      }
+    }
+    if (!cell)
+    {
+      statDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+  }
+
+  LogRecord &record = cell->record;
+  record.format = format;
+  record.monoUs = startUs;
+  va_list args;
+  va_start(args, format);
+  captureArgs(record, &args);
+  va_end(args);
+  if (record.truncated)
+    statTruncated.fetch_add(1, std::memory_order_relaxed);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+
+  // Bookkeeping
+  statEnqueued.fetch_add(1, std::memory_order_relaxed);
+  uint32_t queued = enqueuePos.load(std::memory_order_relaxed) - dequeuePos.load(std::memory_order_relaxed);
+  if (queued > statHighWater.load(std::memory_order_relaxed))
+    statHighWater.store(queued, std::memory_order_relaxed);
+  uint32_t elapsedUs = (uint32_t)(monoMicros() - startUs);
+  statCallerUsTotal.fetch_add(elapsedUs, std::memory_order_relaxed);
+  if (elapsedUs > statMaxCallerUs.load(std::memory_order_relaxed))
+    statMaxCallerUs.store(elapsedUs, std::memory_order_relaxed);
+}
+
+// ================== Drain task ==================
+
+template <typename T>
+static bool takeArg(const LogRecord &record, size_t &offset, T &value)
+{
+  if (offset + sizeof(value) > record.payloadLength)
+    return false;
+  memcpy(&value, record.payload + offset, sizeof(value));
+  offset += sizeof(value);
+  return true;
+}
+
+// Rebuild the printf spec with '*' replaced by the captured values
+static void buildSpecString(const LogSpec &spec, const LogRecord &record, size_t &offset, char *out, size_t size)
+{
+  size_t used = 0;
+  for (const char *p = spec.start; p < spec.end && used + 12 < size; p++)
+  {
+    if (*p == '*')
+    {
+      int64_t value = 0;
+      takeArg(record, offset, value);
+      used += snprintf(out + used, size - used, "%d", (int)value);
+    }
+    else
+    {
+      out[used++] = *p;
+    }
+  }
+  out[used] = '\0';
+}
+
+static size_t formatRecord(const LogRecord &record, char *out, size_t size)
+{
+  size_t used = 0;
+  size_t offset = 0;
+  const char *p = record.format;
+
+  while (*p && used + 1 < size)
+  {
+    if (*p != '%')
+    {
+      out[used++] = *p++;
+      continue;
+    }
+    if (p[1] == '%')
+    {
+      out[used++] = '%';
+      p += 2;
+      continue;
+    }
+
+    LogSpec spec;
+    const char *next = parseSpec(p, spec);
+    char specText[32];
+    buildSpecString(spec, record, offset, specText, sizeof(specText));
+    int written = 0;
+    bool ok = true;
+
+    if (isIntegerConversion(spec.conversion))
+    {
+      uint64_t value;
+      ok = takeArg(record, offset, value);
+      if (ok)
+      {
+        switch (spec.length)
+        {
+        case LEN_LONG: written = snprintf(out + used, size - used, specText, (long)value); break;
+        case LEN_LONG_LONG: written = snprintf(out + used, size - used, specText, (long long)value); break;
+        case LEN_SIZE: written = snprintf(out + used, size - used, specText, (size_t)value); break;
+        case LEN_PTRDIFF: written = snprintf(out + used, size - used, specText, (ptrdiff_t)value); break;
+        case LEN_INTMAX: written = snprintf(out + used, size - used, specText, (intmax_t)value); break;
+        default: written = snprintf(out + used, size - used, specText, (int)value); break;
+        }
+      }
+    }
+    else if (isFloatConversion(spec.conversion))
+    {
+      double value;
+      ok = takeArg(record, offset, value);
+      if (ok)
+      {
+        if (spec.length == LEN_LONG_DOUBLE)
+          written = snprintf(out + used, size - used, specText, (long double)value);
+        else
+          written = snprintf(out + used, size - used, specText, value);
+      }
+    }
+    else if (spec.conversion == 'p')
+    {
+      uint64_t value;
+      ok = takeArg(record, offset, value);
+      if (ok)
+        written = snprintf(out + used, size - used, specText, (void *)(uintptr_t)value);
+    }
+    else if (spec.conversion == 's')
+    {
+      ok = offset < record.payloadLength;
+      if (ok)
+      {
+        char text[256];
+        size_t length = record.payload[offset++];
+        if (offset + length > record.payloadLength)
+          length = record.payloadLength - offset;
+        memcpy(text, record.payload + offset, length);
+        text[length] = '\0';
+        offset += length;
+        written = snprintf(out + used, size - used, specText, text);
+      }
+    }
+
+    if (!ok)
+    {
+      // Arguments were truncated - show the rest of the format verbatim
+      written = snprintf(out + used, size - used, "%s", spec.start);
+      used += (written > 0) ? min((size_t)written, size - used - 1) : 0;
+      break;
+    }
+    if (written > 0)
+      used += min((size_t)written, size - used - 1);
+    p = next;
+  }
+  out[used] = '\0';
+  return used;
+}
+
+// ================== Binary frames ==================
+
+#if LOG_BINARY_MODE
+
+// Each frame is COBS-encoded and terminated by 0x00, so the decoder can resync on
+// any zero byte and pass stray text (boot ROM, panics) through. Decoded layout:
+//   [tag][body][crc8]
+//   tag < 64           record using format slot <tag>: zigzag ms since the previous
+//                      record or sync, then the arguments
+//   tag 64..127        same, but the arguments were truncated and may stop early
+//   LOG_FRAME_SYNC     'S' 'F' version, varint monoUs, u8 synced, zigzag wall offset (us),
+//                      zigzag local UTC offset (s), varint dropped. Clears the format table.
+//   LOG_FRAME_DEFINE   u8 slot, u32 format string address (little-endian)
+// Arguments follow the format string: '*' and %d/%i as zigzag varints, other integers
+// and %p as varints (already cut to the conversion's width), floating point as 8 raw
+// bytes, %s as u8 length + bytes. A typical record is 6-10 bytes on the wire.
+
+static_assert(LOG_FORMAT_CACHE_SLOTS <= 64, "Record tags carry the format slot in 6 bits");
+
+static const uint8_t LOG_FRAME_TRUNCATED = 0x40;
+static const uint8_t LOG_FRAME_SYNC = 0xF0;
+static const uint8_t LOG_FRAME_DEFINE = 0xF1;
+static const uint8_t LOG_FRAME_VERSION = 1;
+static const size_t LOG_FRAME_MAX = 256;
+
+static uint8_t frame[LOG_FRAME_MAX];
+static size_t frameLength = 0;
+static uint8_t encodedFrame[LOG_FRAME_MAX + LOG_FRAME_MAX / 254 + 3];
+
+// Format addresses the decoder currently knows, by slot
+static uint32_t formatTable[LOG_FORMAT_CACHE_SLOTS];
+static uint64_t lastFrameMs = 0; // Stamps only show milliseconds, so deltas are in ms
+static uint64_t lastSyncMs = 0;
+static bool syncSent = false;
+static bool lastSyncedState = false;
+
+static void frameByte(uint8_t value)
+{
+  if (frameLength < sizeof(frame))
+    frame[frameLength++] = value;
+}
+
+static void frameBytes(const void *data, size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+    frameByte(((const uint8_t *)data)[i]);
+}
+
+static void frameVarint(uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    frameByte((uint8_t)value | 0x80);
+    value >>= 7;
+  }
+  frameByte((uint8_t)value);
+}
+
+static void frameZigzag(int64_t value)
+{
+  frameVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+static uint8_t crc8(const uint8_t *data, size_t length)
+{
+  uint8_t crc = 0;
+  for (size_t i = 0; i < length; i++)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+static void sendFrame()
+{
+  frameByte(crc8(frame, frameLength));
+
+  // COBS: replace every zero with the distance to the next one
+  size_t out = 1;
+  size_t codeIndex = 0;
+  uint8_t code = 1;
+  for (size_t i = 0; i < frameLength; i++)
+  {
+    if (frame[i] == 0)
+    {
+      encodedFrame[codeIndex] = code;
+      code = 1;
+      codeIndex = out++;
+      continue;
+    }
+    encodedFrame[out++] = frame[i];
+    if (++code == 0xFF)
+    {
+      encodedFrame[codeIndex] = code;
+      code = 1;
+      codeIndex = out++;
+    }
+  }
+  encodedFrame[codeIndex] = code;
+  encodedFrame[out++] = 0;
+
+  logWriteOutput(encodedFrame, out);
+  frameLength = 0;
+}
+
+static void sendSyncFrame(uint64_t monoUs)
+{
+  int64_t wallOffsetUs = 0;
+  bool synced = monoToWallMicros(0, &wallOffsetUs);
+
+  static const uint8_t delimiter = 0;
+  logWriteOutput(&delimiter, 1); // Lets a decoder that joined mid-frame start clean
+  frameByte(LOG_FRAME_SYNC);
+  frameByte('S');
+  frameByte('F');
+  frameByte(LOG_FRAME_VERSION);
+  frameVarint(monoUs);
+  frameByte(synced ? 1 : 0);
+  frameZigzag(wallOffsetUs);
+  frameZigzag(synced ? localUtcOffsetSeconds((time_t)(((int64_t)monoUs + wallOffsetUs) / 1000000LL)) : 0);
+  frameVarint(statDropped.load(std::memory_order_relaxed));
+  sendFrame();
+
+  memset(formatTable, 0, sizeof(formatTable));
+  lastFrameMs = monoUs / 1000;
+  lastSyncMs = monoMillis();
+  lastSyncedState = synced;
+  syncSent = true;
+}
+
+static uint8_t integerBits(LogLength length)
+{
+  switch (length)
+  {
+  case LEN_CHAR: return 8;
+  case LEN_SHORT: return 16;
+  case LEN_LONG: return sizeof(long) * 8;
+  case LEN_LONG_LONG: return 64;
+  case LEN_SIZE: return sizeof(size_t) * 8;
+  case LEN_PTRDIFF: return sizeof(ptrdiff_t) * 8;
+  case LEN_INTMAX: return sizeof(intmax_t) * 8;
+  default: return sizeof(int) * 8;
+  }
+}
+
+static void encodeArgs(const LogRecord &record)
+{
+  size_t offset = 0;
+  for (const char *p = record.format; *p;)
+  {
+    if (*p != '%')
+    {
+      p++;
+      continue;
+    }
+    if (p[1] == '%')
+    {
+      p += 2;
+      continue;
+    }
+
+    LogSpec spec;
+    p = parseSpec(p, spec);
+
+    int64_t star;
+    if (spec.starWidth)
+    {
+      if (!takeArg(record, offset, star))
+        return;
+      frameZigzag(star);
+    }
+    if (spec.starPrecision)
+    {
+      if (!takeArg(record, offset, star))
+        return;
+      frameZigzag(star);
+    }
+
+    if (isIntegerConversion(spec.conversion))
+    {
+      uint64_t value;
+      if (!takeArg(record, offset, value))
+        return;
+      uint8_t shift = 64 - integerBits(spec.length);
+      if (spec.conversion == 'd' || spec.conversion == 'i')
+        frameZigzag((int64_t)(value << shift) >> shift);
+      else
+        frameVarint((value << shift) >> shift);
+    }
+    else if (isFloatConversion(spec.conversion))
+    {
+      double value;
+      if (!takeArg(record, offset, value))
+        return;
+      frameBytes(&value, sizeof(value));
+    }
+    else if (spec.conversion == 'p')
+    {
+      uint64_t value;
+      if (!takeArg(record, offset, value))
+        return;
+      frameVarint(value);
+    }
+    else if (spec.conversion == 's')
+    {
+      if (offset >= record.payloadLength)
+        return;
+      size_t length = record.payload[offset++];
+      if (offset + length > record.payloadLength)
+        length = record.payloadLength - offset;
+      frameByte((uint8_t)length);
+      frameBytes(record.payload + offset, length);
+      offset += length;
+    }
+  }
+}
+
+static void writeBinaryRecord(const LogRecord &record)
+{
+  if (!syncSent || timeServiceSynced() != lastSyncedState || monoMillis() - lastSyncMs >= LOG_SYNC_INTERVAL_MS)
+    sendSyncFrame(record.monoUs);
+
+  uint32_t address = (uint32_t)(uintptr_t)record.format;
+  uint8_t slot = (uint8_t)((address ^ (address >> 6) ^ (address >> 12)) & (LOG_FORMAT_CACHE_SLOTS - 1));
+  if (formatTable[slot] != address)
+  {
+    frameByte(LOG_FRAME_DEFINE);
+    frameByte(slot);
+    frameBytes(&address, sizeof(address)); // Xtensa is little-endian
+    sendFrame();
+    formatTable[slot] = address;
+  }
+
+  frameByte(record.truncated ? (slot | LOG_FRAME_TRUNCATED) : slot);
+  frameZigzag((int64_t)(record.monoUs / 1000 - lastFrameMs));
+  lastFrameMs = record.monoUs / 1000;
+  encodeArgs(record);
+  sendFrame();
+}
+
+#endif // LOG_BINARY_MODE
+
+static void logStatsIfDue()
+{
+  static uint64_t lastStatsMs = 0;
+  uint64_t now = monoMillis();
+  if (now - lastStatsMs < LOG_STATS_INTERVAL_MS)
+    return;
+  lastStatsMs = now;
+
+  LogStats stats;
+  getLogStats(stats);
+  writeLog("[LOG] Enqueued: %lu Dropped: %lu Blocked: %lu Truncated: %lu High water: %lu/%d Caller avg: %luns max: %luus Out: %lu B",
+    (unsigned long)stats.enqueued, (unsigned long)stats.dropped, (unsigned long)stats.blocked,
+    (unsigned long)stats.truncated, (unsigned long)stats.highWater, LOG_RING_SLOTS,
+    (unsigned long)stats.avgCallerNs, (unsigned long)stats.maxCallerUs, (unsigned long)stats.bytesOut);
+}
+
+void logWriteOutput(const uint8_t *data, size_t length)
+{
+  Serial.write(data, length);
+  flashLogAppend(data, length);
+  statBytesOut += length;
+}
+
+static void logTask(void *parameter)
+{
+  HeapTagScope heapTag(HEAP_TAG_LOGGING);
+  static LogRecord record;
+  static char line[320];
+  static char output[352];
+
+  for (;;)
+  {
+    serviceEarlyLogLines(); // Idle passes too, so the re-stamp does not wait for a new line
+
+    if (!dequeue(record))
+    {
+      logStatsIfDue();
+      flashLogIdle();
+      vTaskDelay(pdMS_TO_TICKS(LOG_IDLE_POLL_MS));
+      continue;
+    }
+
+#if LOG_BINARY_MODE
+    writeBinaryRecord(record);
+    continue;
+#endif
+
+    formatRecord(record, line, sizeof(line));
+
+    // Lines from before the first SNTP sync print now and again once it is known
+    if (!timeServiceSynced())
+      keepEarlyLogLine(record.monoUs, line);
+
+    // Format: YYMMDD.HH:MM:SS.zzz - log message
+    char stamp[24];
+    formatLogTimestamp(record.monoUs, stamp, sizeof(stamp));
+    int length = snprintf(output, sizeof(output), "%s - %s\r\n", stamp, line);
+    logWriteOutput((const uint8_t *)output, min((size_t)length, sizeof(output) - 1));
+  }
+}
+
+void logServiceBegin()
+{
+  if (logTaskHandle)
+    return;
+  xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK_SIZE, nullptr, LOG_TASK_PRIORITY, &logTaskHandle, LOG_TASK_CORE);
+}
+
+void logSetOverflowPolicy(LogOverflowPolicy policy)
+{
+  overflowPolicy = policy;
+}
+
+void logSetLevel(LogCategory category, uint8_t level)
+{
+  if (category >= LOG_CATEGORY_COUNT)
+    return;
+  logRuntimeLevel[category] = level;
+  writeLog("[LOG] %s level set to %u", LOG_CATEGORY_NAMES[category], (unsigned)level);
+}
+
+void logSetAllLevels(uint8_t level)
+{
+  for (int i = 0; i < LOG_CATEGORY_COUNT; i++)
+    logRuntimeLevel[i] = level;
+  writeLog("[LOG] All category levels set to %u", (unsigned)level);
+}
+
+const char *logCategoryName(LogCategory category)
+{
+  return (category < LOG_CATEGORY_COUNT) ? LOG_CATEGORY_NAMES[category] : "?";
+}
+
+void getLogStats(LogStats &stats)
+{
+  stats.enqueued = statEnqueued.load(std::memory_order_relaxed);
+  stats.dropped = statDropped.load(std::memory_order_relaxed);
+  stats.blocked = statBlocked.load(std::memory_order_relaxed);
+  stats.truncated = statTruncated.load(std::memory_order_relaxed);
+  stats.highWater = statHighWater.load(std::memory_order_relaxed);
+  stats.maxCallerUs = statMaxCallerUs.load(std::memory_order_relaxed);
+  uint64_t total = statCallerUsTotal.load(std::memory_order_relaxed);
+  stats.avgCallerNs = stats.enqueued ? (uint32_t)(total * 1000ULL / stats.enqueued) : 0;
+  stats.bytesOut = statBytesOut;
+}
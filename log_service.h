@@ -0,0 +1,138 @@
+#ifndef LOG_SERVICE_H
+#define LOG_SERVICE_H
+
+#include <Arduino.h>
+
+// Asynchronous logger.
+// writeLog() no longer formats or touches the UART on the caller's task. It scans
+// the format string, copies the arguments (deep-copying %s strings) and the
+// timestamp into a slot of a lock-free multi-producer ring (Vyukov bounded MPMC
+// queue) and returns in a few microseconds. A low-priority drain task formats the
+// records and writes them to Serial. When the ring is full the configured overflow
+// policy decides what gives, and every loss is counted.
+//
+// With LOG_BINARY_MODE=1 the drain task skips formatting entirely and writes
+// compact tokenized frames instead of text: the format string's flash address
+// (cached per slot, so usually one byte), a varint timestamp delta and the raw
+// arguments. tools/log_decode.py rebuilds the usual text lines from the capture
+// and the firmware ELF. See log_service.cpp for the frame layout.
+
+#define LOG_RING_SLOTS 64     // Must be a power of two
+#define LOG_PAYLOAD_SIZE 112  // Captured argument bytes per record
+#define LOG_BLOCK_MAX_MS 50   // LOG_BLOCK waits at most this long before dropping
+
+enum LogOverflowPolicy
+{
+  LOG_DROP_NEWEST, // Discard the record being written (cheapest for the caller)
+  LOG_DROP_OLDEST, // Discard the oldest queued record to make room
+  LOG_BLOCK        // Wait for the drain task (never use from time-critical code)
+};
+
+#ifndef LOG_BINARY_MODE
+#define LOG_BINARY_MODE 0
+#endif
+
+#define LOG_FORMAT_CACHE_SLOTS 64    // Format address slots shared with the decoder
+#define LOG_SYNC_INTERVAL_MS 30000   // Binary mode: resend time base and format table this often
+
+#ifndef LOG_OVERFLOW_POLICY
+#define LOG_OVERFLOW_POLICY LOG_DROP_NEWEST
+#endif
+
+// ================== Categories and levels ==================
+// Chatty diagnostics go through LOG_D(CATEGORY, ...) and friends instead of plain
+// writeLog(). A call below the category's compile-time minimum level is removed by
+// the compiler together with its format string; calls that stay compiled in are
+// also checked against a per-category runtime level. Plain writeLog() is never
+// filtered - keep it for errors and one-off lifecycle lines.
+//
+//   -DLOG_MIN_LEVEL=LOG_LEVEL_INFO          strip every DEBUG/VERBOSE call
+//   -DLOG_MIN_LEVEL_TIMER=LOG_LEVEL_NONE    strip one category entirely
+//   -DLOG_RUNTIME_LEVEL=LOG_LEVEL_INFO      compiled in but muted until logSetLevel()
+
+#define LOG_LEVEL_VERBOSE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO 2
+#define LOG_LEVEL_WARN 3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_NONE 5
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+#ifndef LOG_RUNTIME_LEVEL
+#define LOG_RUNTIME_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#ifndef LOG_MIN_LEVEL_CAMERA
+#define LOG_MIN_LEVEL_CAMERA LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_TIMER
+#define LOG_MIN_LEVEL_TIMER LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_WASTE
+#define LOG_MIN_LEVEL_WASTE LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_MEM
+#define LOG_MIN_LEVEL_MEM LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_NET
+#define LOG_MIN_LEVEL_NET LOG_MIN_LEVEL
+#endif
+#ifndef LOG_MIN_LEVEL_UI
+#define LOG_MIN_LEVEL_UI LOG_MIN_LEVEL
+#endif
+
+enum LogCategory : uint8_t
+{
+  LOG_CAT_CAMERA, // Capture scheduling and results
+  LOG_CAT_TIMER,  // Flush/workflow timers and state dumps
+  LOG_CAT_WASTE,  // Waste repo pump
+  LOG_CAT_MEM,    // Heap and pool reports
+  LOG_CAT_NET,    // HTTP, upload queue, telemetry
+  LOG_CAT_UI,     // Touch, settings screen, shapes
+  LOG_CATEGORY_COUNT
+};
+
+// Runtime level per category - read inline by every LOG_x() call
+extern uint8_t logRuntimeLevel[LOG_CATEGORY_COUNT];
+
+#define LOG_AT(category, level, format, ...)                                                   \
+  do                                                                                           \
+  {                                                                                            \
+    if ((level) >= LOG_MIN_LEVEL_##category && (level) >= logRuntimeLevel[LOG_CAT_##category]) \
+      writeLog(format, ##__VA_ARGS__);                                                         \
+  } while (0)
+
+#define LOG_V(category, format, ...) LOG_AT(category, LOG_LEVEL_VERBOSE, format, ##__VA_ARGS__)
+#define LOG_D(category, format, ...) LOG_AT(category, LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LOG_I(category, format, ...) LOG_AT(category, LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LOG_W(category, format, ...) LOG_AT(category, LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LOG_E(category, format, ...) LOG_AT(category, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+void logSetLevel(LogCategory category, uint8_t level);
+void logSetAllLevels(uint8_t level);
+const char *logCategoryName(LogCategory category);
+
+struct LogStats
+{
+  uint32_t enqueued;
+  uint32_t dropped;      // Records lost to overflow (either policy)
+  uint32_t blocked;      // Calls that had to wait under LOG_BLOCK
+  uint32_t truncated;    // Records whose arguments did not fit the payload
+  uint32_t highWater;    // Most records queued at once
+  uint32_t maxCallerUs;  // Slowest writeLog() call
+  uint32_t avgCallerNs;
+  uint32_t bytesOut;     // Bytes written to Serial (text or binary frames)
+};
+
+void writeLog(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+void logServiceBegin();  // Start the drain task - call first thing in setup()
+
+// Log task only: write finished output to Serial and the flash log (flash_log.h)
+void logWriteOutput(const uint8_t *data, size_t length);
+void logSetOverflowPolicy(LogOverflowPolicy policy);
+void getLogStats(LogStats &stats);
+
+#endif // LOG_SERVICE_H
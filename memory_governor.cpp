@@ -0,0 +1,199 @@
+#include "memory_governor.h"
+#include "log_service.h"
+#include "time_base.h"
+#include "network_task.h"
+#include "telemetry.h"
+
+extern bool wifiNeedsRecreation;
+
+// A level is entered when free heap falls freeDepth below the baseline or the
+// largest block drops below largestBlock
+struct MemoryWatermark
+{
+  uint32_t freeDepth;
+  uint32_t largestBlock;
+};
+
+static const MemoryWatermark WATERMARKS[MEM_PRESSURE_COUNT] = {
+  { 0, 0 },                     // NORMAL
+  { 24 * 1024, 48 * 1024 },     // ELEVATED
+  { 40 * 1024, 32 * 1024 },     // HIGH
+  { 56 * 1024, 20 * 1024 },     // CRITICAL
+};
+
+static const char *PRESSURE_NAMES[MEM_PRESSURE_COUNT] = { "normal", "elevated", "high", "critical" };
+static const char *ACTION_NAMES[MEM_ACTION_COUNT] = { "drop_connection", "quiet_log", "pause_telemetry",
+  "network_recycle" };
+
+static MemoryGovernorStats stats = { MEM_PRESSURE_NORMAL, 0, 0, {}, UINT32_MAX, UINT32_MAX, 0 };
+static uint32_t baselineCandidate = 0;
+static uint64_t lastSampleMs = 0;
+static uint64_t relaxCandidateSinceMs = 0; // 0 = not currently clear of the watermarks
+static uint64_t lastRecycleMs = 0;
+static bool logQuieted = false;
+static uint8_t savedLogLevels[LOG_CATEGORY_COUNT];
+
+// Highest level whose marks (raised by the margins) are undercut
+static MemoryPressure levelFor(uint32_t freeHeap, uint32_t largest, uint32_t freeMargin, uint32_t largestMargin)
+{
+  for (int level = MEM_PRESSURE_COUNT - 1; level > MEM_PRESSURE_NORMAL; level--)
+  {
+    uint32_t freeMark = stats.baselineFree > WATERMARKS[level].freeDepth ? stats.baselineFree - WATERMARKS[level].freeDepth : 0;
+    if (freeHeap < freeMark + freeMargin || largest < WATERMARKS[level].largestBlock + largestMargin)
+      return (MemoryPressure)level;
+  }
+  return MEM_PRESSURE_NORMAL;
+}
+
+static void takeAction(MemoryAction action)
+{
+  stats.actions[action]++;
+  LOG_W(MEM, "[MEM_GOV] Action: %s (#%lu)", ACTION_NAMES[action], (unsigned long)stats.actions[action]);
+}
+
+static void quietLog()
+{
+  if (logQuieted)
+    return;
+  memcpy(savedLogLevels, logRuntimeLevel, sizeof(savedLogLevels));
+  for (int i = 0; i < LOG_CATEGORY_COUNT; i++)
+  {
+    if (logRuntimeLevel[i] < LOG_LEVEL_WARN)
+      logSetLevel((LogCategory)i, LOG_LEVEL_WARN);
+  }
+  logQuieted = true;
+}
+
+static void restoreLog()
+{
+  if (!logQuieted)
+    return;
+  for (int i = 0; i < LOG_CATEGORY_COUNT; i++)
+    logSetLevel((LogCategory)i, savedLogLevels[i]);
+  logQuieted = false;
+}
+
+// Critical stays critical until the recycle has had a chance to help, so retry
+// only after the cooldown
+static void requestRecycle(uint64_t nowMs)
+{
+  if (wifiNeedsRecreation || (lastRecycleMs != 0 && nowMs - lastRecycleMs < MEM_GOV_RECYCLE_COOLDOWN_MS))
+    return;
+  lastRecycleMs = nowMs;
+  takeAction(MEM_ACTION_NETWORK_RECYCLE);
+  wifiNeedsRecreation = true; // Network task recycles once its queue drains
+}
+
+// Cheapest first: each level adds its own action on top of the ones below
+static void escalate(MemoryPressure to, uint64_t nowMs)
+{
+  for (int level = stats.level + 1; level <= to; level++)
+  {
+    switch (level)
+    {
+    case MEM_PRESSURE_ELEVATED:
+      takeAction(MEM_ACTION_DROP_CONNECTION);
+      requestConnectionDrop();
+      takeAction(MEM_ACTION_QUIET_LOG);
+      quietLog();
+      break;
+    case MEM_PRESSURE_HIGH:
+      takeAction(MEM_ACTION_PAUSE_TELEMETRY);
+      telemetrySetPaused(true);
+      break;
+    case MEM_PRESSURE_CRITICAL:
+      requestRecycle(nowMs);
+      break;
+    }
+  }
+  stats.level = to;
+  stats.escalations++;
+}
+
+static void relax(MemoryPressure to)
+{
+  if (to < MEM_PRESSURE_HIGH)
+    telemetrySetPaused(false);
+  if (to < MEM_PRESSURE_ELEVATED)
+    restoreLog();
+  stats.level = to;
+  stats.relaxations++;
+}
+
+void serviceMemoryGovernor()
+{
+  uint64_t nowMs = monoMillis();
+  if (lastSampleMs != 0 && nowMs - lastSampleMs < MEM_GOV_SAMPLE_MS)
+    return;
+  lastSampleMs = nowMs;
+
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t largest = ESP.getMaxAllocHeap();
+  if (freeHeap < stats.lowestFree)
+    stats.lowestFree = freeHeap;
+  if (largest < stats.lowestLargest)
+    stats.lowestLargest = largest;
+
+  if (stats.baselineFree == 0)
+  {
+    if (nowMs + MEM_GOV_BASELINE_WINDOW_MS >= MEM_GOV_BASELINE_MS && freeHeap > baselineCandidate)
+      baselineCandidate = freeHeap;
+    if (nowMs < MEM_GOV_BASELINE_MS)
+      return;
+    stats.baselineFree = baselineCandidate ? baselineCandidate : freeHeap;
+    LOG_I(MEM, "[MEM_GOV] Baseline free heap %lu - marks at %lu/%lu/%lu", (unsigned long)stats.baselineFree,
+      (unsigned long)(stats.baselineFree - WATERMARKS[MEM_PRESSURE_ELEVATED].freeDepth),
+      (unsigned long)(stats.baselineFree - WATERMARKS[MEM_PRESSURE_HIGH].freeDepth),
+      (unsigned long)(stats.baselineFree - WATERMARKS[MEM_PRESSURE_CRITICAL].freeDepth));
+  }
+
+  MemoryPressure pressure = levelFor(freeHeap, largest, 0, 0);
+  if (pressure > stats.level)
+  {
+    MemoryPressure from = stats.level;
+    escalate(pressure, nowMs);
+    relaxCandidateSinceMs = 0;
+    LOG_W(MEM, "[MEM_GOV] Pressure %s -> %s (Free: %lu Largest: %lu)", PRESSURE_NAMES[from], PRESSURE_NAMES[pressure],
+      (unsigned long)freeHeap, (unsigned long)largest);
+    return;
+  }
+
+  if (stats.level == MEM_PRESSURE_CRITICAL)
+    requestRecycle(nowMs);
+
+  // Ease off only once clear of the current level's marks by the margin, for a while
+  MemoryPressure relaxed = levelFor(freeHeap, largest, MEM_GOV_FREE_MARGIN, MEM_GOV_LARGEST_MARGIN);
+  if (relaxed >= stats.level)
+  {
+    relaxCandidateSinceMs = 0;
+    return;
+  }
+  if (relaxCandidateSinceMs == 0)
+  {
+    relaxCandidateSinceMs = nowMs;
+    return;
+  }
+  if (nowMs - relaxCandidateSinceMs < MEM_GOV_RELAX_MS)
+    return;
+
+  MemoryPressure from = stats.level;
+  relax(relaxed);
+  relaxCandidateSinceMs = 0;
+  LOG_I(MEM, "[MEM_GOV] Pressure %s -> %s (Free: %lu Largest: %lu)", PRESSURE_NAMES[from], PRESSURE_NAMES[relaxed],
+    (unsigned long)freeHeap, (unsigned long)largest);
+}
+
+void getMemoryGovernorStats(MemoryGovernorStats &out)
+{
+  out = stats;
+}
+
+const char *memoryPressureName(MemoryPressure level)
+{
+  return (level < MEM_PRESSURE_COUNT) ? PRESSURE_NAMES[level] : "?";
+}
+
+const char *memoryActionName(MemoryAction action)
+{
+  return (action < MEM_ACTION_COUNT) ? ACTION_NAMES[action] : "?";
+}
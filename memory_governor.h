@@ -0,0 +1,65 @@
+#ifndef MEMORY_GOVERNOR_H
+#define MEMORY_GOVERNOR_H
+
+#include <Arduino.h>
+
+// Tiered memory-pressure governor.
+// Free heap and the largest free block are sampled from loop() and mapped onto
+// graded pressure levels. Each level up takes the next, more expensive action:
+//   ELEVATED - close the idle keep-alive upload socket, quiet DEBUG logging
+//   HIGH     - pause telemetry batching (events keep queuing in the RAM ring)
+//   CRITICAL - recycle the network stack (at most once per cooldown)
+// Levels rise as soon as a watermark is crossed but only fall once both figures
+// have stayed above it plus a margin for MEM_GOV_RELAX_MS, so the governor does
+// not flap around a threshold. Reversible actions are undone on the way down.
+//
+// The free-heap marks are depths below a baseline rather than absolute figures, since
+// every task stack or static buffer a build adds moves the steady state. The baseline
+// is the highest free heap sampled in the MEM_GOV_BASELINE_WINDOW_MS leading up to
+// MEM_GOV_BASELINE_MS after boot, once the tasks, pools and WiFi stack hold their
+// share; until then the governor only records. The largest-block marks stay absolute:
+// they are the contiguous sizes the upload and TLS paths need.
+
+#define MEM_GOV_SAMPLE_MS 1000             // Heap sampling period
+#define MEM_GOV_RELAX_MS 10000             // Time above watermark + margin before easing off
+#define MEM_GOV_FREE_MARGIN 16384          // Hysteresis on free heap
+#define MEM_GOV_LARGEST_MARGIN 8192        // Hysteresis on the largest free block
+#define MEM_GOV_RECYCLE_COOLDOWN_MS 300000 // Minimum time between network recycles
+#define MEM_GOV_BASELINE_MS 60000          // Boot settled - baseline taken
+#define MEM_GOV_BASELINE_WINDOW_MS 15000   // Samples before MEM_GOV_BASELINE_MS that count toward it
+
+enum MemoryPressure : uint8_t
+{
+  MEM_PRESSURE_NORMAL,
+  MEM_PRESSURE_ELEVATED,
+  MEM_PRESSURE_HIGH,
+  MEM_PRESSURE_CRITICAL,
+  MEM_PRESSURE_COUNT
+};
+
+enum MemoryAction : uint8_t
+{
+  MEM_ACTION_DROP_CONNECTION,
+  MEM_ACTION_QUIET_LOG,
+  MEM_ACTION_PAUSE_TELEMETRY,
+  MEM_ACTION_NETWORK_RECYCLE,
+  MEM_ACTION_COUNT
+};
+
+struct MemoryGovernorStats
+{
+  MemoryPressure level;
+  uint32_t escalations;
+  uint32_t relaxations;
+  uint32_t actions[MEM_ACTION_COUNT]; // Times each action was taken since boot
+  uint32_t lowestFree;                // Lowest sampled free heap
+  uint32_t lowestLargest;             // Lowest sampled largest free block
+  uint32_t baselineFree;              // Settled free heap the marks hang off, 0 until taken
+};
+
+void serviceMemoryGovernor(); // Call every loop() pass - samples every MEM_GOV_SAMPLE_MS
+void getMemoryGovernorStats(MemoryGovernorStats &stats);
+const char *memoryPressureName(MemoryPressure level);
+const char *memoryActionName(MemoryAction action);
+
+#endif // MEMORY_GOVERNOR_H
@@ -0,0 +1,171 @@
+#include "memory_trend.h"
+#include "log_service.h"
+#include "time_base.h"
+#include <math.h>
+
+static const char *SERIES_NAMES[MEM_TREND_SERIES_COUNT] = { "free", "min_free", "largest" };
+static const bool SERIES_FLAGGABLE[MEM_TREND_SERIES_COUNT] = { true, false, true }; // min_free only ever steps down
+
+// Running least-squares state for y against x = cycle. Updated incrementally so
+// no sample has to be kept and the sums never lose precision to large offsets.
+struct RunningFit
+{
+  uint32_t n;
+  double meanX;
+  double meanY;
+  double sxx;
+  double sxy;
+  double syy;
+  bool flagged;
+};
+
+struct TrendSample
+{
+  int32_t cycle;
+  uint32_t uptimeSec;
+  uint32_t values[MEM_TREND_SERIES_COUNT];
+};
+
+static RunningFit fits[MEM_TREND_SERIES_COUNT];
+
+// History keeps every stride-th sample; when full, every other entry is dropped
+// and the stride doubles
+static TrendSample history[MEM_TREND_HISTORY];
+static uint16_t historyCount = 0;
+static uint32_t historyStride = 1;
+static uint32_t samplesTaken = 0;
+
+static void addPoint(RunningFit &fit, double x, double y)
+{
+  fit.n++;
+  double dx = x - fit.meanX;
+  fit.meanX += dx / fit.n;
+  double dy = y - fit.meanY;
+  fit.meanY += dy / fit.n;
+  fit.sxx += dx * (x - fit.meanX);
+  fit.sxy += dx * (y - fit.meanY);
+  fit.syy += dy * (y - fit.meanY);
+}
+
+static void evaluate(int series, const RunningFit &fit, MemoryTrendFit &out)
+{
+  out.samples = fit.n;
+  out.slope = 0;
+  out.slopeError = 0;
+  out.tValue = 0;
+  out.lossFlagged = false;
+  if (fit.n < 3 || fit.sxx <= 0)
+    return;
+
+  double slope = fit.sxy / fit.sxx;
+  double residual = fit.syy - slope * fit.sxy;
+  double error = sqrt(max(residual, 0.0) / (fit.n - 2) / fit.sxx);
+  out.slope = (float)slope;
+  out.slopeError = (float)error;
+  if (fit.n < MEM_TREND_MIN_SAMPLES)
+    return;
+
+  // A perfectly straight line has no residual; a floor on the error keeps t finite
+  out.tValue = (float)(slope / max(error, 1e-3));
+  out.lossFlagged = SERIES_FLAGGABLE[series] && out.tValue < -MEM_TREND_T_CRITICAL && -slope >= MEM_TREND_MIN_LOSS;
+}
+
+static void storeHistory(const TrendSample &sample)
+{
+  if (samplesTaken++ % historyStride != 0)
+    return;
+
+  if (historyCount == MEM_TREND_HISTORY)
+  {
+    for (uint16_t i = 0; i < MEM_TREND_HISTORY / 2; i++)
+      history[i] = history[i * 2];
+    historyCount = MEM_TREND_HISTORY / 2;
+    historyStride *= 2;
+    if ((samplesTaken - 1) % historyStride != 0)
+      return;
+  }
+  history[historyCount++] = sample;
+}
+
+void memoryTrendRecordCycle(int cycle)
+{
+  if (cycle <= MEM_TREND_WARMUP_CYCLES)
+    return;
+
+  TrendSample sample;
+  sample.cycle = cycle;
+  sample.uptimeSec = (uint32_t)(monoMillis() / 1000);
+  sample.values[MEM_TREND_FREE] = ESP.getFreeHeap();
+  sample.values[MEM_TREND_MIN_FREE] = ESP.getMinFreeHeap();
+  sample.values[MEM_TREND_LARGEST] = ESP.getMaxAllocHeap();
+  storeHistory(sample);
+
+  for (int i = 0; i < MEM_TREND_SERIES_COUNT; i++)
+  {
+    RunningFit &fit = fits[i];
+    addPoint(fit, cycle, sample.values[i]);
+
+    MemoryTrendFit result;
+    evaluate(i, fit, result);
+    if (result.lossFlagged != fit.flagged)
+    {
+      fit.flagged = result.lossFlagged;
+      if (result.lossFlagged)
+        LOG_W(MEM, "[MEM_TREND] %s heap falling %.1f bytes/cycle (t=%.1f over %lu cycles) - leak suspected",
+          SERIES_NAMES[i], result.slope, result.tValue, (unsigned long)result.samples);
+      else
+        LOG_I(MEM, "[MEM_TREND] %s heap trend no longer significant (%.1f bytes/cycle, t=%.1f)", SERIES_NAMES[i],
+          result.slope, result.tValue);
+    }
+  }
+}
+
+void getMemoryTrendFit(MemoryTrendSeries series, MemoryTrendFit &fit)
+{
+  if (series >= MEM_TREND_SERIES_COUNT)
+    series = MEM_TREND_FREE;
+  evaluate(series, fits[series], fit);
+}
+
+const char *memoryTrendSeriesName(MemoryTrendSeries series)
+{
+  return (series < MEM_TREND_SERIES_COUNT) ? SERIES_NAMES[series] : "?";
+}
+
+void logMemoryTrend()
+{
+  for (int i = 0; i < MEM_TREND_SERIES_COUNT; i++)
+  {
+    MemoryTrendFit fit;
+    evaluate(i, fits[i], fit);
+    LOG_I(MEM, "[MEM_TREND] %-8s %+.1f +/- %.1f bytes/cycle, t=%.1f, %lu cycles%s", SERIES_NAMES[i], fit.slope,
+      fit.slopeError, fit.tValue, (unsigned long)fit.samples, fit.lossFlagged ? " - LEAK SUSPECTED" : "");
+  }
+}
+
+// Each row goes out in one write so log lines from the log task can only land between rows
+void memoryTrendExportCsv(Print &out)
+{
+  char row[96];
+  snprintf(row, sizeof(row), "# memtrend: %u rows, one per %lu cycles\r\n", historyCount,
+    (unsigned long)historyStride);
+  out.print(row);
+  out.print("cycle,uptime_s,free_heap,min_free_heap,largest_block\r\n");
+  for (uint16_t i = 0; i < historyCount; i++)
+  {
+    const TrendSample &s = history[i];
+    snprintf(row, sizeof(row), "%ld,%lu,%lu,%lu,%lu\r\n", (long)s.cycle, (unsigned long)s.uptimeSec,
+      (unsigned long)s.values[MEM_TREND_FREE], (unsigned long)s.values[MEM_TREND_MIN_FREE],
+      (unsigned long)s.values[MEM_TREND_LARGEST]);
+    out.print(row);
+  }
+  for (int i = 0; i < MEM_TREND_SERIES_COUNT; i++)
+  {
+    MemoryTrendFit fit;
+    evaluate(i, fits[i], fit);
+    snprintf(row, sizeof(row), "# fit %s: slope=%.2f stderr=%.2f t=%.2f n=%lu flagged=%d\r\n", SERIES_NAMES[i],
+      fit.slope, fit.slopeError, fit.tValue, (unsigned long)fit.samples, fit.lossFlagged);
+    out.print(row);
+  }
+  out.print("# end memtrend\r\n");
+}
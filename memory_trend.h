@@ -0,0 +1,47 @@
+#ifndef MEMORY_TREND_H
+#define MEMORY_TREND_H
+
+#include <Arduino.h>
+
+// Long-horizon leak and fragmentation trend detector.
+// Free heap, minimum free heap and largest free block are sampled once per
+// completed workflow cycle. Each series feeds a running least-squares fit against
+// the cycle number (Welford-style, so it stays exact over a 30-day run), and a
+// one-sided t-test on the slope flags a loss per cycle that is statistically
+// significant rather than noise. Minimum free heap is a low-water mark that can
+// only fall, so one new low (a large TLS handshake) looks like a steady loss to
+// the fit; its slope is reported but never flagged. Samples also go into a
+// fixed-size history that halves its resolution whenever it fills, so it always
+// spans the whole run.
+// Type "memtrend" on the serial monitor to dump the history as CSV.
+
+#define MEM_TREND_WARMUP_CYCLES 3    // Boot-time allocations settle before sampling starts
+#define MEM_TREND_MIN_SAMPLES 20     // No verdict before this many cycles
+#define MEM_TREND_T_CRITICAL 3.0     // One-sided, roughly p < 0.005 at MIN_SAMPLES
+#define MEM_TREND_MIN_LOSS 4.0       // Bytes per cycle below which a trend is ignored
+#define MEM_TREND_HISTORY 128        // Downsampled history entries kept in RAM
+
+enum MemoryTrendSeries : uint8_t
+{
+  MEM_TREND_FREE,
+  MEM_TREND_MIN_FREE,
+  MEM_TREND_LARGEST,
+  MEM_TREND_SERIES_COUNT
+};
+
+struct MemoryTrendFit
+{
+  uint32_t samples;
+  float slope;      // Bytes per cycle (negative = losing memory)
+  float slopeError; // Standard error of the slope
+  float tValue;     // slope / slopeError, 0 until there are enough samples
+  bool lossFlagged; // Significant loss of at least MEM_TREND_MIN_LOSS bytes per cycle (never for min_free)
+};
+
+void memoryTrendRecordCycle(int cycle); // Call once per completed workflow cycle
+void getMemoryTrendFit(MemoryTrendSeries series, MemoryTrendFit &fit);
+const char *memoryTrendSeriesName(MemoryTrendSeries series);
+void logMemoryTrend();                  // One LOG_I(MEM) line per series
+void memoryTrendExportCsv(Print &out);  // History as CSV, oldest first
+
+#endif // MEMORY_TREND_H
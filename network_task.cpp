@@ -0,0 +1,866 @@
+#include "network_task.h"
+#include "draw_functions.h" // For writeLog
+#include "upload_queue.h"
+#include "block_pool.h"
+#include "json_stream.h"
+#include "telemetry.h"
+#include "heap_tags.h"
+#include "settings_sync.h"
+#include "usage_stats.h"
+#include <new>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+extern const char *uploadServerURL;
+extern const char *ssid;
+extern const char *password;
+extern bool wifiNeedsRecreation;
+
+// Network task configuration
+static const uint32_t NETWORK_TASK_STACK_SIZE = 6144;
+static const UBaseType_t NETWORK_TASK_PRIORITY = 1;
+static const BaseType_t NETWORK_TASK_CORE = 0; // Arduino loop() runs on core 1
+static const uint16_t CAMERA_HTTP_TIMEOUT_MS = 3000;
+static const int32_t UPLOAD_CONNECT_TIMEOUT_MS = 2000;
+static const uint32_t NET_STATS_LOG_EVERY_N_REQUESTS = 50;
+static const uint32_t BATCH_ROUTE_RETRY_MS = 3600000; // Re-probe /queue_cameras hourly after a fallback
+
+// Durable queue retry policy
+static const uint32_t UPLOAD_RETRY_BASE_MS = 2000;
+static const uint32_t UPLOAD_RETRY_MAX_MS = 300000;  // Cap backoff at 5 minutes
+static const int UPLOAD_DRAIN_BATCH = 8;             // Records sent per drain pass
+
+static QueueHandle_t cameraRequestQueue = nullptr;
+static QueueHandle_t cameraResultQueue = nullptr;
+static TaskHandle_t networkTaskHandle = nullptr;
+static CameraCompletionCallback cameraCompletionCallback = nullptr;
+static volatile uint32_t droppedCameraRequests = 0;
+static volatile bool connectionDropRequested = false;
+
+// ================== Connection manager ==================
+// One long-lived keep-alive connection to the upload server. The client objects
+// and the request/response buffers are carved out of the boot-time block pools
+// and only touched by the network task, so a request never grows the heap.
+static WiFiClient *uploadClient = nullptr;
+static HTTPClient *uploadHttp = nullptr;
+static char queueCameraURL[256];  // Built once from uploadServerURL: http://host:port/queue_camera
+static char queueCamerasURL[256]; // Batch route: http://host:port/queue_cameras
+static char telemetryURL[256];    // Event batches: http://host:port/telemetry
+static char settingsURL[256];     // Settings document: http://host:port/settings?device=<id>
+static char responseETag[SETTINGS_SYNC_ETAG_SIZE]; // ETag header of the last settings response
+static char *requestBuffer = nullptr;
+static char *responseBuffer = nullptr;
+static UploadRecord *drainRecord = nullptr; // Scratch for drainUploadQueue, kept off the task stack
+static const size_t REQUEST_BUFFER_SIZE = NET_BUFFER_BLOCK_SIZE;
+static const size_t RESPONSE_BUFFER_SIZE = NET_BUFFER_BLOCK_SIZE;
+
+static_assert(sizeof(UploadRecord) <= NET_BUFFER_BLOCK_SIZE, "UploadRecord does not fit a pool block");
+
+// Connection statistics (network task writes, others read)
+static uint32_t netRequestCount = 0;
+static uint32_t netReusedCount = 0;
+static uint32_t netReconnectCount = 0;
+static uint32_t netRecycleCount = 0;
+static uint32_t netBatchedCaptures = 0;
+static uint32_t netFallbackCaptures = 0;
+
+// Durable queue backoff state (RAM only - a reboot retries immediately)
+static uint32_t uploadBackoffMs = 0;
+static uint64_t nextUploadAttemptAtMs = 0;
+static uint32_t requestKeyCounter = 0;
+
+// Batch route detection - assume supported until the server says otherwise
+static bool batchRouteSupported = true;
+static uint64_t batchRouteCheckedAtMs = 0;
+
+// Replace the last path segment of uploadServerURL with the given route
+static void buildServerURL(char *url, size_t urlSize, const char *route)
+{
+  snprintf(url, urlSize, "%s", uploadServerURL);
+  char *lastSlash = strrchr(url, '/');
+  if (lastSlash && (size_t)(lastSlash + 1 - url) + strlen(route) < urlSize)
+  {
+    strcpy(lastSlash + 1, route);
+  }
+}
+
+// Construct the client objects in their pool blocks
+static void createUploadClients(void *clientBlock, void *httpBlock)
+{
+  uploadClient = new (clientBlock) WiFiClient();
+  uploadHttp = new (httpBlock) HTTPClient();
+  uploadHttp->setReuse(true); // Keep the TCP connection open between requests
+  uploadHttp->setTimeout(CAMERA_HTTP_TIMEOUT_MS);
+  uploadHttp->setConnectTimeout(UPLOAD_CONNECT_TIMEOUT_MS);
+  static const char *collected[] = { "ETag" };
+  uploadHttp->collectHeaders(collected, 1);
+}
+
+static bool initConnectionManager()
+{
+  buildServerURL(queueCameraURL, sizeof(queueCameraURL), "queue_camera");
+  buildServerURL(queueCamerasURL, sizeof(queueCamerasURL), "queue_cameras");
+  buildServerURL(telemetryURL, sizeof(telemetryURL), "telemetry");
+  buildServerURL(settingsURL, sizeof(settingsURL), "settings");
+  size_t used = strlen(settingsURL);
+  snprintf(settingsURL + used, sizeof(settingsURL) - used, "?device=%06lx",
+    (unsigned long)(ESP.getEfuseMac() & 0xFFFFFF));
+
+  void *clientBlock = netClientPool.alloc();
+  void *httpBlock = netClientPool.alloc();
+  requestBuffer = (char *)netBufferPool.alloc();
+  responseBuffer = (char *)netBufferPool.alloc();
+  drainRecord = (UploadRecord *)netBufferPool.alloc();
+  if (!clientBlock || !httpBlock || !requestBuffer || !responseBuffer || !drainRecord)
+  {
+    writeLog("[NET] Memory pools too small for the connection manager");
+    return false;
+  }
+
+  createUploadClients(clientBlock, httpBlock);
+  responseBuffer[0] = '\0';
+  return true;
+}
+
+// Read the whole body so the keep-alive connection stays usable for the next
+// request. Anything beyond the response buffer is discarded.
+static int readResponseBody()
+{
+  responseBuffer[0] = '\0';
+  int len = uploadHttp->getSize();
+  if (len <= 0)
+    return 0;
+
+  WiFiClient &stream = uploadHttp->getStream();
+  int stored = 0;
+  int remaining = len;
+  while (remaining > 0)
+  {
+    uint8_t scratch[64];
+    int chunk = min(remaining, (int)sizeof(scratch));
+    int got = stream.readBytes(scratch, chunk);
+    if (got <= 0)
+      break;
+    int copy = min(got, (int)RESPONSE_BUFFER_SIZE - 1 - stored);
+    if (copy > 0)
+    {
+      memcpy(responseBuffer + stored, scratch, copy);
+      stored += copy;
+    }
+    remaining -= got;
+  }
+  responseBuffer[stored] = '\0';
+  return stored;
+}
+
+// Send a request over the shared connection, with an optional JSON body and one
+// optional extra header (Idempotency-Key, If-Match, ...). HTTPClient hands headers
+// back as a String, so only the settings sync asks for the ETag (readETag) and the
+// upload paths stay allocation-free.
+static int sendJSON(const char *method, const char *url, const char *body, size_t length, const char *headerName,
+  const char *headerValue, bool readETag)
+{
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    writeLog("[NET] WiFi not connected!");
+    return -1;
+  }
+
+  bool reused = uploadClient->connected();
+  if (!uploadHttp->begin(*uploadClient, url))
+  {
+    writeLog("[NET] Failed to begin request to %s", url);
+    return -1;
+  }
+  if (body)
+  {
+    uploadHttp->addHeader("Content-Type", "application/json");
+  }
+  if (headerValue && headerValue[0])
+  {
+    uploadHttp->addHeader(headerName, headerValue);
+  }
+
+  int httpCode = uploadHttp->sendRequest(method, (uint8_t *)body, body ? length : 0);
+  if (httpCode > 0)
+  {
+    readResponseBody();
+    responseETag[0] = '\0';
+    if (readETag && uploadHttp->hasHeader("ETag"))
+      snprintf(responseETag, sizeof(responseETag), "%s", uploadHttp->header("ETag").c_str());
+  }
+  else
+  {
+    responseBuffer[0] = '\0';
+    responseETag[0] = '\0';
+  }
+  // With setReuse(true) end() keeps the socket open if the server allowed keep-alive
+  uploadHttp->end();
+
+  netRequestCount++;
+  if (reused)
+    netReusedCount++;
+  else
+    netReconnectCount++;
+
+  if (netRequestCount % NET_STATS_LOG_EVERY_N_REQUESTS == 0)
+  {
+    LOG_I(NET, "[NET] Requests: %lu Reused: %lu Connects: %lu Free: %d Largest: %d",
+      (unsigned long)netRequestCount, (unsigned long)netReusedCount, (unsigned long)netReconnectCount,
+      ESP.getFreeHeap(), ESP.getMaxAllocHeap());
+    logMemoryPools();
+  }
+  return httpCode;
+}
+
+// POST a JSON body over the shared connection
+static int postJSON(const char *url, const char *body, size_t length, const char *idempotencyKey)
+{
+  return sendJSON("POST", url, body, length, "Idempotency-Key", idempotencyKey, false);
+}
+
+static inline bool isAccepted(int httpCode)
+{
+  return httpCode >= 200 && httpCode < 300;
+}
+
+// Connection errors, 5xx and 429 are worth retrying; other 4xx never will succeed
+static inline bool isRetryable(int httpCode)
+{
+  return httpCode <= 0 || httpCode >= 500 || httpCode == 429;
+}
+
+// Unique per device, boot and request: <chip>-<boot>-<counter>
+static void assignRequestKey(CameraRequest &request)
+{
+  if (request.requestKey[0])
+    return;
+  snprintf(request.requestKey, sizeof(request.requestKey), "%06lx-%lu-%lu",
+    (unsigned long)(ESP.getEfuseMac() & 0xFFFFFF), (unsigned long)uploadQueueBootCount(),
+    (unsigned long)++requestKeyCounter);
+}
+
+static void writeCameraFields(JsonWriter &json, const CameraTarget &camera)
+{
+  json.field(JKEY("camera_id"), camera.cameraID);
+  json.field(JKEY("image_prefix"), camera.imagePrefix);
+  json.field(JKEY("flip_vertical"), camera.flipVertical);
+}
+
+// Servers that report per-camera results answer {"accepted":N,...}; returns -1 when absent.
+// Parses responseBuffer in place, so call it after logging the raw body.
+static int parseAcceptedCount()
+{
+  JsonReader reader(responseBuffer, strlen(responseBuffer));
+  if (!reader.findKey("accepted") || reader.next() != JSON_NUMBER)
+    return -1;
+  return (int)reader.asLong();
+}
+
+// Per-camera fallback: one POST to /queue_camera per camera
+static int postSingleCamera(const CameraRequest &request, int index)
+{
+  const CameraTarget &camera = request.cameras[index];
+  LOG_D(NET, "[QUEUE] Camera: %s, URL: %s", camera.cameraID, queueCameraURL);
+
+  char cameraKey[sizeof(request.requestKey) + 4];
+  snprintf(cameraKey, sizeof(cameraKey), "%s-%d", request.requestKey, index);
+
+  FixedBufferPrint body(requestBuffer, REQUEST_BUFFER_SIZE);
+  JsonWriter json(body);
+  json.beginObject();
+  json.field(JKEY("request_id"), cameraKey);
+  writeCameraFields(json, camera);
+  json.endObject();
+
+  int httpResponseCode = postJSON(queueCameraURL, requestBuffer, body.length(), cameraKey);
+  LOG_D(NET, "[QUEUE] Response code: %d", httpResponseCode);
+  if (httpResponseCode <= 0)
+  {
+    writeLog("[QUEUE] Failed: %d", httpResponseCode);
+  }
+  LOG_D(NET, "[QUEUE] Response: %s", responseBuffer);
+  return httpResponseCode;
+}
+
+// Batched POST of every camera for the station to /queue_cameras:
+// {"request_id":..,"station":"LFT","cameras":[{"camera_id":..,"image_prefix":..,"flip_vertical":..},..]}
+static int postCameraBatch(const CameraRequest &request)
+{
+  const char *station = (request.location == Left) ? "LFT" : "RGT";
+  LOG_D(NET, "[QUEUE] Batch: %s x%d, URL: %s", station, request.cameraCount, queueCamerasURL);
+
+  FixedBufferPrint body(requestBuffer, REQUEST_BUFFER_SIZE);
+  JsonWriter json(body);
+  json.beginObject();
+  json.field(JKEY("request_id"), request.requestKey);
+  json.field(JKEY("station"), station);
+  json.beginArray(JKEY("cameras"));
+  for (int i = 0; i < request.cameraCount; i++)
+  {
+    json.beginObject();
+    writeCameraFields(json, request.cameras[i]);
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+
+  if (body.overflow())
+  {
+    writeLog("[QUEUE] Batch payload too large (%u bytes)", (unsigned)json.bytesWritten());
+    return -1;
+  }
+
+  int httpResponseCode = postJSON(queueCamerasURL, requestBuffer, body.length(), request.requestKey);
+  LOG_D(NET, "[QUEUE] Batch response code: %d", httpResponseCode);
+  LOG_D(NET, "[QUEUE] Response: %s", responseBuffer);
+  return httpResponseCode;
+}
+
+// Send one capture, batched when possible - only ever called on the network task.
+// Returns true when some camera was not accepted but a retry may still succeed.
+// Retries reuse the request key, so the server drops cameras it already queued.
+static bool postCameraRequest(const CameraRequest &request, CameraResult &result)
+{
+  uint32_t memBefore = ESP.getFreeHeap();
+  result.acceptedCount = 0;
+  result.roundTrips = 0;
+  result.httpCode = -1;
+
+  // Periodically re-probe the batch route in case the server was upgraded
+  if (!batchRouteSupported && monoMillis() - batchRouteCheckedAtMs > BATCH_ROUTE_RETRY_MS)
+  {
+    batchRouteSupported = true;
+  }
+
+  if (batchRouteSupported && request.cameraCount > 1)
+  {
+    int httpCode = postCameraBatch(request);
+    result.roundTrips++;
+    result.httpCode = httpCode;
+
+    if (httpCode == HTTP_CODE_NOT_FOUND || httpCode == HTTP_CODE_METHOD_NOT_ALLOWED)
+    {
+      // Server has no batch route - fall through to per-camera requests
+      writeLog("[QUEUE] Batch route unavailable (%d) - falling back to per-camera requests", httpCode);
+      batchRouteSupported = false;
+      batchRouteCheckedAtMs = monoMillis();
+    }
+    else
+    {
+      bool retry = isRetryable(httpCode);
+      if (isAccepted(httpCode))
+      {
+        // Trust the server's own count when it gives one, otherwise the status code.
+        // A short count means the server could not queue every camera yet - retry.
+        int accepted = parseAcceptedCount();
+        result.acceptedCount = (accepted >= 0 && accepted < request.cameraCount) ? accepted : request.cameraCount;
+        retry = result.acceptedCount < request.cameraCount;
+        if (retry)
+        {
+          writeLog("[QUEUE] Batch %s accepted %d of %d cameras", request.requestKey, result.acceptedCount,
+            request.cameraCount);
+        }
+      }
+      netBatchedCaptures++;
+      LOG_D(NET, "[QUEUE] Memory - Before: %d After: %d", memBefore, ESP.getFreeHeap());
+      return retry;
+    }
+  }
+
+  // Report the code that decides the outcome: the first retryable failure, else the
+  // first rejection, else the last success
+  bool anyRetryable = false;
+  bool anyRejected = false;
+  for (int i = 0; i < request.cameraCount; i++)
+  {
+    int httpCode = postSingleCamera(request, i);
+    result.roundTrips++;
+    if (isAccepted(httpCode))
+    {
+      result.acceptedCount++;
+      if (!anyRetryable && !anyRejected)
+        result.httpCode = httpCode;
+    }
+    else if (isRetryable(httpCode))
+    {
+      if (!anyRetryable)
+        result.httpCode = httpCode;
+      anyRetryable = true;
+    }
+    else
+    {
+      if (!anyRetryable && !anyRejected)
+        result.httpCode = httpCode;
+      anyRejected = true;
+    }
+  }
+  netFallbackCaptures++;
+  LOG_D(NET, "[QUEUE] Memory - Before: %d After: %d", memBefore, ESP.getFreeHeap());
+  return anyRetryable;
+}
+
+// Last-resort network recycle, requested by the low-memory check in loop().
+// Tears down the socket and re-associates WiFi - blocks the network task only.
+static void recycleNetworkStack()
+{
+  size_t beforeHeap = ESP.getFreeHeap();
+  writeLog("[WIFI_RESET] Starting network recycle - Free: %u", beforeHeap);
+
+  uploadHttp->end();
+  uploadClient->stop();
+
+  // Rebuild the clients in place - drops any strings HTTPClient accumulated
+  // without touching the heap for the objects themselves
+  void *clientBlock = uploadClient;
+  void *httpBlock = uploadHttp;
+  uploadHttp->~HTTPClient();
+  uploadClient->~WiFiClient();
+  createUploadClients(clientBlock, httpBlock);
+
+  WiFi.disconnect(true);
+  vTaskDelay(pdMS_TO_TICKS(100));
+  writeLog("[WIFI_RESET] WiFi disconnected");
+
+  WiFi.begin(ssid, password);
+  int attempts = 0;
+  while (WiFi.status() != WL_CONNECTED && attempts < 20)
+  {
+    vTaskDelay(pdMS_TO_TICKS(500));
+    attempts++;
+  }
+
+  if (WiFi.status() == WL_CONNECTED)
+  {
+    writeLog("[WIFI_RESET] WiFi reconnected - IP: %s", WiFi.localIP().toString().c_str());
+  }
+  else
+  {
+    writeLog("[WIFI_RESET] WiFi reconnection failed");
+  }
+
+  netRecycleCount++;
+  wifiNeedsRecreation = false;
+  size_t afterHeap = ESP.getFreeHeap();
+  writeLog("[WIFI_RESET] Completed - Free: %u (recovered: %d bytes)", afterHeap, (int)(afterHeap - beforeHeap));
+}
+
+// Memory governor's cheapest step: the next request simply reconnects
+static void dropIdleConnection()
+{
+  connectionDropRequested = false;
+  if (!uploadClient->connected())
+    return;
+  uploadHttp->end();
+  uploadClient->stop();
+  LOG_I(NET, "[NET] Keep-alive connection closed to free memory - Free: %d", ESP.getFreeHeap());
+}
+
+static void postCameraResult(const CameraResult &result)
+{
+  if (xQueueSend(cameraResultQueue, &result, 0) != pdTRUE)
+  {
+    writeLog("[NET] Result queue full - completion for capture #%lu dropped", (unsigned long)result.captureId);
+  }
+}
+
+// Store a capture for retry - false when it could not be stored and is lost
+static bool deferCapture(const CameraRequest &request)
+{
+  UploadRecord *record = (UploadRecord *)netBufferPool.alloc();
+  if (!record)
+  {
+    writeLog("[UPLOADQ] No buffer to store capture #%lu - dropped", (unsigned long)request.captureId);
+    return false;
+  }
+  memset(record, 0, sizeof(UploadRecord));
+  record->type = UPLOAD_CAPTURE;
+  record->capture = request;
+  bool stored = uploadQueuePush(*record);
+  if (stored)
+  {
+    writeLog("[UPLOADQ] Capture #%lu (%s) stored for retry - %d pending",
+      (unsigned long)request.captureId, request.requestKey, uploadQueuePending());
+  }
+  else
+  {
+    writeLog("[UPLOADQ] Could not store capture #%lu - dropped", (unsigned long)request.captureId);
+  }
+  netBufferPool.release(record);
+  return stored;
+}
+
+// Handle a fresh capture from the main loop. While older uploads are still
+// waiting on flash the new one is appended behind them to keep FIFO order.
+static void handleCameraRequest(CameraRequest &request)
+{
+  assignRequestKey(request);
+
+  CameraResult result;
+  result.location = request.location;
+  result.captureId = request.captureId;
+  result.cameraCount = request.cameraCount;
+  result.deferred = false;
+  result.dropped = false;
+
+  if (uploadQueuePending() > 0)
+  {
+    result.acceptedCount = 0;
+    result.roundTrips = 0;
+    result.httpCode = 0;
+    result.deferred = true;
+  }
+  else
+  {
+    result.deferred = postCameraRequest(request, result);
+  }
+
+  if (result.deferred && !deferCapture(request))
+  {
+    result.deferred = false;
+    result.dropped = true;
+  }
+  result.latencyMs = (uint32_t)(monoMillis() - request.queuedAtMs);
+  postCameraResult(result);
+}
+
+// Send up to UPLOAD_DRAIN_BATCH stored records, with exponential backoff on failure
+static void drainUploadQueue()
+{
+  if (uploadQueuePending() == 0 || WiFi.status() != WL_CONNECTED || monoMillis() < nextUploadAttemptAtMs)
+    return;
+
+  for (int sent = 0; sent < UPLOAD_DRAIN_BATCH; sent++)
+  {
+    // New captures from the main loop take priority over the backlog
+    if (uxQueueMessagesWaiting(cameraRequestQueue) > 0)
+      return;
+
+    UploadRecord &record = *drainRecord;
+    if (!uploadQueuePeek(record))
+      return;
+
+    int httpCode = -1;
+    bool delivered = false;
+    bool retry = false;
+
+    if (record.type == UPLOAD_TELEMETRY)
+    {
+      httpCode = postJSON(telemetryURL, record.telemetry.body, record.telemetry.length, nullptr);
+      delivered = isAccepted(httpCode);
+      retry = !delivered && isRetryable(httpCode);
+    }
+    else if (record.type == UPLOAD_CAPTURE)
+    {
+      CameraResult result;
+      result.location = record.capture.location;
+      result.captureId = record.capture.captureId;
+      result.cameraCount = record.capture.cameraCount;
+      retry = postCameraRequest(record.capture, result);
+      httpCode = result.httpCode;
+      delivered = result.acceptedCount == result.cameraCount;
+      if (!retry)
+      {
+        // Accepted or finally rejected - either way the side stops showing pending
+        result.deferred = false;
+        result.dropped = false;
+        result.latencyMs = 0;
+        postCameraResult(result);
+      }
+    }
+    else
+    {
+      writeLog("[UPLOADQ] Unknown record type %d - discarding", record.type);
+      uploadQueuePop();
+      continue;
+    }
+
+    if (!retry)
+    {
+      if (!delivered)
+      {
+        writeLog("[UPLOADQ] Record #%lu rejected (%d) - discarding", (unsigned long)record.seq, httpCode);
+      }
+      uploadQueuePop();
+      uploadBackoffMs = 0;
+      continue;
+    }
+
+    // Still failing - back off exponentially with jitter and stop this pass
+    record.attempts = (record.attempts < 255) ? record.attempts + 1 : 255;
+    uploadQueueUpdateHead(record);
+    uploadBackoffMs = (uploadBackoffMs == 0) ? UPLOAD_RETRY_BASE_MS : min(uploadBackoffMs * 2, UPLOAD_RETRY_MAX_MS);
+    uint32_t jitter = esp_random() % (uploadBackoffMs / 4 + 1);
+    nextUploadAttemptAtMs = monoMillis() + uploadBackoffMs + jitter;
+    writeLog("[UPLOADQ] Retry failed (%d) - %d pending, next attempt in %lums",
+      httpCode, uploadQueuePending(), (unsigned long)(uploadBackoffMs + jitter));
+    return;
+  }
+}
+
+// Spill the oldest events to the durable queue in UPLOAD_BODY_MAX chunks so a long
+// outage does not overflow the RAM ring
+static void spillTelemetry()
+{
+  UploadRecord *record = (UploadRecord *)netBufferPool.alloc();
+  if (!record)
+    return;
+
+  TelemetryStats stats;
+  getTelemetryStats(stats);
+  while (stats.pending >= TELEMETRY_RING_CAPACITY / 2)
+  {
+    memset(record, 0, sizeof(UploadRecord));
+    record->type = UPLOAD_TELEMETRY;
+    size_t length = 0;
+    uint32_t lastSeq = 0;
+    int count = telemetryBuildBatch(record->telemetry.body, sizeof(record->telemetry.body),
+      TELEMETRY_BATCH_EVENTS, &length, &lastSeq);
+    record->telemetry.length = (uint16_t)length;
+    if (count == 0 || !uploadQueuePush(*record))
+      break;
+    telemetryCommit(lastSeq, 0);
+    writeLog("[TELEMETRY] %d events spilled to the upload queue", count);
+    getTelemetryStats(stats);
+  }
+  netBufferPool.release(record);
+}
+
+// Ship pending events as one batch once TELEMETRY_BATCH_EVENTS accumulate or the
+// flush interval passes. Shares the upload backoff so an outage is not hammered.
+static void sendTelemetry()
+{
+  if (!telemetryFlushDue() || WiFi.status() != WL_CONNECTED || monoMillis() < nextUploadAttemptAtMs)
+    return;
+
+  char *batch = (char *)telemetryPool.alloc();
+  if (!batch)
+    return;
+
+  uint64_t startUs = monoMicros();
+  size_t length = 0;
+  uint32_t lastSeq = 0;
+  int count = telemetryBuildBatch(batch, TELEMETRY_BATCH_BUFFER_SIZE, TELEMETRY_BATCH_EVENTS, &length, &lastSeq);
+  int httpCode = (count > 0) ? postJSON(telemetryURL, batch, length, nullptr) : 0;
+  uint32_t elapsedUs = (uint32_t)(monoMicros() - startUs);
+  telemetryPool.release(batch);
+
+  if (count == 0)
+    return;
+
+  if (isAccepted(httpCode) || !isRetryable(httpCode))
+  {
+    if (!isAccepted(httpCode))
+    {
+      writeLog("[TELEMETRY] Batch of %d events rejected (%d) - discarding", count, httpCode);
+    }
+    telemetryCommit(lastSeq, length);
+    LOG_I(NET, "[TELEMETRY] Sent %d events, %u bytes (%u B/event) in %luus (%lu us/event)", count,
+      (unsigned)length, (unsigned)(length / count), (unsigned long)elapsedUs, (unsigned long)(elapsedUs / count));
+    return;
+  }
+
+  telemetryBatchFailed();
+  TelemetryStats stats;
+  getTelemetryStats(stats);
+  writeLog("[TELEMETRY] Batch failed (%d) - %u events pending, %lu dropped", httpCode,
+    (unsigned)stats.pending, (unsigned long)stats.dropped);
+  spillTelemetry();
+}
+
+// A push answers with the merged document, like a pull
+static void pushSettings(const char *method, const char *conditionHeader, const char *condition, bool everything)
+{
+  size_t length = settingsSyncBuildPush(requestBuffer, REQUEST_BUFFER_SIZE, everything);
+  if (length == 0)
+    return;
+
+  int httpCode = sendJSON(method, settingsURL, requestBuffer, length, conditionHeader, condition, true);
+  if (isAccepted(httpCode))
+  {
+    settingsSyncPushed();
+    settingsSyncApplyDocument(responseBuffer, strlen(responseBuffer), responseETag);
+  }
+  else if (httpCode == HTTP_CODE_PRECONDITION_FAILED)
+  {
+    settingsSyncConflict();
+  }
+  else
+  {
+    settingsSyncFailed(httpCode);
+  }
+}
+
+// Pull the rig's settings document, or push local edits against the last one seen
+static void syncSettings()
+{
+  if (!settingsSyncDue() || WiFi.status() != WL_CONNECTED)
+    return;
+
+  if (settingsSyncHasLocalChanges() && settingsSyncETag()[0])
+  {
+    pushSettings("PATCH", "If-Match", settingsSyncETag(), false);
+    return;
+  }
+
+  int httpCode = sendJSON("GET", settingsURL, nullptr, 0, "If-None-Match", settingsSyncETag(), true);
+  if (httpCode == HTTP_CODE_OK)
+  {
+    settingsSyncApplyDocument(responseBuffer, strlen(responseBuffer), responseETag);
+  }
+  else if (httpCode == HTTP_CODE_NOT_MODIFIED)
+  {
+    settingsSyncNotModified();
+  }
+  else if (httpCode == HTTP_CODE_NOT_FOUND)
+  {
+    // First contact (or the document was deleted): this rig's values become the document
+    writeLog("[SETTINGS_SYNC] No document on the server yet - creating it");
+    pushSettings("PUT", "If-None-Match", "*", true);
+  }
+  else
+  {
+    settingsSyncFailed(httpCode);
+  }
+}
+
+static void networkTask(void *parameter)
+{
+  HeapTagScope heapTag(HEAP_TAG_NETWORK);
+  CameraRequest request;
+
+  uploadQueueBegin();
+  usageStatsLoadCheckpoint(); // After the mount uploadQueueBegin() did
+
+  for (;;)
+  {
+    // Wake at least every 250ms so retries and a requested recycle are not starved
+    if (xQueueReceive(cameraRequestQueue, &request, pdMS_TO_TICKS(250)) == pdTRUE)
+    {
+      handleCameraRequest(request);
+    }
+
+    drainUploadQueue();
+
+    if (uxQueueMessagesWaiting(cameraRequestQueue) == 0)
+    {
+      sendTelemetry();
+    }
+
+#if SETTINGS_SYNC_ENABLED
+    if (uxQueueMessagesWaiting(cameraRequestQueue) == 0)
+    {
+      syncSettings();
+    }
+#endif
+
+    if (uxQueueMessagesWaiting(cameraRequestQueue) == 0)
+    {
+      usageStatsWriteCheckpoint();
+    }
+
+    if (connectionDropRequested && uxQueueMessagesWaiting(cameraRequestQueue) == 0)
+    {
+      dropIdleConnection();
+    }
+
+    // Emergency recycle only once the request queue has drained
+    if (wifiNeedsRecreation && uxQueueMessagesWaiting(cameraRequestQueue) == 0)
+    {
+      recycleNetworkStack();
+    }
+  }
+}
+
+void startNetworkTask()
+{
+  if (networkTaskHandle)
+    return;
+
+  if (!initConnectionManager())
+    return;
+  cameraRequestQueue = xQueueCreate(CAMERA_REQUEST_QUEUE_DEPTH, sizeof(CameraRequest));
+  cameraResultQueue = xQueueCreate(CAMERA_RESULT_QUEUE_DEPTH, sizeof(CameraResult));
+
+  if (!cameraRequestQueue || !cameraResultQueue)
+  {
+    writeLog("[NET] Failed to create camera queues");
+    return;
+  }
+
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK_SIZE, nullptr,
+    NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+  writeLog("[NET] Network task started (queue depth %d)", CAMERA_REQUEST_QUEUE_DEPTH);
+}
+
+bool submitCameraRequest(const CameraRequest &request)
+{
+  if (!cameraRequestQueue)
+  {
+    droppedCameraRequests++;
+    return false;
+  }
+
+  if (xQueueSend(cameraRequestQueue, &request, 0) != pdTRUE)
+  {
+    droppedCameraRequests++;
+    writeLog("[NET] Camera queue full - capture #%lu dropped (total dropped: %lu)",
+      (unsigned long)request.captureId, (unsigned long)droppedCameraRequests);
+    return false;
+  }
+  return true;
+}
+
+void processNetworkResults()
+{
+  if (!cameraResultQueue)
+    return;
+
+  CameraResult result;
+  while (xQueueReceive(cameraResultQueue, &result, 0) == pdTRUE)
+  {
+    if (cameraCompletionCallback)
+    {
+      cameraCompletionCallback(result);
+    }
+  }
+}
+
+void setCameraCompletionCallback(CameraCompletionCallback callback)
+{
+  cameraCompletionCallback = callback;
+}
+
+int getPendingCameraRequests()
+{
+  return cameraRequestQueue ? (int)uxQueueMessagesWaiting(cameraRequestQueue) : 0;
+}
+
+uint32_t getDroppedCameraRequests()
+{
+  return droppedCameraRequests;
+}
+
+void getNetworkStats(NetworkStats &stats)
+{
+  stats.requests = netRequestCount;
+  stats.reused = netReusedCount;
+  stats.connects = netReconnectCount;
+  stats.recycles = netRecycleCount;
+  stats.batchedCaptures = netBatchedCaptures;
+  stats.fallbackCaptures = netFallbackCaptures;
+  stats.batchRouteSupported = batchRouteSupported;
+}
+
+int getPendingUploads()
+{
+  return uploadQueuePending() + getPendingCameraRequests();
+}
+
+void requestConnectionDrop()
+{
+  connectionDropRequested = true;
+}
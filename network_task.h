@@ -0,0 +1,84 @@
+#ifndef NETWORK_TASK_H
+#define NETWORK_TASK_H
+
+#include <Arduino.h>
+#include "global_vars.h"
+
+// Asynchronous camera request pipeline.
+// The main loop never talks HTTP directly: it posts CameraRequest messages onto a
+// bounded FreeRTOS queue and a dedicated network task performs the blocking POSTs.
+// Results travel back on a second queue and completion callbacks are run from
+// processNetworkResults() on the main loop, so UI/LCD code stays single-threaded.
+// Between requests the task also ships telemetry and syncs settings (settings_sync.h).
+
+#define CAMERA_REQUEST_QUEUE_DEPTH 8
+#define CAMERA_RESULT_QUEUE_DEPTH 8
+
+// Camera status per side, updated by completion callbacks
+enum CameraStatus
+{
+  CAMERA_IDLE,
+  CAMERA_PENDING,
+  CAMERA_OK,
+  CAMERA_ERROR
+};
+
+#define MAX_CAMERAS_PER_STATION 2
+
+struct CameraTarget
+{
+  char cameraID[16];
+  char imagePrefix[64];
+  bool flipVertical;
+};
+
+// One capture event for a station: all of its cameras travel in one message and,
+// when the server supports it, in one batched POST to /queue_cameras
+struct CameraRequest
+{
+  char requestKey[32];  // Idempotency key, assigned by the network task on first send
+  CameraTarget cameras[MAX_CAMERAS_PER_STATION];
+  uint8_t cameraCount;
+  Location location;
+  uint32_t captureId;
+  uint64_t queuedAtMs;  // monoMillis() when submitted
+};
+
+struct CameraResult
+{
+  Location location;
+  uint32_t captureId;
+  uint8_t cameraCount;
+  uint8_t acceptedCount; // Cameras the server accepted
+  int httpCode;          // Last HTTP status, or negative HTTPClient error
+  uint8_t roundTrips;    // POSTs needed (1 when batched)
+  bool deferred;         // Server unreachable - stored in the durable upload queue for retry
+  bool dropped;          // Worth retrying but could not be stored - the capture is lost
+  uint32_t latencyMs;    // Time from submit to completion
+};
+
+// Keep-alive connection statistics for the upload server
+struct NetworkStats
+{
+  uint32_t requests;
+  uint32_t reused;    // Requests sent over an already-open connection
+  uint32_t connects;  // Requests that needed a new TCP connection
+  uint32_t recycles;  // Emergency WiFi teardowns
+  uint32_t batchedCaptures;   // Captures sent as one /queue_cameras POST
+  uint32_t fallbackCaptures;  // Captures sent as per-camera /queue_camera POSTs
+  bool batchRouteSupported;
+};
+
+typedef void (*CameraCompletionCallback)(const CameraResult &result);
+
+void startNetworkTask();
+bool submitCameraRequest(const CameraRequest &request); // Non-blocking, false when the queue is full
+void processNetworkResults();                           // Call from loop() - runs completion callbacks
+void setCameraCompletionCallback(CameraCompletionCallback callback);
+int getPendingCameraRequests();
+uint32_t getDroppedCameraRequests();
+void getNetworkStats(NetworkStats &stats);
+int getPendingUploads(); // In-flight plus durably queued uploads (pending_uploads)
+void requestConnectionDrop(); // Close the idle keep-alive socket to release its buffers (memory governor)
+
+#endif // NETWORK_TASK_H
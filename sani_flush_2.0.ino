@@ -21,10 +21,23 @@
 #include <Wire.h>
 #include <LiquidCrystal_I2C.h>
 #include <WiFi.h>
-#include <HTTPClient.h>
 #include "global_vars.h"
 #include "draw_functions.h"
 #include "settings_system.h"
+#include "network_task.h"
+#include "block_pool.h"
+#include "status_server.h"
+#include "boot_sequence.h"
+#include "time_service.h"
+#include "log_service.h"
+#include "flash_log.h"
+#include "heap_tags.h"
+#include "memory_governor.h"
+#include "memory_trend.h"
+#include "lcd_display.h"
+#include "event_bus.h"
+#include "telemetry.h"
+#include "usage_stats.h"
 
 // Test function declarations
 void testWasteRepoTiming();
@@ -48,25 +61,20 @@ int leftFlushCount = 0;
 int rightFlushCount = 0;
 int imageCount = 0;
 int totalWasteML = 0;
-unsigned long workflowStartTime = 0;
+uint64_t workflowStartTime = 0;
 
-// WiFi/HTTP object management
-HTTPClient* httpClient = nullptr;
+// Emergency network recycle request (serviced by the network task)
 bool wifiNeedsRecreation = false;
-unsigned long lastRightCameraCapture = 0;
 
 // Memory analysis variables
 int completedWorkflowCycles = 0;
 bool firstAnalysisComplete = false;
-unsigned long lastMemoryAnalysis = 0;
+uint64_t lastMemoryAnalysis = 0;
 
-void displayLCD(String line1, String line2)
+// Hands the text to the LCD task (lcd_display.h) - only changed characters reach the panel
+void displayLCD(const char *line1, const char *line2)
 {
-  lcd.clear();
-  lcd.setCursor(0, 0);
-  lcd.print(line1);
-  lcd.setCursor(0, 1);
-  lcd.print(line2);
+  lcdSetLines(line1, line2);
 }
 
 void initializeLCDDisplay()
@@ -76,6 +84,7 @@ void initializeLCDDisplay()
   Wire.begin(SDA_PIN, SCL_PIN);
   lcd.init();
   lcd.backlight();
+  lcdBegin();
 
   displayLCD("SANI FLUSH 2.0", "LOADING...");
   
@@ -85,7 +94,7 @@ void initializeLCDDisplay()
 // CREATE SETTINGS INSTANCE
 SettingsSystem flushSettings(&tft);
 
-// Web server disabled for now due to library conflicts
+// Status endpoint (GET /status) - see status_server.h
 
 // Function prototypes
 void checkTouch(int16_t touchX, int16_t touchY);
@@ -95,83 +104,30 @@ void initializeLCDDisplay();
 void refreshLastPhoto(Location location);
 void checkPhotoRefreshTouch(int16_t touchX, int16_t touchY);
 void resetApplicationState();
-void recreateNetworkObjects();
+void subscribeDisplays();
 void checkMemoryAnalysisTrigger();
 void logMemoryObjects();
+void serviceSerialCommands();
 
 void setup()
 {
-  // ESP32-S3 specific initialization
-  delay(2000); // Longer delay for ESP32-S3
+  // writeLog() only queues records - the log task formats and prints them.
+  // Early lines print with uptime stamps and again retro-stamped once SNTP syncs.
+  timeServiceBegin();
+  logServiceBegin();
+  flashLogBegin(); // Mirror the log to LittleFS - mounts on its own task
+
+  bootStageBegin(BOOT_SERIAL);
   Serial.begin(115200);
-  while (!Serial && millis() < 5000)
+  while (!Serial && monoMillis() < BOOT_SERIAL_WAIT_MS)
   {
-    delay(10); // Wait for Serial or timeout after 5 seconds
+    delay(10); // Optionally wait for a serial monitor to attach
   }
-  Serial.flush();
   writeLog("=== SANI FLUSH 2.0 STARTING ===");
-  writeLog("ESP32-S3 Serial initialized successfully!");
-
-  // Initialize LCD display
-  initializeLCDDisplay();
-
-  displayLCD("ESP32-S3", "LOADING...");
-  delay(1000);
-
-  // Initialize WiFi
-  writeLog("Connecting to WiFi...");
-  WiFi.begin(ssid, password);
-  while (WiFi.status() != WL_CONNECTED)
-  {
-    delay(500);
-    Serial.print("."); // Keep this for visual progress indication
-  }
-
-  // WiFi connected
-  Serial.println();
-  writeLog("WiFi connected!");
-  writeLog("IP: %s", WiFi.localIP().toString().c_str());
-  
-  // Configure NTP for Pacific Time (handles PST/PDT automatically)
-  configTime(-8 * 3600, 3600, "pool.ntp.org", "time.nist.gov");
-  writeLog("NTP time sync initiated (Pacific Time)");
-  
-  // Wait for time to be set
-  time_t now = time(0);
-  int attempts = 0;
-  while (now < 1000000000 && attempts < 20) {
-    delay(500);
-    now = time(0);
-    attempts++;
-  }
-  
-  if (now > 1000000000) {
-    struct tm *timeinfo = localtime(&now);
-    writeLog("Time synchronized: %04d-%02d-%02d %02d:%02d:%02d", 
-      timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
-      timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-    writeLog("=== PROCESSOR FULLY LOADED - %04d-%02d-%02d %02d:%02d:%02d ===",
-      timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
-      timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec);
-  } else {
-    writeLog("Warning: Time sync failed, using system default");
-  }
-
-
-  displayLCD(WiFi.localIP().toString(), "LOADING...");
-  delay(1000);
-
-  // Initialize TFT display
-  writeLog("Initializing TFT display...");
-  tft.init();
-  tft.setRotation(0);
-  tft.setTouch(calData);
-  writeLog("TFT display initialized");
+  bootStageEnd(BOOT_SERIAL);
 
-  displayLCD("TFT DISPLAY", "LOADING...");
-  delay(1000);
-
-  // Initialize Relay PINs - ENSURE ALL RELAYS ARE OFF
+  // Relays before anything slow - the pump/toilet outputs must never float while the rest boots
+  bootStageBegin(BOOT_RELAYS);
   pinMode(RELAY_P1_PIN, OUTPUT);
   pinMode(RELAY_P2_PIN, OUTPUT);
   pinMode(RELAY_T1_PIN, OUTPUT);
@@ -181,69 +137,121 @@ void setup()
   digitalWrite(RELAY_T1_PIN, LOW);
   digitalWrite(RELAY_T2_PIN, LOW);
   writeLog("All relays initialized to OFF state");
-
-  // Double-check relay states
   writeLog("Relay states - P1:%d P2:%d T1:%d T2:%d", digitalRead(RELAY_P1_PIN), digitalRead(RELAY_P2_PIN), digitalRead(RELAY_T1_PIN), digitalRead(RELAY_T2_PIN));
+  bootStageEnd(BOOT_RELAYS);
 
-  // Initialize global time
-  _currentTime = millis();
-
-  // TFT loading
-  // Hardware test - cycle through colors (faster)
-  writeLog("Testing TFT hardware...");
-  tft.fillScreen(TFT_RED);
-  delay(200);
-  tft.fillScreen(TFT_GREEN);
-  delay(200);
-  tft.fillScreen(TFT_BLUE);
-  delay(200);
+  // Initialize LCD display
+  bootStageBegin(BOOT_LCD);
+  initializeLCDDisplay();
+  bootStageEnd(BOOT_LCD);
+
+  // Network buffers and clients come from fixed pools reserved once, before the heap fragments
+  initMemoryPools();
+
+  // WiFi associates in the background while the local hardware comes up
+  startBackgroundNetwork(ssid, password);
+
+  // Initialize TFT display
+  bootStageBegin(BOOT_TFT);
+  tft.init();
+  tft.setRotation(0);
+  tft.setTouch(calData);
   tft.fillScreen(TFT_WHITE);
-  writeLog("TFT hardware test complete");
+  bootStageEnd(BOOT_TFT);
 
-  
+  // Initialize global time
+  _currentTime = monoMillis();
 
   // INITIALIZE SETTINGS SYSTEM
-  flushSettings.begin();
+  bootStageBegin(BOOT_SETTINGS);
+  {
+    HeapTagScope heapTag(HEAP_TAG_SETTINGS);
+    flushSettings.begin();
+  }
+  bootStageEnd(BOOT_SETTINGS);
 
   // Reset application state to ensure clean initialization
   resetApplicationState();
 
-  drawMainDisplay();
-  writeLog("Main display drawn");
+  // Counter changes reach telemetry and the displays through the event bus
+  telemetrySubscribeEvents();
+  usageStatsBegin();
+  subscribeDisplays();
 
-  drawFlowDetails();
+  bootStageBegin(BOOT_FIRST_FRAME);
+  {
+    HeapTagScope heapTag(HEAP_TAG_UI);
+    drawMainDisplay();
+    drawFlowDetails();
+    updateLCDDisplay();
+  }
+  bootStageEnd(BOOT_FIRST_FRAME);
 
-  // 5. Ready state - show initial LCD
-  updateLCDDisplay();
+  bootStageBegin(BOOT_NETWORK_TASK);
+
+  // Camera requests are posted by a dedicated network task from here on
+  setCameraCompletionCallback(onCameraRequestComplete);
+  startNetworkTask();
+  bootStageEnd(BOOT_NETWORK_TASK);
 
-  writeLog("Setup complete - flow details displayed");
+  writeLog("Setup complete - WiFi and time sync continue in the background");
 }
 
 
 
 void loop()
 {
-  // Update global time at the start of each loop
-  _currentTime = millis();
-
-  // Emergency WiFi recreation when memory gets critically low
-  if (ESP.getFreeHeap() < 220000 && !wifiNeedsRecreation) { // Increased threshold to 220KB
-    writeLog("[MEM_EMERGENCY] LOW MEMORY WARNING - Forcing WiFi recreation (Free: %d bytes)", ESP.getFreeHeap());
-    lastRightCameraCapture = _currentTime - 6000; // Force immediate recreation
-    wifiNeedsRecreation = true;
+  // Update global time at the start of each loop (64-bit, never wraps)
+  _currentTime = monoMillis();
+
+  // Advance background WiFi/SNTP bring-up
+  serviceBoot();
+
+  // Graded response to low memory - WiFi recreation is only the last step
+  serviceMemoryGovernor();
+
+  // Loop latency tracking - worst case since the last debug line
+  static uint64_t lastLoopStartUs = 0;
+  static uint32_t maxLoopUs = 0;
+  uint64_t loopStartUs = monoMicros();
+  if (lastLoopStartUs > 0)
+  {
+    uint32_t loopUs = (uint32_t)(loopStartUs - lastLoopStartUs);
+    if (loopUs > maxLoopUs)
+    {
+      maxLoopUs = loopUs;
+    }
   }
+  lastLoopStartUs = loopStartUs;
 
   // Reduced debug output - every 60 seconds instead of 10
-  static unsigned long lastDebug = 0;
+  static uint64_t lastDebug = 0;
   if (_currentTime - lastDebug > 60000)
   {
-    writeLog("[DEBUG] Time: %lu Free: %d Min: %d", _currentTime, ESP.getFreeHeap(), ESP.getMinFreeHeap());
+    LOG_I(MEM, "[DEBUG] Time: %llu Free: %d Min: %d Largest: %d Loop max: %luus Pending uploads: %d",
+      _currentTime, ESP.getFreeHeap(), ESP.getMinFreeHeap(), ESP.getMaxAllocHeap(), (unsigned long)maxLoopUs,
+      getPendingUploads());
     lastDebug = _currentTime;
+    maxLoopUs = 0;
+  }
+
+  // Run completion callbacks for finished camera requests
+  processNetworkResults();
+
+  // Settings changed on the server go through the same path as a screen edit
+  flushSettings.applyRemoteSettings();
+
+  // While stopped, settings edits apply at once; a running workflow picks them up at
+  // its next cycle boundary (updateTimers)
+  if (!_flushFlowActive)
+  {
+    flushSettings.applyPendingSettings();
   }
 
   // HANDLE SETTINGS TOUCH FIRST
   if (flushSettings.isSettingsVisible())
   {
+    HeapTagScope heapTag(HEAP_TAG_SETTINGS);
     flushSettings.handleTouch();
     // After settings touch, check if we need to redraw main
     if (!flushSettings.isSettingsVisible())
@@ -255,10 +263,11 @@ void loop()
   else
   {
     // Only handle main touches when settings are not visible
+    HeapTagScope heapTag(HEAP_TAG_UI);
     uint16_t touchX, touchY;
     if (tft.getTouch(&touchX, &touchY))
     {
-      writeLog("Touch X = %d, Y = %d", touchX, touchY);
+      LOG_D(UI, "Touch X = %d, Y = %d", touchX, touchY);
       checkTouch(touchX, touchY);
     }
   }
@@ -266,40 +275,45 @@ void loop()
   // Update animations based on current state (but not when settings are visible)
   if (!flushSettings.isSettingsVisible())
   {
+    HeapTagScope heapTag(HEAP_TAG_UI);
     updateAnimations();
   }
 
-  // Recreate WiFi/HTTP objects after camera operations (reduced delay)
-  if (wifiNeedsRecreation && _currentTime - lastRightCameraCapture > 2000)
-  {
-    recreateNetworkObjects();
-  }
-
   // Check for memory analysis triggers
   checkMemoryAnalysisTrigger();
 
+  // Daily/weekly/monthly rollups - places held events and queues checkpoints
+  usageStatsService();
+
   // Reduced state debug output - every 30 seconds instead of 5
-  static unsigned long lastStateDebug = 0;
+  static uint64_t lastStateDebug = 0;
   if (_currentTime - lastStateDebug > 30000)
   {
-    writeLog("[STATE] FF:%d LF:%d RF:%d", _flushFlowActive, _leftFlushActive, _rightFlushActive);
+    LOG_D(TIMER, "[STATE] FF:%d LF:%d RF:%d", _flushFlowActive, _leftFlushActive, _rightFlushActive);
     lastStateDebug = _currentTime;
   }
 
-  // Web server disabled
+  // Serve /status requests without blocking the UI
+  serviceStatusServer();
+
+  // Commands typed on the serial monitor
+  serviceSerialCommands();
 
   // Run waste repo tests once
   runWasteRepoTests();
+
+  // One display refresh per subscriber for everything published this pass
+  eventBusDispatchFrame();
 }
 
 void checkTouch(int16_t touchX, int16_t touchY)
 {
-  writeLog("Touched: X = %d, Y = %d", touchX, touchY);
+  LOG_D(UI, "Touched: X = %d, Y = %d", touchX, touchY);
 
   // Check if start/stop button was touched (with debouncing)
   if (_startStopButtonShape && _startStopButtonShape->isTouched(touchX, touchY))
   {
-    unsigned long currentTime = millis();
+    uint64_t currentTime = monoMillis();
     if (currentTime - lastButtonPress > BUTTON_DEBOUNCE_MS)
     {
       writeLog("Start/Stop button touched!");
@@ -510,18 +524,23 @@ void updateLCDDisplay()
   }
 }
 
-void incrementFlushCounter()
+// Display subscribers - however many counters changed during a loop() pass, each
+// display redraws once when the frame is dispatched
+static void refreshLCDFrame(uint32_t /* events */)
 {
-  // This function is called from draw_functions.cpp
   updateLCDDisplay();
-  drawFlowDetails(); // Update TFT flow details to match LCD
 }
 
-void incrementWasteCounter()
+static void refreshFlowDetailsFrame(uint32_t /* events */)
 {
-  // This function is called from draw_functions.cpp
-  updateLCDDisplay();
-  drawFlowDetails(); // Update TFT flow details to match LCD
+  if (!flushSettings.isSettingsVisible()) // Closing settings redraws the whole screen
+    drawFlowDetails();
+}
+
+void subscribeDisplays()
+{
+  eventBusSubscribeFrame(APP_EVENTS_COUNTERS | APP_EVENTS_WORKFLOW, refreshLCDFrame);
+  eventBusSubscribeFrame(APP_EVENTS_COUNTERS, refreshFlowDetailsFrame);
 }
 
 void testWasteRepoTiming()
@@ -544,10 +563,41 @@ void testWasteRepoActivation()
 void runWasteRepoTests()
 {
   static bool testsRun = false;
-  if (!testsRun && millis() > 5000)
+  if (!testsRun && monoMillis() > 5000)
   {
     testWasteRepoTiming();
     testWasteRepoActivation();
     testsRun = true;
   }
 }
+
+// Line-based serial console. Reads whatever has arrived without blocking.
+//   memtrend - dump the heap trend history as CSV
+//   usage    - dump the usage rollup rings as CSV
+void serviceSerialCommands()
+{
+  static char command[24];
+  static uint8_t length = 0;
+
+  while (Serial.available() > 0)
+  {
+    char c = (char)Serial.read();
+    if (c != '\r' && c != '\n')
+    {
+      if (length < sizeof(command) - 1)
+        command[length++] = c;
+      continue;
+    }
+    if (length == 0)
+      continue;
+
+    command[length] = '\0';
+    length = 0;
+    if (strcmp(command, "memtrend") == 0)
+      memoryTrendExportCsv(Serial);
+    else if (strcmp(command, "usage") == 0)
+      usageStatsExportCsv(Serial);
+    else
+      writeLog("Unknown serial command: %s (try: memtrend, usage)", command);
+  }
+}
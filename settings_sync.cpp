@@ -0,0 +1,310 @@
+#include "settings_sync.h"
+#include "draw_functions.h" // For writeLog
+#include "json_stream.h"
+#include "freertos/FreeRTOS.h"
+
+static_assert(SETTINGS_COUNT <= 32, "Settings sync masks hold one bit per setting");
+
+static const uint32_t SETTINGS_SYNC_BACKOFF_BASE_MS = 30000;
+static const uint32_t ALL_FIELDS = (SETTINGS_COUNT == 32) ? 0xFFFFFFFFu : ((1u << SETTINGS_COUNT) - 1);
+
+// Hand-over between the loop task (screen edits in, server values out) and the network task
+static portMUX_TYPE syncLock = portMUX_INITIALIZER_UNLOCKED;
+static int editedValues[SETTINGS_COUNT];
+static uint32_t editedMask = 0;
+static int remoteValues[SETTINGS_COUNT];
+static uint32_t remoteMask = 0;
+
+// Network task only. local mirrors the rig's values, base is the last server document;
+// a field is dirty when they differ or the server's document does not have it yet.
+static int localValues[SETTINGS_COUNT];
+static int baseValues[SETTINGS_COUNT];
+static uint32_t knownMask = 0;
+static bool haveDocument = false;
+static char etag[SETTINGS_SYNC_ETAG_SIZE] = "";
+static uint32_t pushedMask = 0;
+static int pushedValues[SETTINGS_COUNT];
+static uint64_t lastEditAtMs = 0;
+static uint64_t nextPullAtMs = 0;
+static uint64_t retryAtMs = 0;
+static uint32_t backoffMs = 0;
+static SettingsSyncStats syncStats = { -1, 0, 0, 0, 0, 0, 0, 0 };
+
+static int settingIdForKey(const char *key)
+{
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    if (strcmp(SETTING_DESCRIPTORS[i].statusKey, key) == 0)
+      return i;
+  }
+  return -1;
+}
+
+static uint32_t dirtyFields()
+{
+  uint32_t mask = 0;
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    if (!(knownMask & (1u << i)) || localValues[i] != baseValues[i])
+      mask |= 1u << i;
+  }
+  return mask;
+}
+
+static void takeLocalEdits()
+{
+  portENTER_CRITICAL(&syncLock);
+  uint32_t mask = editedMask;
+  editedMask = 0;
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    if (mask & (1u << i))
+      localValues[i] = editedValues[i];
+  }
+  portEXIT_CRITICAL(&syncLock);
+
+  if (mask)
+    lastEditAtMs = monoMillis();
+}
+
+static void exchangeDone()
+{
+  backoffMs = 0;
+  retryAtMs = 0;
+  nextPullAtMs = monoMillis() + SETTINGS_SYNC_POLL_MS;
+}
+
+void settingsSyncBegin(const int *values)
+{
+  // Runs before the network task starts
+  memcpy(localValues, values, sizeof(localValues));
+  memcpy(baseValues, values, sizeof(baseValues));
+}
+
+void settingsSyncLocalEdit(SettingId id, int value)
+{
+  portENTER_CRITICAL(&syncLock);
+  editedValues[id] = value;
+  editedMask |= 1u << id;
+  portEXIT_CRITICAL(&syncLock);
+}
+
+// A server value wins over an edit the network task has not picked up yet, so the
+// screen and the server end up agreeing
+bool settingsSyncTakeRemote(int *values, uint32_t *mask)
+{
+  portENTER_CRITICAL(&syncLock);
+  *mask = remoteMask;
+  remoteMask = 0;
+  editedMask &= ~*mask;
+  memcpy(values, remoteValues, sizeof(remoteValues));
+  portEXIT_CRITICAL(&syncLock);
+  return *mask != 0;
+}
+
+bool settingsSyncDue()
+{
+  takeLocalEdits();
+  uint64_t now = monoMillis();
+  if (now < retryAtMs)
+    return false;
+  if (haveDocument && dirtyFields() && now - lastEditAtMs >= SETTINGS_SYNC_PUSH_DELAY_MS)
+    return true;
+  return now >= nextPullAtMs;
+}
+
+bool settingsSyncHasLocalChanges()
+{
+  return haveDocument && dirtyFields() != 0;
+}
+
+const char *settingsSyncETag()
+{
+  return etag;
+}
+
+// {"revision":N,"settings":{...}} - unknown fields are skipped so older firmware can
+// share a document with newer firmware
+static bool parseDocument(char *body, size_t length, int32_t &revision, int *values, uint32_t &present)
+{
+  JsonReader reader(body, length);
+  if (reader.next() != JSON_BEGIN_OBJECT)
+    return false;
+
+  for (;;)
+  {
+    JsonToken token = reader.next();
+    if (token == JSON_END_OBJECT)
+      return true;
+    if (token != JSON_KEY)
+      return false;
+
+    if (strcmp(reader.text(), "revision") == 0)
+    {
+      if (reader.next() != JSON_NUMBER)
+        return false;
+      revision = (int32_t)reader.asLong();
+    }
+    else if (strcmp(reader.text(), "settings") == 0)
+    {
+      if (reader.next() != JSON_BEGIN_OBJECT)
+        return false;
+      for (;;)
+      {
+        token = reader.next();
+        if (token == JSON_END_OBJECT)
+          break;
+        if (token != JSON_KEY)
+          return false;
+        int id = settingIdForKey(reader.text());
+        if (id < 0)
+        {
+          if (!reader.skipValue())
+            return false;
+          continue;
+        }
+        if (reader.next() != JSON_NUMBER)
+          return false;
+        values[id] = (int)reader.asLong();
+        present |= 1u << id;
+      }
+    }
+    else if (!reader.skipValue())
+    {
+      return false;
+    }
+  }
+}
+
+void settingsSyncApplyDocument(char *body, size_t length, const char *responseETag)
+{
+  int32_t revision = -1;
+  int values[SETTINGS_COUNT];
+  uint32_t present = 0;
+  if (!parseDocument(body, length, revision, values, present))
+  {
+    writeLog("[SETTINGS_SYNC] Unreadable settings document (%u bytes)", (unsigned)length);
+    settingsSyncFailed(0);
+    return;
+  }
+
+  // Three-way merge: take the server's value where it moved since the last document
+  // (or everything, for the first one), keep local edits everywhere else
+  uint32_t apply = 0;
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    uint32_t bit = 1u << i;
+    if (!(present & bit))
+      continue;
+    const SettingDescriptor &setting = SETTING_DESCRIPTORS[i];
+    int value = constrain(values[i], setting.minVal, setting.maxVal);
+    bool serverChanged = !haveDocument || !(knownMask & bit) || values[i] != baseValues[i];
+    if (serverChanged && value != localValues[i])
+    {
+      localValues[i] = value;
+      apply |= bit;
+      LOG_I(NET, "[SETTINGS_SYNC] %s = %d from revision %ld", setting.statusKey, value, (long)revision);
+    }
+    // An out-of-range server value stays in base, so the clamped one is pushed back
+    baseValues[i] = values[i];
+  }
+  knownMask = present;
+
+  if (apply)
+  {
+    portENTER_CRITICAL(&syncLock);
+    for (int i = 0; i < SETTINGS_COUNT; i++)
+    {
+      if (apply & (1u << i))
+        remoteValues[i] = localValues[i];
+    }
+    remoteMask |= apply;
+    portEXIT_CRITICAL(&syncLock);
+  }
+
+  if (responseETag && responseETag[0])
+    snprintf(etag, sizeof(etag), "%s", responseETag);
+  else
+    snprintf(etag, sizeof(etag), "\"%ld\"", (long)revision);
+  haveDocument = true;
+  syncStats.revision = revision;
+  syncStats.pulls++;
+  syncStats.applied += __builtin_popcount(apply);
+  exchangeDone();
+}
+
+void settingsSyncNotModified()
+{
+  syncStats.unchanged++;
+  exchangeDone();
+}
+
+size_t settingsSyncBuildPush(char *buffer, size_t size, bool everything)
+{
+  uint32_t mask = everything ? ALL_FIELDS : dirtyFields();
+  if (!mask)
+    return 0;
+
+  FixedBufferPrint body(buffer, size);
+  JsonWriter json(body);
+  json.beginObject();
+  json.beginObject(JKEY("settings"));
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    if (!(mask & (1u << i)))
+      continue;
+    json.field(JsonKey{SETTING_DESCRIPTORS[i].statusKey}, localValues[i]);
+    pushedValues[i] = localValues[i];
+  }
+  json.endObject();
+  json.endObject();
+
+  if (body.overflow())
+  {
+    writeLog("[SETTINGS_SYNC] Push body too large (%u bytes)", (unsigned)json.bytesWritten());
+    return 0;
+  }
+  pushedMask = mask;
+  return body.length();
+}
+
+// The server now holds what was pushed; recording it as the base first means the
+// document in the response does not look like a server-side change of those fields
+void settingsSyncPushed()
+{
+  uint32_t fields = __builtin_popcount(pushedMask);
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    if (pushedMask & (1u << i))
+      baseValues[i] = pushedValues[i];
+  }
+  knownMask |= pushedMask;
+  LOG_I(NET, "[SETTINGS_SYNC] Pushed %lu field(s)", (unsigned long)fields);
+  pushedMask = 0;
+  syncStats.pushes++;
+  syncStats.pushedFields += fields;
+}
+
+// Someone else changed the document first - pull straight away, then push again
+void settingsSyncConflict()
+{
+  LOG_I(NET, "[SETTINGS_SYNC] Document changed on the server (ETag %s) - pulling before pushing again", etag);
+  pushedMask = 0;
+  etag[0] = '\0';
+  syncStats.conflicts++;
+  nextPullAtMs = 0;
+}
+
+void settingsSyncFailed(int httpCode)
+{
+  pushedMask = 0;
+  syncStats.errors++;
+  backoffMs = (backoffMs == 0) ? SETTINGS_SYNC_BACKOFF_BASE_MS : min(backoffMs * 2, (uint32_t)SETTINGS_SYNC_BACKOFF_MAX_MS);
+  retryAtMs = monoMillis() + backoffMs;
+  writeLog("[SETTINGS_SYNC] Sync failed (%d) - next attempt in %lus", httpCode, (unsigned long)(backoffMs / 1000));
+}
+
+void getSettingsSyncStats(SettingsSyncStats &stats)
+{
+  stats = syncStats;
+}
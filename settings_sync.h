@@ -0,0 +1,65 @@
+#ifndef SETTINGS_SYNC_H
+#define SETTINGS_SYNC_H
+
+#include <Arduino.h>
+#include "settings_system.h"
+
+// Remote settings sync.
+// The upload server keeps one versioned settings document per rig at
+// GET/PATCH /settings?device=<id>, named by the SETTINGS_TABLE status keys:
+//   {"revision":7,"settings":{"flush_workflow_repeat_sec":120,"camera_pic_delay_ms":25000,...}}
+// and answers with ETag "<revision>". The network task polls with If-None-Match
+// every SETTINGS_SYNC_POLL_MS (304 while nothing changed) and pushes local edits as
+// a PATCH carrying only the changed fields, guarded by If-Match. A 412 means the
+// document moved on since the last pull: the task pulls, merges and pushes again.
+// A rig the server has never seen creates its document with PUT + If-None-Match: *.
+//
+// Merging is three-way against the last document seen: a field the server changed
+// takes the server's value, even over a local edit not yet pushed; a field changed
+// only on the rig is pushed. The first document after boot is taken as-is, so edits
+// made offline and never pushed before a reboot give way to the server.
+//
+// Remote values reach SettingsSystem through SettingsSystem::applyRemoteSettings()
+// on the loop task and then go live like a screen edit (next cycle boundary).
+// tools/settings_server.py is a local stand-in for the server side.
+
+#ifndef SETTINGS_SYNC_ENABLED
+#define SETTINGS_SYNC_ENABLED 1
+#endif
+
+#define SETTINGS_SYNC_POLL_MS 60000         // Pull interval while idle
+#define SETTINGS_SYNC_PUSH_DELAY_MS 3000    // Let a burst of taps settle before pushing
+#define SETTINGS_SYNC_BACKOFF_MAX_MS 3600000 // Failures back off up to an hour
+#define SETTINGS_SYNC_ETAG_SIZE 24
+
+struct SettingsSyncStats
+{
+  int32_t revision;   // Revision of the last document seen, -1 before the first
+  uint32_t pulls;     // Documents received, including push responses
+  uint32_t unchanged; // 304 answers
+  uint32_t applied;   // Fields taken from the server
+  uint32_t pushes;    // PATCH/PUT the server accepted
+  uint32_t pushedFields;
+  uint32_t conflicts; // 412 answers
+  uint32_t errors;
+};
+
+// Loop task
+void settingsSyncBegin(const int *values);            // Current values, once at boot
+void settingsSyncLocalEdit(SettingId id, int value);  // After a screen edit
+bool settingsSyncTakeRemote(int *values, uint32_t *mask); // Fields to apply; bit n = SettingId n
+
+// Network task
+bool settingsSyncDue();               // Time to pull, or local edits waiting to be pushed
+bool settingsSyncHasLocalChanges();
+const char *settingsSyncETag();       // "" before the first document
+void settingsSyncApplyDocument(char *body, size_t length, const char *etag); // 200/201 body, parsed in place
+void settingsSyncNotModified();
+size_t settingsSyncBuildPush(char *buffer, size_t size, bool everything); // PATCH/PUT body, 0 when nothing to send
+void settingsSyncPushed();          // Before applying the response document
+void settingsSyncConflict();
+void settingsSyncFailed(int httpCode);
+
+void getSettingsSyncStats(SettingsSyncStats &stats);
+
+#endif // SETTINGS_SYNC_H
@@ -1,5 +1,40 @@
 #include "settings_system.h"
 #include "draw_functions.h" // For writeLog
+#include "heap_tags.h"
+#include "freertos/task.h"
+#include "esp_rom_crc.h"
+#include "settings_sync.h"
+
+static const char* SETTINGS_NAMESPACE = "flush_settings";
+static const char* SETTINGS_BLOB_KEY = "blob";
+static const uint32_t SETTINGS_BLOB_MAGIC = 0x54534653; // "SFST"
+static const uint32_t SETTINGS_WRITER_STACK_SIZE = 4096;
+static const UBaseType_t SETTINGS_WRITER_PRIORITY = tskIDLE_PRIORITY + 1;
+static const BaseType_t SETTINGS_WRITER_CORE = 0;
+
+// Blob layout: header, count values, then a CRC-32 over header and values
+struct SettingsBlobHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+};
+
+// Two slots: the live one and the one the next publish is built in
+static SettingsSnapshot snapshotSlots[2];
+std::atomic<const SettingsSnapshot*> currentSettingsSnapshot(&snapshotSlots[0]);
+
+// Every row must be editable and start inside its own range
+static constexpr bool settingDescriptorsValid() {
+  for (const SettingDescriptor& d : SETTING_DESCRIPTORS) {
+    if (d.step <= 0 || d.scale <= 0 || d.minVal > d.maxVal || d.defaultValue < d.minVal || d.defaultValue > d.maxVal) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(settingDescriptorsValid(), "SETTINGS_TABLE row with an empty range, a default outside it, or a zero step");
+
+static const size_t SETTINGS_BLOB_MAX = sizeof(SettingsBlobHeader) + SETTINGS_COUNT * sizeof(int32_t) + sizeof(uint32_t);
 
 // Forward declaration for drawFlowDetails
 void drawFlowDetails();
@@ -18,23 +53,31 @@ SettingsSystem::SettingsSystem(TFT_eSPI* display) {
   touching = false;
   lastTouch = 0;
   scrollOffset = 0;  // Initialize scroll offset
-  
-  // Initialize settings with 8 items to test scrolling
-  settings[0] = {"Flush Relay Time Lapse", "ms", 3000, 1000, 10000, 500, false, "flushRelayTimeLapse"};
-  settings[1] = {"Flush Workflow Repeat", "sec", 120, 60, 600, 30, false, "flushWorkflowRepeat"};
-  settings[2] = {"Waste Qty Per Flush", "ml", 50, 25, 3000, 25, false, "wasteQty"};
-  settings[3] = {"Pic Every N Flushes", "", 2, 1, 10, 1, false, "picFlushes"};
-  settings[4] = {"Waste Repo Pump Delay", "sec", 7, 1, 20, 1, false, "wasteDelay"};
-  settings[5] = {"Camera Pic Delay", "ms", 25000, 500, 30000, 500, false, "cameraPicDelay"};
-  settings[6] = {"Flush right, after left flush delay", "sec", 10, 1, 100, 1, false, "flushRighDelay"};
-  settings[7] = {"Screen Timeout", "sec", 60, 10, 300, 10, false, "timeout"};
-  settings[8] = {"Volume of water per flush left toilet", "oz", 128, 60, 1000, 12, false, "leftTWaterFlushed"};
-  settings[9] = {"Volume of water per flush right toilet", "oz", 128, 60, 1000, 12, false, "rightTWaterFlushed"};
+  editingIndex = -1;
+  commitQueue = nullptr;
+  snapshotPending = false;
+  memset(&committed, 0, sizeof(committed));
+  memset(&storeStats, 0, sizeof(storeStats));
+
+  // Code defaults - new settings are only ever appended (see SETTINGS_TABLE)
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
+    values[i] = SETTING_DESCRIPTORS[i].defaultValue;
+  }
 }
 
 void SettingsSystem::begin() {
-  prefs.begin("flush_settings", false);
+  prefs.begin(SETTINGS_NAMESPACE, false);
   loadSettings();
+  publishSnapshot();
+  settingsSyncBegin(values);
+
+  // From here on only the writer task touches prefs
+  commitQueue = xQueueCreate(1, sizeof(StoredValues));
+  if (!commitQueue ||
+      xTaskCreatePinnedToCore(writerTask, "settings", SETTINGS_WRITER_STACK_SIZE, this, SETTINGS_WRITER_PRIORITY,
+        nullptr, SETTINGS_WRITER_CORE) != pdPASS) {
+    writeLog("[SETTINGS] Could not start the writer task - changes will not be saved");
+  }
 }
 
 void SettingsSystem::showSettings() {
@@ -55,9 +98,9 @@ void SettingsSystem::handleTouch() {
   uint16_t x, y;
   bool pressed = tft->getTouch(&x, &y);
   
-  if(pressed && !touching && (millis() - lastTouch > 200)) {
+  if(pressed && !touching && (monoMillis() - lastTouch > 200)) {
     touching = true;
-    lastTouch = millis();
+    lastTouch = monoMillis();
     
     if(settingsVisible) {
       handleSettingsPageTouch(x, y);
@@ -68,7 +111,7 @@ void SettingsSystem::handleTouch() {
 }
 
 void SettingsSystem::handleSettingsPageTouch(int x, int y) {
-  writeLog("Settings Touch: X=%d, Y=%d", x, y);
+  LOG_D(UI, "Settings Touch: X=%d, Y=%d", x, y);
   
   // Back button
   if(x >= 10 && x <= 50 && y >= 10 && y <= 40) {
@@ -81,34 +124,34 @@ void SettingsSystem::handleSettingsPageTouch(int x, int y) {
   
   // Scroll arrow buttons - LARGER TOUCH AREAS
   if(x >= 200 && x <= 235) {
-    // writeLog("Touch in scroll arrow area"); // Too verbose
+    LOG_V(UI, "Touch in scroll arrow area");
     
     // Up arrow - LARGER touch area
     if(y >= 55 && y <= 90) {
-      writeLog("Settings: Scroll UP touched");
+      LOG_D(UI, "Settings: Scroll UP touched");
       if(scrollOffset > 0) {
         scrollOffset -= 35; // Scroll UP (show previous items)
         if(scrollOffset < 0) scrollOffset = 0;
-        writeLog("Settings: Scrolled up - New offset: %d", scrollOffset);
+        LOG_D(UI, "Settings: Scrolled up - New offset: %d", scrollOffset);
         drawInterface();
       } else {
-        writeLog("Settings: Already at top - cannot scroll up");
+        LOG_D(UI, "Settings: Already at top - cannot scroll up");
       }
       return;
     }
     
     // Down arrow - LARGER touch area
     if(y >= 275 && y <= 320) {  // Extended to bottom of screen
-      writeLog("Settings: Scroll DOWN touched");
-      int maxScroll = max(0, (8 * 35) - (320 - 55 - 10));
-      // writeLog("Max scroll: %d", maxScroll); // Too verbose
+      LOG_D(UI, "Settings: Scroll DOWN touched");
+      int maxScroll = max(0, (SETTINGS_COUNT * 35) - (320 - 55 - 10));
+      LOG_V(UI, "Max scroll: %d", maxScroll);
       if(scrollOffset < maxScroll) {
         scrollOffset += 35; // Scroll DOWN (show next items)
         if(scrollOffset > maxScroll) scrollOffset = maxScroll;
-        writeLog("Settings: Scrolled down - New offset: %d", scrollOffset);
+        LOG_D(UI, "Settings: Scrolled down - New offset: %d", scrollOffset);
         drawInterface();
       } else {
-        writeLog("Settings: Already at bottom - cannot scroll down");
+        LOG_D(UI, "Settings: Already at bottom - cannot scroll down");
       }
       return;
     }
@@ -118,7 +161,7 @@ void SettingsSystem::handleSettingsPageTouch(int x, int y) {
   int itemHeight = 35;
   int startY = 55;
   
-  for(int i = 0; i < 8; i++) {
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
     int itemY = startY + (i * itemHeight) - scrollOffset;
     
     // Check if item is visible and touched (exclude right scroll area)
@@ -126,25 +169,24 @@ void SettingsSystem::handleSettingsPageTouch(int x, int y) {
        x >= 10 && x <= 195 &&  // Reduced to avoid scroll arrows
        itemY >= startY && itemY <= (320 - 10 - itemHeight)) {
       
-      writeLog("Settings: Item %d (%s) touched", i, settings[i].label);
+      const SettingDescriptor& setting = SETTING_DESCRIPTORS[i];
+      LOG_D(UI, "Settings: Item %d (%s) touched", i, setting.label);
       
-      if(settings[i].editing) {
+      if(editingIndex == i) {
         // Handle value editing
         if(x < 120) {
-          settings[i].value = max(settings[i].minVal, 
-            settings[i].value - settings[i].step);
-          writeLog("Settings: Decreased '%s' to %d", settings[i].label, settings[i].value);
+          values[i] = max(setting.minVal, values[i] - setting.step);
+          writeLog("Settings: Decreased '%s' to %d", setting.label, values[i]);
         } else {
-          settings[i].value = min(settings[i].maxVal, 
-            settings[i].value + settings[i].step);
-          writeLog("Settings: Increased '%s' to %d", settings[i].label, settings[i].value);
+          values[i] = min(setting.maxVal, values[i] + setting.step);
+          writeLog("Settings: Increased '%s' to %d", setting.label, values[i]);
         }
+        settingsSyncLocalEdit((SettingId)i, values[i]);
         saveSettings();
       } else {
         // Enter edit mode
-        writeLog("Settings: Entering edit mode for '%s'", settings[i].label);
-        resetEditingStates();
-        settings[i].editing = true;
+        writeLog("Settings: Entering edit mode for '%s'", setting.label);
+        editingIndex = i;
       }
       drawInterface();
       return;
@@ -152,21 +194,126 @@ void SettingsSystem::handleSettingsPageTouch(int x, int y) {
   }
 }
 
+static int clampSetting(const SettingDescriptor& setting, int32_t value) {
+  return constrain(value, setting.minVal, setting.maxVal);
+}
+
+static size_t packBlob(const int32_t* values, uint8_t* blob) {
+  SettingsBlobHeader header = { SETTINGS_BLOB_MAGIC, SETTINGS_SCHEMA_VERSION, SETTINGS_COUNT };
+  size_t size = 0;
+  memcpy(blob, &header, sizeof(header));
+  size += sizeof(header);
+  memcpy(blob + size, values, SETTINGS_COUNT * sizeof(int32_t));
+  size += SETTINGS_COUNT * sizeof(int32_t);
+  uint32_t crc = esp_rom_crc32_le(0, blob, size);
+  memcpy(blob + size, &crc, sizeof(crc));
+  return size + sizeof(crc);
+}
+
 void SettingsSystem::loadSettings() {
-  // FORCE DEFAULTS: Use code defaults instead of flash memory
-  writeLog("Using code defaults (ignoring flash memory)");
-  for(int i = 0; i < 8; i++) {
-    writeLog("Setting %d (%s): %d", i, settings[i].label, settings[i].value);
-    writeLog("Settings: Loading default '%s' = %d", settings[i].label, settings[i].value);
+  uint64_t startUs = monoMicros();
+
+  if (loadBlob()) {
+    writeLog("[SETTINGS] Loaded schema v%u in %luus", storeStats.loadedVersion, (unsigned long)(monoMicros() - startUs));
+  } else if (storeStats.errors > 0) {
+    // Corrupt blob already reported - defaults stay until the next edit rewrites it
+  } else if (migrateLegacyKeys()) {
+    writeLog("[SETTINGS] Migrated v1 keys to schema v%d in %luus", SETTINGS_SCHEMA_VERSION,
+      (unsigned long)(monoMicros() - startUs));
+  } else {
+    writeLog("[SETTINGS] Nothing stored - using code defaults");
+  }
+
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
+    committed.values[i] = values[i];
+    LOG_D(UI, "Setting %d (%s): %d", i, SETTING_DESCRIPTORS[i].label, values[i]);
+  }
+}
+
+// Schema v2+: one blob. Values beyond the stored count keep their defaults, values a
+// newer firmware added are ignored, and everything is clamped to the current ranges.
+bool SettingsSystem::loadBlob() {
+  size_t size = prefs.getBytesLength(SETTINGS_BLOB_KEY);
+  if (size == 0) {
+    return false;
+  }
+
+  uint8_t blob[sizeof(SettingsBlobHeader) + 64 * sizeof(int32_t) + sizeof(uint32_t)]; // Room for newer builds' blobs
+  SettingsBlobHeader header;
+  uint32_t storedCrc;
+  if (size < sizeof(header) + sizeof(storedCrc) || size > sizeof(blob) ||
+      prefs.getBytes(SETTINGS_BLOB_KEY, blob, size) != size) {
+    writeLog("[SETTINGS] Stored blob has a bad size (%u bytes) - using code defaults", (unsigned)size);
+    storeStats.errors++;
+    return false;
   }
-  writeLog("All settings loaded from code defaults");
+  memcpy(&header, blob, sizeof(header));
+  memcpy(&storedCrc, blob + size - sizeof(storedCrc), sizeof(storedCrc));
+  if (header.magic != SETTINGS_BLOB_MAGIC ||
+      size != sizeof(header) + header.count * sizeof(int32_t) + sizeof(storedCrc) ||
+      esp_rom_crc32_le(0, blob, size - sizeof(storedCrc)) != storedCrc) {
+    writeLog("[SETTINGS] Stored blob is corrupt - using code defaults");
+    storeStats.errors++;
+    return false;
+  }
+
+  // Per-version fixups go here when a setting changes meaning (units, range)
+  if (header.version > SETTINGS_SCHEMA_VERSION) {
+    writeLog("[SETTINGS] Blob is from a newer schema (v%u) - keeping the %d settings this build knows", header.version,
+      SETTINGS_COUNT);
+  }
+
+  int stored = min((int)header.count, (int)SETTINGS_COUNT);
+  for(int i = 0; i < stored; i++) {
+    int32_t value;
+    memcpy(&value, blob + sizeof(header) + i * sizeof(int32_t), sizeof(value));
+    values[i] = clampSetting(SETTING_DESCRIPTORS[i], value);
+  }
+  storeStats.loadedVersion = (uint8_t)header.version;
+  return true;
+}
+
+// Schema v1 wrote one int per setting under its legacyKey (and never the water volumes).
+// Fold whatever is there into a blob and drop the old keys.
+bool SettingsSystem::migrateLegacyKeys() {
+  bool found = false;
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
+    const SettingDescriptor& setting = SETTING_DESCRIPTORS[i];
+    if (setting.legacyKey && prefs.isKey(setting.legacyKey)) {
+      values[i] = clampSetting(setting, prefs.getInt(setting.legacyKey, values[i]));
+      found = true;
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  StoredValues stored;
+  memcpy(stored.values, values, sizeof(stored.values));
+  commitValues(stored, 0);
+  if (storeStats.commits == 0) {
+    return true; // Keep the old keys so the next boot can try again
+  }
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
+    if (SETTING_DESCRIPTORS[i].legacyKey) {
+      prefs.remove(SETTING_DESCRIPTORS[i].legacyKey);
+    }
+  }
+  storeStats.loadedVersion = 1;
+  return true;
 }
 
+// UI path: snapshot the values and hand them to the writer - never touches flash
 void SettingsSystem::saveSettings() {
-  for(int i = 0; i < 8; i++) {
-    prefs.putInt(settings[i].prefKey, settings[i].value);
+  StoredValues stored;
+  memcpy(stored.values, values, sizeof(stored.values));
+  portENTER_CRITICAL(&statsLock);
+  storeStats.changes++;
+  portEXIT_CRITICAL(&statsLock);
+  snapshotPending = true;
+  if (commitQueue) {
+    xQueueOverwrite(commitQueue, &stored); // A newer snapshot replaces one not yet written
   }
-  writeLog("Flush settings saved to memory");
   
   // Update flow details when settings change
   if (!settingsVisible) {
@@ -174,6 +321,122 @@ void SettingsSystem::saveSettings() {
   }
 }
 
+// Values from the settings server are stored and go live like a screen edit
+void SettingsSystem::applyRemoteSettings() {
+  int remote[SETTINGS_COUNT];
+  uint32_t mask;
+  if (!settingsSyncTakeRemote(remote, &mask)) {
+    return;
+  }
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
+    if (mask & (1u << i)) {
+      values[i] = clampSetting(SETTING_DESCRIPTORS[i], remote[i]);
+      writeLog("Settings: '%s' set to %d by the settings server", SETTING_DESCRIPTORS[i].label, values[i]);
+    }
+  }
+  saveSettings();
+  if (settingsVisible) {
+    drawInterface();
+  }
+}
+
+void SettingsSystem::commitValues(const StoredValues& values, uint32_t burst) {
+  if (memcmp(&values, &committed, sizeof(values)) == 0) {
+    portENTER_CRITICAL(&statsLock);
+    storeStats.unchanged++;
+    portEXIT_CRITICAL(&statsLock);
+    LOG_D(UI, "[SETTINGS] %lu edit(s) ended on the stored values - nothing to write", (unsigned long)burst);
+    return;
+  }
+
+  uint8_t blob[SETTINGS_BLOB_MAX];
+  size_t size = packBlob(values.values, blob);
+  uint64_t startUs = monoMicros();
+  size_t written = prefs.putBytes(SETTINGS_BLOB_KEY, blob, size);
+  uint32_t elapsedUs = (uint32_t)(monoMicros() - startUs);
+
+  if (written != size) {
+    portENTER_CRITICAL(&statsLock);
+    storeStats.errors++;
+    portEXIT_CRITICAL(&statsLock);
+    writeLog("[SETTINGS] Commit failed after %luus - will retry on the next change", (unsigned long)elapsedUs);
+    return;
+  }
+  committed = values;
+  portENTER_CRITICAL(&statsLock);
+  storeStats.commits++;
+  storeStats.lastCommitUs = elapsedUs;
+  if (elapsedUs > storeStats.maxCommitUs) {
+    storeStats.maxCommitUs = elapsedUs;
+  }
+  portEXIT_CRITICAL(&statsLock);
+  LOG_I(UI, "[SETTINGS] Saved %lu edit(s) in one %u-byte write - %luus", (unsigned long)burst, (unsigned)size,
+    (unsigned long)elapsedUs);
+}
+
+// Coalesces bursts of taps: every newer snapshot restarts the quiet period, and only
+// the last one is written
+void SettingsSystem::writerTask(void* parameter) {
+  HeapTagScope heapTag(HEAP_TAG_SETTINGS);
+  SettingsSystem* self = (SettingsSystem*)parameter;
+  StoredValues values;
+  uint32_t changesWritten = self->changeCount();
+
+  for(;;) {
+    if (xQueueReceive(self->commitQueue, &values, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    while (xQueueReceive(self->commitQueue, &values, pdMS_TO_TICKS(SETTINGS_COMMIT_DEBOUNCE_MS)) == pdTRUE) {
+    }
+    uint32_t changes = self->changeCount();
+    self->commitValues(values, changes - changesWritten);
+    changesWritten = changes;
+  }
+}
+
+uint32_t SettingsSystem::changeCount() {
+  portENTER_CRITICAL(&statsLock);
+  uint32_t changes = storeStats.changes;
+  portEXIT_CRITICAL(&statsLock);
+  return changes;
+}
+
+void SettingsSystem::getStoreStats(SettingsStoreStats& stats) {
+  portENTER_CRITICAL(&statsLock);
+  stats = storeStats;
+  portEXIT_CRITICAL(&statsLock);
+}
+
+void SettingsSystem::publishSnapshot() {
+  const SettingsSnapshot* live = currentSettingsSnapshot.load(std::memory_order_relaxed);
+  SettingsSnapshot* next = (live == &snapshotSlots[0]) ? &snapshotSlots[1] : &snapshotSlots[0];
+
+  next->generation = live->generation + 1;
+  next->flushRelayMs = getFlushRelayTimeLapse();
+  next->cycleMs = getFlushWorkflowRepeat();
+  next->wasteQtyMl = getWasteQtyPerFlush();
+  next->pumpDurationMs = (next->wasteQtyMl * 1000) / PUMP_WASTE_ML_SEC;
+  next->picEveryNFlushes = max(1, getPicEveryNFlushes());
+  next->wasteRepoDelayMs = getWasteRepoTriggerDelayMs();
+  next->cameraDelayMs = getCameraTriggerAfterFlushMs();
+  next->rightFlushDelayMs = getRightToiletFlushDelaySec() * 1000;
+  next->leftWaterOz = getLeftToiletWaterOz();
+  next->rightWaterOz = getRightToiletWaterOz();
+
+  currentSettingsSnapshot.store(next, std::memory_order_release);
+  snapshotPending = false;
+  LOG_I(UI, "[SETTINGS] Snapshot #%lu live - cycle %dms, pump %dms, camera every %d flushes",
+    (unsigned long)next->generation, next->cycleMs, next->pumpDurationMs, next->picEveryNFlushes);
+}
+
+bool SettingsSystem::applyPendingSettings() {
+  if (!snapshotPending) {
+    return false;
+  }
+  publishSnapshot();
+  return true;
+}
+
 void SettingsSystem::drawInterface() {
   tft->fillScreen(SETTINGS_BG_COLOR);
   drawHeader();
@@ -184,7 +447,7 @@ void SettingsSystem::drawInterface() {
   int availableHeight = 320 - startY - 10;
   
   // Draw visible items based on scroll offset
-  for(int i = 0; i < 8; i++) {
+  for(int i = 0; i < SETTINGS_COUNT; i++) {
     int itemY = startY + (i * itemHeight) - scrollOffset;
     
     // Only draw items that are visible on screen
@@ -207,7 +470,7 @@ void SettingsSystem::drawInterface() {
   tft->setTextDatum(MC_DATUM);
   // Draw inverted triangle using multiple lines
   tft->drawString("v", 217, 292);  // Draw simple v character
-  // writeLog("Current scroll offset: %d", scrollOffset); // Too verbose
+  LOG_V(UI, "Current scroll offset: %d", scrollOffset);
 }
 
 void SettingsSystem::drawHeader() {
@@ -236,14 +499,15 @@ void SettingsSystem::drawBackButton() {
 }
 
 void SettingsSystem::drawSettingItem(int index, int y) {
-  FlushSetting& setting = settings[index];
+  const SettingDescriptor& setting = SETTING_DESCRIPTORS[index];
+  bool editing = (editingIndex == index);
   int x = 10;
   int w = 178;  // Reduced width to make room for scroll arrows
   int h = 30;   // Reduced from 40 to 30
   
   // Background
-  uint16_t bgColor = setting.editing ? SETTINGS_ACCENT_COLOR : SETTINGS_CARD_COLOR;
-  uint16_t textColor = setting.editing ? TFT_WHITE : SETTINGS_TEXT_COLOR;
+  uint16_t bgColor = editing ? SETTINGS_ACCENT_COLOR : SETTINGS_CARD_COLOR;
+  uint16_t textColor = editing ? TFT_WHITE : SETTINGS_TEXT_COLOR;
   
   tft->fillRoundRect(x, y, w, h, 6, bgColor);
   tft->drawRoundRect(x, y, w, h, 6, SETTINGS_BORDER_COLOR);
@@ -255,9 +519,9 @@ void SettingsSystem::drawSettingItem(int index, int y) {
   tft->drawString(setting.label, x + 6, y + 4);
   
   // Value display - more compact
-  String valueStr = formatSettingValue(setting);
+  String valueStr = formatSettingValue((SettingId)index);
   
-  if(setting.editing) {
+  if(editing) {
     // Edit mode - show arrows and highlighted value
     tft->setTextColor(TFT_WHITE);
     tft->setTextSize(1);
@@ -278,7 +542,7 @@ void SettingsSystem::drawSettingItem(int index, int y) {
   }
   
   // Very compact range info (if applicable)
-  if(setting.maxVal > setting.minVal && String(setting.label) != "Pic Every N Flushes") {
+  if(setting.format == SETTING_FORMAT_UNIT && setting.maxVal > setting.minVal) {
     String range = String(setting.minVal) + "-" + String(setting.maxVal);
     tft->setTextColor(SETTINGS_TEXT_SEC_COLOR);
     tft->setTextSize(1);
@@ -287,73 +551,16 @@ void SettingsSystem::drawSettingItem(int index, int y) {
   }
 }
 
-String SettingsSystem::formatSettingValue(FlushSetting setting) {
-  String result;
+String SettingsSystem::formatSettingValue(SettingId id) {
+  String result = String(values[id]);
   
-  if(String(setting.label) == "Pic Every N Flushes") {
-    result = String(setting.value);
-  } else {
-    result = String(setting.value) + setting.unit;
+  if(SETTING_DESCRIPTORS[id].format == SETTING_FORMAT_UNIT) {
+    result += SETTING_DESCRIPTORS[id].unit;
   }
   
   return result;
 }
 
 void SettingsSystem::resetEditingStates() {
-  for(int i = 0; i < 8; i++) {
-    settings[i].editing = false;
-  }
+  editingIndex = -1;
 }
-
-// Getter functions for main program to access settings
-int SettingsSystem::getFlushRelayTimeLapse() {
-  return settings[0].value;
-}
-
-int SettingsSystem::getFlushWorkflowRepeat() {
-  return settings[1].value * 1000; // Convert seconds to milliseconds
-}
-
-int SettingsSystem::getWasteQtyPerFlush() {
-  return settings[2].value;
-}
-
-int SettingsSystem::getPicEveryNFlushes() {
-  return settings[3].value;
-}
-
-int SettingsSystem::getRightToiletFlushDelaySec() {
-  return settings[6].value; // "Flush right, after left flush delay" in seconds
-}
-
-
-
-int SettingsSystem::getWasteRepoTriggerDelayMs() {
-  int result = settings[4].value * 1000; // Convert seconds to milliseconds
-  return result;
-}
-
-int SettingsSystem::getCameraTriggerAfterFlushMs() {
-  return settings[5].value; // Already in milliseconds
-}
-
-int SettingsSystem::getPumpWasteDoseML() {
-  return 50; // Default 50ml
-}
-
-int SettingsSystem::getToiletFlushRelayHoldTimeMS() {
-  return settings[0].value; // Use setting value
-}
-
-int SettingsSystem::getFlushCountForCameraCapture() {
-  return settings[3].value; // Use setting value
-}
-
-int SettingsSystem::getLeftToiletWaterOz() {
-  return settings[8].value; // Left toilet water volume in oz
-}
-
-int SettingsSystem::getRightToiletWaterOz() {
-  return settings[9].value; // Right toilet water volume in oz
-}
-
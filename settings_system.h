@@ -3,6 +3,10 @@
 
 #include <TFT_eSPI.h>
 #include <Preferences.h>
+#include "time_base.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <atomic>
 
 // Color scheme for white background - customizable variables
 extern uint16_t SETTINGS_BG_COLOR;      // White background
@@ -13,16 +17,100 @@ extern uint16_t SETTINGS_TEXT_SEC_COLOR; // Dark gray text
 extern uint16_t SETTINGS_BORDER_COLOR;  // Medium gray borders
 extern uint16_t SETTINGS_ACCENT_COLOR;  // Blue accent
 
-struct FlushSetting {
+// Persistence: all values live in one NVS blob {magic, version, count, values[], crc32}.
+// Settings are only ever appended, so an older blob simply lacks the newest values
+// (they keep their defaults); version 1 was one NVS int per setting and is migrated
+// on first boot. Edits are handed to a writer task that waits until the taps stop
+// for SETTINGS_COMMIT_DEBOUNCE_MS and then writes the blob once.
+#define SETTINGS_SCHEMA_VERSION 2
+#define SETTINGS_COMMIT_DEBOUNCE_MS 1500
+
+struct SettingsStoreStats {
+  uint8_t loadedVersion;  // Schema found at boot (0 = nothing stored, defaults used)
+  uint32_t changes;       // Edits handed to the writer
+  uint32_t commits;       // Blob writes
+  uint32_t unchanged;     // Bursts that ended on the stored values - nothing written
+  uint32_t errors;
+  uint32_t lastCommitUs;
+  uint32_t maxCommitUs;
+};
+
+// Immutable view of the settings the workflow runs on, with the derived values
+// precomputed. Edits build a new snapshot in the spare slot and publish it with one
+// pointer store, either straight away while the workflow is stopped or at the next
+// cycle boundary, so a running cycle never sees a half-applied change. Publishing
+// and reading both happen on the loop task; hold the reference only for the
+// duration of one call.
+struct SettingsSnapshot {
+  uint32_t generation;   // Bumped on every publish
+  int flushRelayMs;
+  int cycleMs;           // Flush workflow repeat
+  int wasteQtyMl;
+  int pumpDurationMs;    // wasteQtyMl at PUMP_WASTE_ML_SEC
+  int picEveryNFlushes;  // Camera modulo, never 0
+  int wasteRepoDelayMs;
+  int cameraDelayMs;
+  int rightFlushDelayMs;
+  int leftWaterOz;
+  int rightWaterOz;
+};
+
+extern std::atomic<const SettingsSnapshot*> currentSettingsSnapshot;
+
+inline const SettingsSnapshot& settingsSnapshot() {
+  return *currentSettingsSnapshot.load(std::memory_order_acquire);
+}
+
+// How a row is shown on the settings screen
+enum SettingFormat : uint8_t {
+  SETTING_FORMAT_UNIT,  // "3000ms", with the min-max range under the label
+  SETTING_FORMAT_PLAIN, // Bare number, no range
+};
+
+// Settings registry - one row per setting, in blob order. Append new rows at the end:
+// the blob stores values by position. SettingId, the descriptor table the screen,
+// storage and /status walk, and the typed getters are all generated from it.
+// Values are stored, edited and reported in their unit; getter() returns value * scale.
+// legacyKey is the schema v1 NVS key, nullptr for settings v1 never wrote.
+//  X(id,              label,                                    unit,  default, min,   max,  step, format,               scale, getter,                        legacyKey,             statusKey)
+#define SETTINGS_TABLE(X) \
+  X(FLUSH_RELAY,       "Flush Relay Time Lapse",                 "ms",  3000,  1000, 10000, 500, SETTING_FORMAT_UNIT,  1,    getFlushRelayTimeLapse,       "flushRelayTimeLapse", "flush_relay_time_lapse_ms") \
+  X(WORKFLOW_REPEAT,   "Flush Workflow Repeat",                  "sec", 120,   60,   600,   30,  SETTING_FORMAT_UNIT,  1000, getFlushWorkflowRepeat,       "flushWorkflowRepeat", "flush_workflow_repeat_sec") \
+  X(WASTE_QTY,         "Waste Qty Per Flush",                    "ml",  50,    25,   3000,  25,  SETTING_FORMAT_UNIT,  1,    getWasteQtyPerFlush,          "wasteQty",            "waste_qty_per_flush_ml") \
+  X(PIC_EVERY_N,       "Pic Every N Flushes",                    "",    2,     1,    10,    1,   SETTING_FORMAT_PLAIN, 1,    getPicEveryNFlushes,          "picFlushes",          "pic_every_n_flushes_count") \
+  X(WASTE_REPO_DELAY,  "Waste Repo Pump Delay",                  "sec", 7,     1,    20,    1,   SETTING_FORMAT_UNIT,  1000, getWasteRepoTriggerDelayMs,   "wasteDelay",          "waste_repo_pump_delay_sec") \
+  X(CAMERA_DELAY,      "Camera Pic Delay",                       "ms",  25000, 500,  30000, 500, SETTING_FORMAT_UNIT,  1,    getCameraTriggerAfterFlushMs, "cameraPicDelay",      "camera_pic_delay_ms") \
+  X(RIGHT_FLUSH_DELAY, "Flush right, after left flush delay",    "sec", 10,    1,    100,   1,   SETTING_FORMAT_UNIT,  1,    getRightToiletFlushDelaySec,  "flushRighDelay",      "flush_right_after_left_delay_sec") \
+  X(SCREEN_TIMEOUT,    "Screen Timeout",                         "sec", 60,    10,   300,   10,  SETTING_FORMAT_UNIT,  1,    getScreenTimeoutSec,          "timeout",             "screen_timeout_sec") \
+  X(LEFT_WATER_OZ,     "Volume of water per flush left toilet",  "oz",  128,   60,   1000,  12,  SETTING_FORMAT_UNIT,  1,    getLeftToiletWaterOz,         nullptr,               "left_toilet_water_oz") \
+  X(RIGHT_WATER_OZ,    "Volume of water per flush right toilet", "oz",  128,   60,   1000,  12,  SETTING_FORMAT_UNIT,  1,    getRightToiletWaterOz,        nullptr,               "right_toilet_water_oz")
+
+#define SETTING_ID_ENTRY(id, ...) SETTING_##id,
+enum SettingId : uint8_t {
+  SETTINGS_TABLE(SETTING_ID_ENTRY)
+  SETTINGS_COUNT
+};
+#undef SETTING_ID_ENTRY
+
+struct SettingDescriptor {
   const char* label;
   const char* unit;
-  int value;
+  int defaultValue;
   int minVal;
   int maxVal;
   int step;
-  bool editing;
-  const char* prefKey;
+  SettingFormat format;
+  int scale;
+  const char* legacyKey;
+  const char* statusKey; // /status field name
+};
+
+#define SETTING_DESCRIPTOR_ENTRY(id, label, unit, def, minVal, maxVal, step, format, scale, getter, legacyKey, statusKey) \
+  { label, unit, def, minVal, maxVal, step, format, scale, legacyKey, statusKey },
+inline constexpr SettingDescriptor SETTING_DESCRIPTORS[SETTINGS_COUNT] = {
+  SETTINGS_TABLE(SETTING_DESCRIPTOR_ENTRY)
 };
+#undef SETTING_DESCRIPTOR_ENTRY
 
 class SettingsSystem {
 public:
@@ -33,42 +121,65 @@ public:
   void hideSettings();
   bool isSettingsVisible();
   
-  // Get setting values for main program to use
-  int getFlushRelayTimeLapse();
-  int getFlushWorkflowRepeat();
-  int getWasteQtyPerFlush();
-  int getPicEveryNFlushes();
-  
+  // Raw value in the setting's unit, and its descriptor
+  int value(SettingId id) const { return values[id]; }
+  static const SettingDescriptor& descriptor(SettingId id) { return SETTING_DESCRIPTORS[id]; }
+
+  // Get setting values for main program to use - one getter per table row
+#define SETTING_GETTER(id, label, unit, def, minVal, maxVal, step, format, scale, getter, legacyKey, statusKey) \
+  int getter() const { return values[SETTING_##id] * (scale); }
+  SETTINGS_TABLE(SETTING_GETTER)
+#undef SETTING_GETTER
+
   // Additional getters for compatibility
-  int getRightToiletFlushDelaySec();
-  int getWasteRepoTriggerDelayMs();
-  int getCameraTriggerAfterFlushMs();
-  int getPumpWasteDoseML();
-  int getToiletFlushRelayHoldTimeMS();
-  int getFlushCountForCameraCapture();
-  
-  // New getters for toilet water volumes
-  int getLeftToiletWaterOz();
-  int getRightToiletWaterOz();
-  
+  int getPumpWasteDoseML() const { return 50; } // Default 50ml
+  int getToiletFlushRelayHoldTimeMS() const { return getFlushRelayTimeLapse(); }
+  int getFlushCountForCameraCapture() const { return getPicEveryNFlushes(); }
+
+  void getStoreStats(SettingsStoreStats& stats);
+
+  // Publish edits made since the last snapshot; true when a new one went live
+  bool applyPendingSettings();
+
+  // Take values pulled by the settings sync (settings_sync.h) - call from loop()
+  void applyRemoteSettings();
 
-  
 private:
+  struct StoredValues {
+    int32_t values[SETTINGS_COUNT];
+  };
+
   TFT_eSPI* tft;
   Preferences prefs;
-  FlushSetting settings[10];  // Increased to 10 for left/right toilet volumes
+  int values[SETTINGS_COUNT];
+  int editingIndex;  // Row in edit mode, -1 = none
   bool settingsVisible;
   bool touching;
-  unsigned long lastTouch;
+  uint64_t lastTouch;
   int scrollOffset;  // Add scroll offset
   
+  // Persistence - the Preferences handle and committed belong to the writer task
+  // after begin(); storeStats is shared with the loop task under statsLock
+  QueueHandle_t commitQueue;
+  StoredValues committed;
+  SettingsStoreStats storeStats;
+  portMUX_TYPE statsLock = portMUX_INITIALIZER_UNLOCKED;
+  bool snapshotPending;
+
+  void publishSnapshot();
+
   void loadSettings();
+  bool loadBlob();
+  bool migrateLegacyKeys();
   void saveSettings();
+  void commitValues(const StoredValues& values, uint32_t burst);
+  uint32_t changeCount();
+  static void writerTask(void* parameter);
   void drawInterface();
   void drawHeader();
   void drawBackButton();
   void drawSettingItem(int index, int y);
-  String formatSettingValue(FlushSetting setting);
+  String formatSettingValue(SettingId id);
   void handleSettingsPageTouch(int x, int y);
   void resetEditingStates();
 };
@@ -0,0 +1,631 @@
+#include "status_server.h"
+#include "draw_functions.h" // For writeLog, getCameraStatus
+#include "settings_system.h"
+#include "network_task.h"
+#include "json_stream.h"
+#include "telemetry.h"
+#include "boot_sequence.h"
+#include "flash_log.h"
+#include "heap_tags.h"
+#include "memory_governor.h"
+#include "memory_trend.h"
+#include "settings_sync.h"
+#include "lcd_display.h"
+#include "event_bus.h"
+#include "usage_stats.h"
+#include <WiFi.h>
+#include <time.h>
+#include <string>
+
+extern SettingsSystem flushSettings;
+extern int leftFlushCount;
+extern int rightFlushCount;
+extern int imageCount;
+extern int totalWasteML;
+extern uint64_t workflowStartTime;
+
+static const uint32_t STATUS_STATS_LOG_EVERY_N_REQUESTS = 100;
+
+enum StatusRoute
+{
+  ROUTE_NONE,
+  ROUTE_STATUS, // GET /status - JSON payload
+  ROUTE_LOG     // GET /log - flash log ring, oldest bytes first
+};
+
+static WiFiServer statusServer(STATUS_SERVER_PORT);
+static bool statusServerStarted = false;
+static StatusServerStats serverStats = {};
+
+// The one client being served, read incrementally across loop() calls
+static WiFiClient activeClient;
+static bool clientActive = false;
+static uint64_t clientAcceptedAtMs = 0;
+static char lineBuffer[128];
+static int lineLength = 0;
+static bool requestLineSeen = false;
+static StatusRoute requestRoute = ROUTE_NONE;
+static bool requestIsGet = false;
+static char clientETag[16];
+
+// GET /log streams the flash log one chunk per loop() pass
+static bool logDownloadActive = false;
+static bool logReaderOpen = false;
+static uint32_t logFlushTicket = 0;
+static uint64_t logDownloadStartMs = 0;
+static FlashLogReader logReader;
+static uint8_t logChunk[STATUS_CHUNK_SIZE];
+
+// Print adapter that batches writes into a fixed buffer and hands full chunks to
+// the socket, so serialization never needs the whole document in memory
+class ChunkedSocketWriter : public Print
+{
+public:
+  ChunkedSocketWriter(WiFiClient &client) : client(client), used(0), total(0) {}
+
+  size_t write(uint8_t c) override
+  {
+    if (used == sizeof(chunk))
+      flush();
+    chunk[used++] = c;
+    total++;
+    return 1;
+  }
+
+  size_t write(const uint8_t *data, size_t size) override
+  {
+    size_t remaining = size;
+    while (remaining > 0)
+    {
+      if (used == sizeof(chunk))
+        flush();
+      size_t copy = min(remaining, sizeof(chunk) - used);
+      memcpy(chunk + used, data, copy);
+      used += copy;
+      data += copy;
+      remaining -= copy;
+    }
+    total += size;
+    return size;
+  }
+
+  void flush() override
+  {
+    if (used > 0)
+    {
+      client.write(chunk, used);
+      used = 0;
+    }
+  }
+
+  uint32_t bytesWritten() const { return total; }
+
+private:
+  WiFiClient &client;
+  static uint8_t chunk[STATUS_CHUNK_SIZE];
+  size_t used;
+  uint32_t total;
+};
+
+uint8_t ChunkedSocketWriter::chunk[STATUS_CHUNK_SIZE];
+
+static const char *cameraStatusName(CameraStatus status)
+{
+  switch (status)
+  {
+  case CAMERA_PENDING:
+    return "pending";
+  case CAMERA_OK:
+    return "online";
+  case CAMERA_ERROR:
+    return "error";
+  default:
+    return "idle";
+  }
+}
+
+static uint32_t fnv1a(uint32_t hash, const void *data, size_t size)
+{
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++)
+  {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Bumped once per loop() frame in which any counter or workflow event was published,
+// so the fingerprint needs no knowledge of which counters exist
+static uint32_t stateGeneration = 0;
+
+static void onStateFrame(uint32_t /* events */)
+{
+  stateGeneration++;
+}
+
+// FNV-1a over everything the payload reports except uptime and heap readings
+static uint32_t statusFingerprint()
+{
+  int32_t state[] = {
+    (int32_t)stateGeneration, _flushFlowActive, (int32_t)workflowStartTime, (int32_t)(workflowStartTime >> 32),
+    getCameraStatus(Left), getCameraStatus(Right), getPendingUploads(),
+    WiFi.status() == WL_CONNECTED,
+  };
+  int32_t settings[SETTINGS_COUNT];
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+    settings[i] = flushSettings.value((SettingId)i);
+
+  UsageRollup usage; // Changes at midnight and on the hour without any event
+  getUsageRollup(usage);
+
+  uint32_t hash = 2166136261u;
+  hash = fnv1a(hash, state, sizeof(state));
+  hash = fnv1a(hash, settings, sizeof(settings));
+  hash = fnv1a(hash, &usage, sizeof(usage));
+  return hash;
+}
+
+// Settings fields are named by SETTINGS_TABLE, so check its keys the way JKEY checks literals
+static constexpr bool settingStatusKeysSafe()
+{
+  for (const SettingDescriptor &setting : SETTING_DESCRIPTORS)
+  {
+    if (!setting.statusKey || !jsonKeyIsSafe(setting.statusKey, std::char_traits<char>::length(setting.statusKey)))
+      return false;
+  }
+  return true;
+}
+static_assert(settingStatusKeysSafe(), "SETTINGS_TABLE status key must be non-empty and need no escaping");
+
+static void writeStatusJSON(Print &out)
+{
+  uint64_t nowMs = monoMillis();
+  JsonWriter json(out);
+  json.beginObject();
+
+  // Core counters
+  json.field(JKEY("flush_count"), leftFlushCount + rightFlushCount);
+  json.field(JKEY("left_flush_count"), leftFlushCount);
+  json.field(JKEY("right_flush_count"), rightFlushCount);
+  json.field(JKEY("total_waste_ml"), totalWasteML);
+
+  // Rollups by local time - null until the clock is set
+  UsageRollup usage;
+  getUsageRollup(usage);
+  if (usage.valid)
+  {
+    json.field(JKEY("daily_flush_count"), (unsigned long)usage.dailyFlushes);
+    json.field(JKEY("weekly_flush_count"), (unsigned long)usage.weeklyFlushes);
+    json.field(JKEY("monthly_flush_count"), (unsigned long)usage.monthlyFlushes);
+    json.field(JKEY("flushes_last_hour"), (unsigned long)usage.flushesLastHour);
+    json.field(JKEY("daily_images"), (unsigned long)usage.dailyImages);
+    json.field(JKEY("daily_waste_ml"), (unsigned long)usage.dailyWasteMl);
+    json.field(JKEY("average_flushes_per_day"), (unsigned long)usage.averageFlushesPerDay);
+  }
+  else
+  {
+    json.fieldNull(JKEY("daily_flush_count"));
+    json.fieldNull(JKEY("weekly_flush_count"));
+    json.fieldNull(JKEY("monthly_flush_count"));
+    json.fieldNull(JKEY("flushes_last_hour"));
+    json.fieldNull(JKEY("daily_images"));
+    json.fieldNull(JKEY("daily_waste_ml"));
+    json.fieldNull(JKEY("average_flushes_per_day"));
+  }
+  if (usage.averageFlushIntervalSec > 0)
+    json.field(JKEY("average_flush_interval_sec"), (unsigned long)usage.averageFlushIntervalSec);
+  else
+    json.fieldNull(JKEY("average_flush_interval_sec"));
+  if (usage.peakUsageHour >= 0)
+    json.field(JKEY("peak_usage_hour"), (int)usage.peakUsageHour);
+  else
+    json.fieldNull(JKEY("peak_usage_hour"));
+
+  // System timing
+  time_t now = time(nullptr);
+  if (now > 1000000000)
+  {
+    char text[32];
+    strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    json.field(JKEY("current_time"), text);
+  }
+  else
+  {
+    json.fieldNull(JKEY("current_time"));
+  }
+  json.field(JKEY("system_uptime_ms"), (unsigned long long)nowMs);
+  json.field(JKEY("system_uptime_sec"), (unsigned long long)(nowMs / 1000));
+
+  // Workflow timing
+  json.field(JKEY("workflow_active"), _flushFlowActive);
+  uint64_t workflowMs = (workflowStartTime > 0) ? nowMs - workflowStartTime : 0;
+  json.field(JKEY("workflow_timespan_ms"), (unsigned long long)workflowMs);
+  json.field(JKEY("workflow_timespan_sec"), (unsigned long long)(workflowMs / 1000));
+
+  // Images and cameras
+  json.field(JKEY("total_images_captured"), imageCount);
+  json.beginObject(JKEY("camera_status"));
+  json.field(JKEY("left"), cameraStatusName(getCameraStatus(Left)));
+  json.field(JKEY("right"), cameraStatusName(getCameraStatus(Right)));
+  json.endObject();
+  json.field(JKEY("pending_uploads"), getPendingUploads());
+
+  // Telemetry uplink
+  TelemetryStats telemetry;
+  getTelemetryStats(telemetry);
+  json.beginObject(JKEY("telemetry"));
+  json.field(JKEY("pending"), (unsigned int)telemetry.pending);
+  json.field(JKEY("sent"), (unsigned long)telemetry.eventsSent);
+  json.field(JKEY("dropped"), (unsigned long)telemetry.dropped);
+  json.field(JKEY("backpressure"), (unsigned long)telemetry.backpressure);
+  json.field(JKEY("failed_batches"), (unsigned long)telemetry.failedBatches);
+  json.endObject();
+
+  // Logging
+  LogStats logStats;
+  getLogStats(logStats);
+  FlashLogStats flashStats;
+  getFlashLogStats(flashStats);
+  json.beginObject(JKEY("log"));
+  json.field(JKEY("dropped"), (unsigned long)logStats.dropped);
+  json.field(JKEY("truncated"), (unsigned long)logStats.truncated);
+  json.field(JKEY("high_water"), (unsigned long)logStats.highWater);
+  json.field(JKEY("flash_ready"), flashStats.ready);
+  json.field(JKEY("flash_stored_bytes"), (unsigned long)flashStats.bytesStored);
+  json.field(JKEY("flash_pages_written"), (unsigned long)flashStats.pagesWritten);
+  json.field(JKEY("flash_dropped_bytes"), (unsigned long)flashStats.droppedBytes);
+  json.field(JKEY("flash_write_errors"), (unsigned long)flashStats.writeErrors);
+  json.endObject();
+
+  // Boot timings (ms from reset, 0 while still pending)
+  json.beginObject(JKEY("boot"));
+  json.field(JKEY("time_to_first_frame_ms"), (unsigned long)getBootStageEndMs(BOOT_FIRST_FRAME));
+  json.field(JKEY("wifi_connect_ms"), (unsigned long)getBootStageMs(BOOT_WIFI));
+  json.field(JKEY("sntp_sync_ms"), (unsigned long)getBootStageMs(BOOT_SNTP));
+  json.endObject();
+
+  // System health
+  bool wifiUp = WiFi.status() == WL_CONNECTED;
+  json.field(JKEY("wifi_status"), wifiUp ? "connected" : "disconnected");
+  json.field(JKEY("wifi_signal_strength"), wifiUp ? WiFi.RSSI() : 0);
+  json.field(JKEY("free_memory"), (unsigned long)ESP.getFreeHeap());
+  json.field(JKEY("largest_free_block"), (unsigned long)ESP.getMaxAllocHeap());
+
+  MemoryGovernorStats governor;
+  getMemoryGovernorStats(governor);
+  json.beginObject(JKEY("memory_governor"));
+  json.field(JKEY("level"), memoryPressureName(governor.level));
+  json.field(JKEY("escalations"), (unsigned long)governor.escalations);
+  json.field(JKEY("relaxations"), (unsigned long)governor.relaxations);
+  json.field(JKEY("lowest_free"), (unsigned long)governor.lowestFree);
+  json.field(JKEY("lowest_largest_block"), (unsigned long)governor.lowestLargest);
+  json.field(JKEY("baseline_free"), (unsigned long)governor.baselineFree);
+  json.beginObject(JKEY("actions"));
+  json.field(JKEY("drop_connection"), (unsigned long)governor.actions[MEM_ACTION_DROP_CONNECTION]);
+  json.field(JKEY("quiet_log"), (unsigned long)governor.actions[MEM_ACTION_QUIET_LOG]);
+  json.field(JKEY("pause_telemetry"), (unsigned long)governor.actions[MEM_ACTION_PAUSE_TELEMETRY]);
+  json.field(JKEY("network_recycle"), (unsigned long)governor.actions[MEM_ACTION_NETWORK_RECYCLE]);
+  json.endObject();
+  json.endObject();
+
+  // Per-cycle heap trend (bytes per workflow cycle)
+  MemoryTrendFit freeTrend, largestTrend;
+  getMemoryTrendFit(MEM_TREND_FREE, freeTrend);
+  getMemoryTrendFit(MEM_TREND_LARGEST, largestTrend);
+  json.beginObject(JKEY("memory_trend"));
+  json.field(JKEY("cycles"), (unsigned long)freeTrend.samples);
+  json.field(JKEY("free_slope"), (long)lroundf(freeTrend.slope));
+  json.field(JKEY("free_t"), (long)lroundf(freeTrend.tValue));
+  json.field(JKEY("largest_slope"), (long)lroundf(largestTrend.slope));
+  json.field(JKEY("leak_suspected"), freeTrend.lossFlagged || largestTrend.lossFlagged);
+  json.endObject();
+
+  // Settings - one field per SETTINGS_TABLE row, in the unit its key names
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+    json.field(JsonKey{SETTING_DESCRIPTORS[i].statusKey}, flushSettings.value((SettingId)i));
+
+  SettingsStoreStats store;
+  flushSettings.getStoreStats(store);
+  json.beginObject(JKEY("settings_store"));
+  json.field(JKEY("schema_loaded"), (unsigned int)store.loadedVersion);
+  json.field(JKEY("changes"), (unsigned long)store.changes);
+  json.field(JKEY("commits"), (unsigned long)store.commits);
+  json.field(JKEY("errors"), (unsigned long)store.errors);
+  json.field(JKEY("last_commit_us"), (unsigned long)store.lastCommitUs);
+  json.field(JKEY("max_commit_us"), (unsigned long)store.maxCommitUs);
+  json.endObject();
+
+  SettingsSyncStats sync;
+  getSettingsSyncStats(sync);
+  json.beginObject(JKEY("settings_sync"));
+  json.field(JKEY("revision"), (long)sync.revision);
+  json.field(JKEY("pulls"), (unsigned long)sync.pulls);
+  json.field(JKEY("unchanged"), (unsigned long)sync.unchanged);
+  json.field(JKEY("applied_fields"), (unsigned long)sync.applied);
+  json.field(JKEY("pushes"), (unsigned long)sync.pushes);
+  json.field(JKEY("pushed_fields"), (unsigned long)sync.pushedFields);
+  json.field(JKEY("conflicts"), (unsigned long)sync.conflicts);
+  json.field(JKEY("errors"), (unsigned long)sync.errors);
+  json.endObject();
+
+  LcdStats lcdStats;
+  getLcdStats(lcdStats);
+  json.beginObject(JKEY("lcd"));
+  json.field(JKEY("updates"), (unsigned long)lcdStats.requests);
+  json.field(JKEY("flushes"), (unsigned long)lcdStats.flushes);
+  json.field(JKEY("chars_written"), (unsigned long)lcdStats.chars);
+  json.field(JKEY("cursor_moves"), (unsigned long)lcdStats.cursorMoves);
+  json.field(JKEY("i2c_bytes"), (unsigned long)lcdStats.lcdBytes * LCD_I2C_BYTES_PER_LCD_BYTE);
+  json.field(JKEY("max_flush_us"), (unsigned long)lcdStats.maxFlushUs);
+  json.endObject();
+
+  UsageStoreStats usageStats;
+  getUsageStoreStats(usageStats);
+  json.beginObject(JKEY("usage_store"));
+  json.field(JKEY("events"), (unsigned long)usageStats.recorded);
+  json.field(JKEY("held"), (unsigned long)usageStats.held);
+  json.field(JKEY("dropped"), (unsigned long)(usageStats.dropped + usageStats.stale));
+  json.field(JKEY("restored"), usageStats.restored);
+  json.field(JKEY("checkpoints"), (unsigned long)usageStats.checkpoints);
+  json.field(JKEY("checkpoint_errors"), (unsigned long)usageStats.checkpointErrors);
+  json.field(JKEY("last_checkpoint_us"), (unsigned long)usageStats.lastCheckpointUs);
+  json.endObject();
+
+  EventBusStats busStats;
+  getEventBusStats(busStats);
+  json.beginObject(JKEY("event_bus"));
+  json.field(JKEY("published"), (unsigned long)busStats.published);
+  json.field(JKEY("frame_calls"), (unsigned long)busStats.frameCalls);
+  json.field(JKEY("coalesced"), (unsigned long)busStats.coalesced);
+  json.endObject();
+
+  // Network
+  // Formatted on the stack - toString()/macAddress() would build Strings per request
+  IPAddress ip = WiFi.localIP();
+  char ipText[16];
+  snprintf(ipText, sizeof(ipText), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  json.field(JKEY("ip_address"), ipText);
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  char macText[18];
+  snprintf(macText, sizeof(macText), "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+  json.field(JKEY("mac_address"), macText);
+
+  json.endObject();
+}
+
+static void sendSimpleResponse(const char *status)
+{
+  activeClient.print("HTTP/1.1 ");
+  activeClient.print(status);
+  activeClient.print("\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+}
+
+// Start a /log download; the body goes out from serviceLogDownload()
+static void beginLogDownload()
+{
+  logFlushTicket = flashLogRequestFlush(); // Include the page still in RAM
+  logDownloadStartMs = monoMillis();
+  logDownloadActive = true;
+  logReaderOpen = false;
+}
+
+static void finishLogDownload()
+{
+  if (logReaderOpen)
+    flashLogCloseReader(logReader);
+  logReaderOpen = false;
+  logDownloadActive = false;
+}
+
+static void serviceLogDownload()
+{
+  if (!activeClient.connected())
+  {
+    finishLogDownload();
+    return;
+  }
+
+  if (!logReaderOpen)
+  {
+    if (!flashLogFlushed(logFlushTicket) && monoMillis() - logDownloadStartMs < STATUS_LOG_FLUSH_WAIT_MS)
+      return;
+    if (!flashLogOpenReader(logReader))
+    {
+      serverStats.errors++;
+      sendSimpleResponse("503 Service Unavailable");
+      finishLogDownload();
+      return;
+    }
+    logReaderOpen = true;
+    activeClient.print("HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nX-Log-Format: ");
+    activeClient.print(LOG_BINARY_MODE ? "binary" : "text");
+    activeClient.print("\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n");
+  }
+
+  size_t length = flashLogRead(logReader, logChunk, sizeof(logChunk));
+  if (length == 0)
+  {
+    finishLogDownload();
+    return;
+  }
+  activeClient.write(logChunk, length);
+  serverStats.bytesSent += length;
+}
+
+// Returns true when the response continues on later loop() passes
+static bool respond()
+{
+  uint64_t startUs = monoMicros();
+  uint32_t heapBefore = ESP.getFreeHeap();
+
+  serverStats.requests++;
+  if (!requestIsGet || requestRoute == ROUTE_NONE)
+  {
+    serverStats.errors++;
+    sendSimpleResponse(requestIsGet ? "404 Not Found" : "405 Method Not Allowed");
+    return false;
+  }
+
+  if (requestRoute == ROUTE_LOG)
+  {
+    beginLogDownload();
+    return true;
+  }
+
+  char etag[16];
+  snprintf(etag, sizeof(etag), "\"%08lx\"", (unsigned long)statusFingerprint());
+
+  if (strcmp(etag, clientETag) == 0)
+  {
+    serverStats.notModified++;
+    activeClient.print("HTTP/1.1 304 Not Modified\r\nETag: ");
+    activeClient.print(etag);
+    activeClient.print("\r\nConnection: close\r\n\r\n");
+    return false;
+  }
+
+  ChunkedSocketWriter out(activeClient);
+  out.print("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCache-Control: no-cache\r\nETag: ");
+  out.print(etag);
+  out.print("\r\nConnection: close\r\n\r\n");
+  writeStatusJSON(out);
+  out.flush();
+
+  serverStats.bytesSent += out.bytesWritten();
+  serverStats.lastServeUs = (uint32_t)(monoMicros() - startUs);
+  if (serverStats.lastServeUs > serverStats.maxServeUs)
+    serverStats.maxServeUs = serverStats.lastServeUs;
+  serverStats.lastHeapDelta = (int32_t)ESP.getFreeHeap() - (int32_t)heapBefore;
+
+  if (serverStats.requests % STATUS_STATS_LOG_EVERY_N_REQUESTS == 0)
+  {
+    LOG_I(NET, "[HTTP] Requests: %lu 304s: %lu Errors: %lu Bytes: %lu Last: %luus Max: %luus Heap delta: %ld",
+      (unsigned long)serverStats.requests, (unsigned long)serverStats.notModified,
+      (unsigned long)serverStats.errors, (unsigned long)serverStats.bytesSent,
+      (unsigned long)serverStats.lastServeUs, (unsigned long)serverStats.maxServeUs,
+      (long)serverStats.lastHeapDelta);
+  }
+  return false;
+}
+
+static void closeClient()
+{
+  finishLogDownload();
+  activeClient.stop();
+  clientActive = false;
+}
+
+// path points at the space before the request target
+static bool pathIs(const char *path, const char *route)
+{
+  if (!path)
+    return false;
+  size_t length = strlen(route);
+  char next = path[1 + length];
+  return strncmp(path + 1, route, length) == 0 && (next == ' ' || next == '?' || next == '\0');
+}
+
+// Handle one complete header line; returns true once the blank line ends the headers
+static bool processLine()
+{
+  lineBuffer[lineLength] = '\0';
+  if (!requestLineSeen)
+  {
+    // "GET /status HTTP/1.1" - query strings are ignored
+    requestLineSeen = true;
+    requestIsGet = strncmp(lineBuffer, "GET ", 4) == 0;
+    const char *path = strchr(lineBuffer, ' ');
+    if (pathIs(path, "/status"))
+      requestRoute = ROUTE_STATUS;
+    else if (pathIs(path, "/log"))
+      requestRoute = ROUTE_LOG;
+    else
+      requestRoute = ROUTE_NONE;
+    return false;
+  }
+
+  if (lineLength == 0)
+    return true;
+
+  if (strncasecmp(lineBuffer, "If-None-Match:", 14) == 0)
+  {
+    const char *value = lineBuffer + 14;
+    while (*value == ' ')
+      value++;
+    snprintf(clientETag, sizeof(clientETag), "%s", value);
+  }
+  return false;
+}
+
+void startStatusServer()
+{
+  if (statusServerStarted)
+    return;
+
+  statusServer.begin();
+  statusServer.setNoDelay(true);
+  eventBusSubscribeFrame(APP_EVENTS_ALL, onStateFrame);
+  statusServerStarted = true;
+  writeLog("[HTTP] Status server listening on port %d", STATUS_SERVER_PORT);
+}
+
+void serviceStatusServer()
+{
+  if (!statusServerStarted)
+    return;
+  HeapTagScope heapTag(HEAP_TAG_NETWORK);
+
+  if (!clientActive)
+  {
+    activeClient = statusServer.accept();
+    if (!activeClient)
+      return;
+    clientActive = true;
+    clientAcceptedAtMs = monoMillis();
+    lineLength = 0;
+    requestLineSeen = false;
+    requestIsGet = false;
+    requestRoute = ROUTE_NONE;
+    clientETag[0] = '\0';
+  }
+
+  if (logDownloadActive)
+  {
+    serviceLogDownload();
+    if (!logDownloadActive)
+      closeClient();
+    return;
+  }
+
+  // Consume whatever has arrived; headers normally come in a single segment
+  while (activeClient.available() > 0)
+  {
+    int c = activeClient.read();
+    if (c == '\n')
+    {
+      if (processLine())
+      {
+        if (!respond())
+          closeClient();
+        return;
+      }
+      lineLength = 0;
+    }
+    else if (c != '\r' && lineLength < (int)sizeof(lineBuffer) - 1)
+    {
+      lineBuffer[lineLength++] = (char)c;
+    }
+  }
+
+  if (!activeClient.connected() || monoMillis() - clientAcceptedAtMs > STATUS_REQUEST_TIMEOUT_MS)
+  {
+    serverStats.errors++;
+    closeClient();
+  }
+}
+
+void getStatusServerStats(StatusServerStats &stats)
+{
+  stats = serverStats;
+}
@@ -0,0 +1,39 @@
+#ifndef STATUS_SERVER_H
+#define STATUS_SERVER_H
+
+#include <Arduino.h>
+
+// Lightweight on-device HTTP status endpoint.
+// GET /status streams the status payload (payload_parameter_candidates.md) straight
+// into the socket through a fixed chunk buffer - no String document is built. The
+// response carries an ETag fingerprint of the device state; pollers that send it
+// back in If-None-Match get a 304 until something changes. Uptime and heap
+// readings alone do not count as a change.
+// GET /log downloads the persistent flash log (flash_log.h), one chunk per loop()
+// pass so a long download does not hold up the UI.
+// Serviced from loop(): one client at a time, never blocks the UI.
+
+#ifndef STATUS_SERVER_PORT
+#define STATUS_SERVER_PORT 80
+#endif
+
+#define STATUS_CHUNK_SIZE 512        // Bytes buffered before each socket write
+#define STATUS_REQUEST_TIMEOUT_MS 500 // Drop clients that never finish their headers
+#define STATUS_LOG_FLUSH_WAIT_MS 1000 // Longest wait for the RAM log page before /log starts
+
+struct StatusServerStats
+{
+  uint32_t requests;
+  uint32_t notModified;   // 304 responses
+  uint32_t errors;        // 400/404/timeouts
+  uint32_t bytesSent;
+  uint32_t lastServeUs;   // Time to serialize and send the last 200
+  uint32_t maxServeUs;
+  int32_t lastHeapDelta;  // Free heap after minus before the last response
+};
+
+void startStatusServer();   // Call once WiFi is up
+void serviceStatusServer(); // Call every loop() - returns immediately when idle
+void getStatusServerStats(StatusServerStats &stats);
+
+#endif // STATUS_SERVER_H
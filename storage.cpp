@@ -0,0 +1,46 @@
+#include "storage.h"
+#include "draw_functions.h" // For writeLog
+#include <LittleFS.h>
+#include "freertos/FreeRTOS.h"
+#include <atomic>
+
+enum StorageState : int
+{
+  STORAGE_UNMOUNTED,
+  STORAGE_MOUNTING,
+  STORAGE_MOUNTED,
+  STORAGE_FAILED
+};
+
+static std::atomic<int> storageState(STORAGE_UNMOUNTED);
+
+bool storageBegin()
+{
+  int expected = STORAGE_UNMOUNTED;
+  if (storageState.compare_exchange_strong(expected, STORAGE_MOUNTING))
+  {
+    uint64_t startMs = monoMillis();
+    bool mounted = LittleFS.begin(true);
+    storageState = mounted ? STORAGE_MOUNTED : STORAGE_FAILED;
+    if (mounted)
+    {
+      writeLog("[STORAGE] LittleFS mounted in %lums - %u of %u KB used", (unsigned long)(monoMillis() - startMs),
+        (unsigned)(LittleFS.usedBytes() / 1024), (unsigned)(LittleFS.totalBytes() / 1024));
+    }
+    else
+    {
+      writeLog("[STORAGE] LittleFS mount failed");
+    }
+    return mounted;
+  }
+
+  // Another task is mounting (possibly formatting) - wait for it
+  while (storageState == STORAGE_MOUNTING)
+    vTaskDelay(pdMS_TO_TICKS(10));
+  return storageState == STORAGE_MOUNTED;
+}
+
+bool storageReady()
+{
+  return storageState == STORAGE_MOUNTED;
+}
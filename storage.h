@@ -0,0 +1,14 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+
+// Shared LittleFS mount.
+// The upload queue (network task) and the flash log (its own writer task) both
+// live on LittleFS and start on different tasks at boot; the first caller mounts
+// (formatting on first use) while any other caller waits for the result.
+
+bool storageBegin(); // Safe from any task; returns the mount result
+bool storageReady();
+
+#endif // STORAGE_H
@@ -0,0 +1,193 @@
+#include "telemetry.h"
+#include "draw_functions.h" // For writeLog
+#include "upload_queue.h"   // For the boot count
+#include "json_stream.h"
+#include "event_bus.h"
+#include "freertos/FreeRTOS.h"
+
+// Event slot for seq s is events[s % TELEMETRY_RING_CAPACITY]; events
+// oldestSeq..nextSeq-1 are pending. Recording past capacity advances oldestSeq.
+static TelemetryEvent events[TELEMETRY_RING_CAPACITY];
+static uint32_t nextSeq = 0;
+static uint32_t oldestSeq = 0;
+static portMUX_TYPE telemetryLock = portMUX_INITIALIZER_UNLOCKED;
+static TelemetryStats telemetryStats = {};
+static uint64_t lastFlushAtMs = 0;
+static volatile bool batchingPaused = false;
+
+void telemetryRecord(TelemetryEventType type, uint8_t side, int32_t value)
+{
+  uint64_t now = monoMillis();
+
+  portENTER_CRITICAL(&telemetryLock);
+  uint32_t pending = nextSeq - oldestSeq;
+  if (pending >= TELEMETRY_RING_CAPACITY)
+  {
+    oldestSeq++;
+    telemetryStats.dropped++;
+  }
+  else if (pending >= TELEMETRY_RING_CAPACITY * 3 / 4)
+  {
+    telemetryStats.backpressure++;
+  }
+
+  TelemetryEvent &event = events[nextSeq % TELEMETRY_RING_CAPACITY];
+  event.atMs = now;
+  event.seq = nextSeq;
+  event.value = value;
+  event.type = type;
+  event.side = side;
+  nextSeq++;
+  telemetryStats.recorded++;
+  portEXIT_CRITICAL(&telemetryLock);
+}
+
+static bool copyEvent(uint32_t seq, TelemetryEvent &event)
+{
+  portENTER_CRITICAL(&telemetryLock);
+  bool present = (int32_t)(seq - oldestSeq) >= 0 && (int32_t)(nextSeq - seq) > 0;
+  if (present)
+    event = events[seq % TELEMETRY_RING_CAPACITY];
+  portEXIT_CRITICAL(&telemetryLock);
+  return present;
+}
+
+static uint32_t pendingEvents()
+{
+  portENTER_CRITICAL(&telemetryLock);
+  uint32_t pending = nextSeq - oldestSeq;
+  portEXIT_CRITICAL(&telemetryLock);
+  return pending;
+}
+
+static void recordAppEvent(const AppEvent &event)
+{
+  switch (event.type)
+  {
+  case APP_EVENT_FLUSH:
+    telemetryRecord(EVT_FLUSH, event.side, event.value);
+    break;
+  case APP_EVENT_WASTE_DOSE:
+    telemetryRecord(EVT_PUMP_DOSE, event.side, event.value);
+    break;
+  case APP_EVENT_CYCLE_COMPLETE:
+    telemetryRecord(EVT_CYCLE_COMPLETE, event.side, event.value);
+    break;
+  case APP_EVENT_WORKFLOW_START:
+    telemetryRecord(EVT_WORKFLOW_START, event.side, event.value);
+    break;
+  case APP_EVENT_WORKFLOW_STOP:
+    telemetryRecord(EVT_WORKFLOW_STOP, event.side, event.value);
+    break;
+  default:
+    break;
+  }
+}
+
+// Telemetry keeps every event with its own timestamp, so it takes them as published
+void telemetrySubscribeEvents()
+{
+  eventBusSubscribe(APP_EVENT_BIT(APP_EVENT_FLUSH) | APP_EVENT_BIT(APP_EVENT_WASTE_DOSE) |
+      APP_EVENT_BIT(APP_EVENT_CYCLE_COMPLETE) | APP_EVENTS_WORKFLOW,
+    recordAppEvent);
+}
+
+bool telemetryFlushDue()
+{
+  if (batchingPaused)
+    return false;
+  uint32_t pending = pendingEvents();
+  if (pending == 0)
+    return false;
+  if (pending >= TELEMETRY_BATCH_EVENTS)
+    return true;
+  return monoMillis() - lastFlushAtMs >= TELEMETRY_FLUSH_INTERVAL_MS;
+}
+
+int telemetryBuildBatch(char *buffer, size_t size, int maxEvents, size_t *length, uint32_t *lastSeq)
+{
+  *length = 0;
+  TelemetryEvent event;
+
+  portENTER_CRITICAL(&telemetryLock);
+  uint32_t seq = oldestSeq;
+  portEXIT_CRITICAL(&telemetryLock);
+
+  if (!copyEvent(seq, event))
+    return 0;
+  uint64_t baseMs = event.atMs;
+
+  char device[8];
+  snprintf(device, sizeof(device), "%06lx", (unsigned long)(ESP.getEfuseMac() & 0xFFFFFF));
+
+  FixedBufferPrint body(buffer, size);
+  JsonWriter json(body);
+  json.beginObject();
+  json.field(JKEY("device"), device);
+  json.field(JKEY("boot"), (unsigned long)uploadQueueBootCount());
+  json.field(JKEY("base_ms"), (unsigned long long)baseMs);
+  json.beginArray(JKEY("events"));
+
+  // Each event is appended only if it still leaves room to close the document
+  const size_t CLOSING = 2; // "]}"
+  int count = 0;
+  size_t used = body.length();
+  while (count < maxEvents && copyEvent(seq, event))
+  {
+    char entry[48];
+    int entryLength = snprintf(entry, sizeof(entry), "%s[%lu,%u,%u,%ld]", count > 0 ? "," : "",
+      (unsigned long)(event.atMs - baseMs), event.type, event.side, (long)event.value);
+    if (used + entryLength + CLOSING >= size)
+      break;
+    body.write((const uint8_t *)entry, entryLength);
+    used += entryLength;
+    *lastSeq = seq;
+    seq++;
+    count++;
+  }
+
+  json.endArray();
+  json.endObject();
+  *length = body.length();
+  return count;
+}
+
+void telemetryCommit(uint32_t lastSeq, size_t bytes)
+{
+  portENTER_CRITICAL(&telemetryLock);
+  uint32_t sent = 0;
+  if ((int32_t)(lastSeq + 1 - oldestSeq) > 0)
+  {
+    sent = lastSeq + 1 - oldestSeq;
+    oldestSeq = lastSeq + 1;
+  }
+  if (bytes > 0)
+  {
+    telemetryStats.batchesSent++;
+    telemetryStats.eventsSent += sent;
+    telemetryStats.bytesSent += bytes;
+  }
+  portEXIT_CRITICAL(&telemetryLock);
+  lastFlushAtMs = monoMillis();
+}
+
+void telemetryBatchFailed()
+{
+  telemetryStats.failedBatches++;
+  lastFlushAtMs = monoMillis(); // Retry on the next interval rather than every wakeup
+}
+
+void telemetrySetPaused(bool paused)
+{
+  if (paused != batchingPaused)
+    LOG_I(NET, "[TELEMETRY] Batching %s", paused ? "paused" : "resumed");
+  batchingPaused = paused;
+}
+
+void getTelemetryStats(TelemetryStats &stats)
+{
+  portENTER_CRITICAL(&telemetryLock);
+  stats = telemetryStats;
+  stats.pending = nextSeq - oldestSeq;
+  portEXIT_CRITICAL(&telemetryLock);
+}
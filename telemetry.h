@@ -0,0 +1,71 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+// Workflow event telemetry.
+// Flushes, pump doses, cycle completions, captures and errors are recorded as
+// compact fixed-size events in a RAM ring and shipped by the network task as one
+// POST to /telemetry every TELEMETRY_FLUSH_INTERVAL_MS or TELEMETRY_BATCH_EVENTS
+// events, whichever comes first. Recording is O(1) and never blocks; when the
+// server falls behind the oldest events are dropped and counted.
+//
+// Batch body:
+//   {"device":"a1b2c3","boot":12,"base_ms":123456,"events":[[dt_ms,type,side,value],...]}
+// where dt_ms is relative to base_ms and type is a TelemetryEventType value.
+
+#define TELEMETRY_RING_CAPACITY 192
+#define TELEMETRY_BATCH_EVENTS 100
+#define TELEMETRY_FLUSH_INTERVAL_MS 30000
+#define TELEMETRY_BATCH_BUFFER_SIZE 2048 // Room for a full batch
+
+enum TelemetryEventType : uint8_t
+{
+  EVT_FLUSH = 1,           // value: side flush count
+  EVT_PUMP_DOSE = 2,       // value: ml dosed
+  EVT_CYCLE_COMPLETE = 3,  // value: completed cycle number
+  EVT_WORKFLOW_START = 4,
+  EVT_WORKFLOW_STOP = 5,
+  EVT_CAPTURE_OK = 6,      // value: capture id
+  EVT_CAPTURE_DEFERRED = 7, // value: capture id
+  EVT_CAPTURE_FAILED = 8,  // value: HTTP code
+  EVT_CAPTURE_DROPPED = 9  // value: capture id (request queue full)
+};
+
+#define TELEMETRY_SIDE_NONE 2 // For events not tied to Left (0) / Right (1)
+
+struct TelemetryEvent
+{
+  uint64_t atMs;   // monoMillis() when recorded
+  uint32_t seq;    // Monotonic per boot - lets the sender commit exactly what it sent
+  int32_t value;
+  uint8_t type;
+  uint8_t side;
+};
+
+struct TelemetryStats
+{
+  uint32_t recorded;
+  uint32_t dropped;        // Overwritten before they could be sent
+  uint32_t backpressure;   // Records made while the ring was over 3/4 full
+  uint32_t batchesSent;
+  uint32_t eventsSent;
+  uint32_t bytesSent;
+  uint32_t failedBatches;
+  uint16_t pending;
+};
+
+void telemetryRecord(TelemetryEventType type, uint8_t side, int32_t value); // Any task, non-blocking
+void telemetrySubscribeEvents(); // Record workflow events published on the event bus
+bool telemetryFlushDue();  // Batch full or interval elapsed with events pending, and not paused
+
+// Serialize up to maxEvents of the oldest pending events into buffer as a batch body.
+// Returns the number of events written; *length receives the body size and *lastSeq
+// the seq to pass to telemetryCommit() once the server has accepted the batch.
+int telemetryBuildBatch(char *buffer, size_t size, int maxEvents, size_t *length, uint32_t *lastSeq);
+void telemetryCommit(uint32_t lastSeq, size_t bytes); // Release events up to lastSeq (bytes 0: spilled, not sent)
+void telemetryBatchFailed();
+void telemetrySetPaused(bool paused); // Memory governor: hold batches, keep recording into the ring
+void getTelemetryStats(TelemetryStats &stats);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,12 @@
+#include "time_base.h"
+#include "esp_timer.h"
+
+uint64_t monoMicros()
+{
+  return (uint64_t)esp_timer_get_time() + (MONO_CLOCK_START_OFFSET_MS * 1000ULL);
+}
+
+uint64_t monoMillis()
+{
+  return monoMicros() / 1000ULL;
+}
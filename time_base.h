@@ -0,0 +1,22 @@
+#ifndef TIME_BASE_H
+#define TIME_BASE_H
+
+#include <Arduino.h>
+
+// Monotonic 64-bit time base built on esp_timer.
+// millis() is a 32-bit counter that wraps after ~49.7 days, which breaks every
+// "start + delay" comparison on long soak runs. esp_timer counts microseconds
+// since boot in 64 bits and will not wrap for the lifetime of the device, so all
+// scheduling, timers and duration strings use this clock instead.
+
+// Set to a non-zero value at build time to start the clock just short of the
+// old 32-bit millis() rollover (e.g. -DMONO_CLOCK_START_OFFSET_MS=4294900000)
+// so a rig crosses the former wrap boundary within a couple of minutes.
+#ifndef MONO_CLOCK_START_OFFSET_MS
+#define MONO_CLOCK_START_OFFSET_MS 0ULL
+#endif
+
+uint64_t monoMicros(); // Microseconds since boot (plus start offset)
+uint64_t monoMillis(); // Milliseconds since boot (plus start offset)
+
+#endif // TIME_BASE_H
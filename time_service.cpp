@@ -0,0 +1,179 @@
+#include "time_service.h"
+#include "time_base.h"
+#include "log_service.h"
+#include "esp_sntp.h"
+#include "freertos/FreeRTOS.h"
+#include <time.h>
+#include <sys/time.h>
+
+// Wall clock = monoMicros() + wallOffsetUs, valid once timeSynced is set
+static portMUX_TYPE timeLock = portMUX_INITIALIZER_UNLOCKED;
+static int64_t wallOffsetUs = 0;
+static volatile bool timeSynced = false;
+
+// Cached date/time prefix for the current wall-clock second
+static int64_t cachedSecond = -1;
+static char cachedPrefix[16];
+
+// Copies of early log lines: packed [uint64_t monoUs][uint16_t length][text] records.
+// Only the log task touches them.
+static uint8_t restampBuffer[TIME_LOG_RESTAMP_BUFFER_SIZE];
+static size_t restampUsed = 0;
+static int restampSkipped = 0; // Lines that did not fit
+static bool restampDone = false;
+
+static void onTimeSync(struct timeval *tv)
+{
+  int64_t wallUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+  int64_t offset = wallUs - (int64_t)monoMicros();
+
+  portENTER_CRITICAL(&timeLock);
+  wallOffsetUs = offset;
+  cachedSecond = -1; // Re-sync may step the clock
+  portEXIT_CRITICAL(&timeLock);
+  timeSynced = true;
+}
+
+void timeServiceBegin()
+{
+  sntp_set_time_sync_notification_cb(onTimeSync);
+}
+
+bool timeServiceSynced()
+{
+  return timeSynced;
+}
+
+bool monoToWallMicros(uint64_t monoUs, int64_t *wallUs)
+{
+  if (!timeSynced)
+    return false;
+  portENTER_CRITICAL(&timeLock);
+  *wallUs = (int64_t)monoUs + wallOffsetUs;
+  portEXIT_CRITICAL(&timeLock);
+  return true;
+}
+
+// Seconds the local time zone (as set by configTime) is ahead of UTC
+int32_t localUtcOffsetSeconds(time_t now)
+{
+  struct tm local;
+  struct tm utc;
+  localtime_r(&now, &local);
+  gmtime_r(&now, &utc);
+  int32_t days = local.tm_yday - utc.tm_yday;
+  if (local.tm_year != utc.tm_year)
+    days = (local.tm_year > utc.tm_year) ? 1 : -1;
+  return days * 86400 + (local.tm_hour - utc.tm_hour) * 3600 + (local.tm_min - utc.tm_min) * 60 + (local.tm_sec - utc.tm_sec);
+}
+
+void formatLogTimestamp(uint64_t monoUs, char *out, size_t size)
+{
+  int64_t wallUs;
+  if (!monoToWallMicros(monoUs, &wallUs))
+  {
+    // Uptime stamp with an obviously invalid date
+    uint64_t ms = monoUs / 1000;
+    uint32_t seconds = (uint32_t)(ms / 1000);
+    snprintf(out, size, "000000.%02lu:%02lu:%02lu.%03lu", (unsigned long)(seconds / 3600 % 100),
+      (unsigned long)(seconds / 60 % 60), (unsigned long)(seconds % 60), (unsigned long)(ms % 1000));
+    return;
+  }
+
+  int64_t second = wallUs / 1000000LL;
+  unsigned long millisPart = (unsigned long)((wallUs / 1000) % 1000);
+  char prefix[16];
+
+  portENTER_CRITICAL(&timeLock);
+  bool hit = (second == cachedSecond);
+  if (hit)
+    memcpy(prefix, cachedPrefix, sizeof(prefix));
+  portEXIT_CRITICAL(&timeLock);
+
+  if (!hit)
+  {
+    // One localtime_r per second, shared by every line in that second
+    time_t t = (time_t)second;
+    struct tm timeinfo;
+    localtime_r(&t, &timeinfo);
+    snprintf(prefix, sizeof(prefix), "%02d%02d%02d.%02d:%02d:%02d", (timeinfo.tm_year + 1900) % 100,
+      timeinfo.tm_mon + 1, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+
+    portENTER_CRITICAL(&timeLock);
+    memcpy(cachedPrefix, prefix, sizeof(prefix));
+    cachedSecond = second;
+    portEXIT_CRITICAL(&timeLock);
+  }
+
+  snprintf(out, size, "%s.%03lu", prefix, millisPart);
+}
+
+static void printLine(const char *stamp, const char *text, int length)
+{
+  char line[320];
+  int written = snprintf(line, sizeof(line), "%s - %.*s\r\n", stamp, length, text);
+  logWriteOutput((const uint8_t *)line, min((size_t)written, sizeof(line) - 1));
+}
+
+// Print every kept line again with its wall-clock timestamp
+static void printRestampedLines()
+{
+  char stamp[24];
+  char summary[96];
+  formatLogTimestamp(monoMicros(), stamp, sizeof(stamp));
+  snprintf(summary, sizeof(summary), "[TIME] SNTP synced - early log lines re-stamped (%d not kept):",
+    restampSkipped);
+  printLine(stamp, summary, (int)strlen(summary));
+
+  size_t offset = 0;
+  while (offset + sizeof(uint64_t) + sizeof(uint16_t) <= restampUsed)
+  {
+    uint64_t monoUs;
+    uint16_t length;
+    memcpy(&monoUs, restampBuffer + offset, sizeof(monoUs));
+    memcpy(&length, restampBuffer + offset + sizeof(monoUs), sizeof(length));
+    const char *text = (const char *)restampBuffer + offset + sizeof(monoUs) + sizeof(length);
+
+    formatLogTimestamp(monoUs, stamp, sizeof(stamp));
+    printLine(stamp, text, (int)length);
+    offset += sizeof(monoUs) + sizeof(length) + length;
+  }
+}
+
+void keepEarlyLogLine(uint64_t monoUs, const char *line)
+{
+  if (restampDone || timeSynced)
+    return;
+
+  size_t length = strlen(line);
+  size_t needed = sizeof(uint64_t) + sizeof(uint16_t) + length;
+  if (restampUsed + needed > sizeof(restampBuffer))
+  {
+    restampSkipped++;
+    return;
+  }
+
+  uint16_t storedLength = (uint16_t)length;
+  memcpy(restampBuffer + restampUsed, &monoUs, sizeof(monoUs));
+  memcpy(restampBuffer + restampUsed + sizeof(monoUs), &storedLength, sizeof(storedLength));
+  memcpy(restampBuffer + restampUsed + sizeof(monoUs) + sizeof(storedLength), line, length);
+  restampUsed += needed;
+}
+
+void serviceEarlyLogLines()
+{
+  if (restampDone)
+    return;
+
+  if (timeSynced)
+  {
+    if (restampUsed > 0)
+      printRestampedLines();
+  }
+  else if (monoMillis() - MONO_CLOCK_START_OFFSET_MS < TIME_LOG_RESTAMP_MAX_MS)
+  {
+    return;
+  }
+  restampUsed = 0;
+  restampDone = true;
+}
@@ -0,0 +1,34 @@
+#ifndef TIME_SERVICE_H
+#define TIME_SERVICE_H
+
+#include <Arduino.h>
+#include <time.h>
+
+// Wall-clock time service.
+// SNTP runs in the background; its sync callback records the offset between the
+// monotonic clock (time_base.h) and UTC, so any monoMicros() reading - including
+// ones taken before the sync - can be turned into wall time. Log lines written
+// before the first sync print at once with uptime stamps; a copy is kept in a fixed
+// buffer and printed again retro-stamped as soon as the offset is known.
+// Timestamps come from a per-second cached "YYMMDD.HH:MM:SS" prefix, so at most
+// one localtime_r() per second instead of one per log line.
+
+#define TIME_LOG_RESTAMP_BUFFER_SIZE 4096 // Bytes of early log text kept until sync
+#define TIME_LOG_RESTAMP_MAX_MS 60000     // Give up on re-stamping if SNTP has not synced by then
+
+void timeServiceBegin();        // Register the SNTP callback - call before configTime()
+bool timeServiceSynced();
+bool monoToWallMicros(uint64_t monoUs, int64_t *wallUs); // false until synced
+int32_t localUtcOffsetSeconds(time_t now);                // Local zone (as set by configTime) minus UTC
+
+// "YYMMDD.HH:MM:SS.zzz" for the given monotonic time. Before sync the date reads
+// 000000 and the time is uptime, so early lines can never look like 1970.
+void formatLogTimestamp(uint64_t monoUs, char *out, size_t size);
+
+// Log task only. keepEarlyLogLine() copies a line that was just printed with an uptime
+// stamp; serviceEarlyLogLines() runs every pass, busy or idle, and prints the copies
+// retro-stamped once SNTP has synced (or drops them when the deadline passes).
+void keepEarlyLogLine(uint64_t monoUs, const char *line);
+void serviceEarlyLogLines();
+
+#endif // TIME_SERVICE_H
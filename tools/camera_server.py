@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Local stand-in for the camera upload server, with slow and failing modes.
+
+Usage:
+  python3 tools/camera_server.py [--port 5000] [--delay S] [--fail-every N] [--fail-code CODE]
+                                 [--down-for S] [--no-batch] [--accept N]
+
+Point uploadServerURL at this machine (any path on the same host:port). Routes:
+  POST /queue_camera   {"request_id":..,"camera_id":..,"image_prefix":..,"flip_vertical":..}
+  POST /queue_cameras  {"request_id":..,"station":"LFT","cameras":[{"camera_id":..},..]}
+                       answered {"status":"queued","accepted":N}
+  POST /telemetry      event batches - logged and accepted
+Every accepted camera is printed with its Idempotency-Key; a key seen before is
+answered 200 again but reported as a duplicate, so retries that would double-count
+captures on a real server stand out.
+
+Modes (combine freely):
+  --delay S        sleep S seconds before every answer (timeouts, a blocked network task)
+  --fail-every N   answer every Nth request with --fail-code instead of accepting it
+  --fail-code CODE status for injected failures (default 503; try 429, 400, 500)
+  --down-for S     answer --fail-code to everything for the first S seconds (an outage
+                   the durable upload queue has to ride out)
+  --no-batch       answer 404 on /queue_cameras, as servers without the batch route do
+  --accept N       accept at most N new cameras per batch POST; a retry with the same
+                   request_id picks up the rest, so a short "accepted" count must be retried
+Ctrl-C prints totals per route and status.
+"""
+import http.server
+import json
+import sys
+import threading
+import time
+import urllib.parse
+
+
+class Config:
+    delay = 0.0
+    fail_every = 0
+    fail_code = 503
+    down_until = 0.0
+    no_batch = False
+    accept_limit = 0
+
+
+class Totals:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.requests = 0
+        self.by_status = {}
+        self.cameras = 0
+        self.duplicates = 0
+        self.keys = set()
+        self.batches = {}  # request_id -> camera indices accepted so far
+
+    def count(self, route, status):
+        with self.lock:
+            key = "%s %d" % (route, status)
+            self.by_status[key] = self.by_status.get(key, 0) + 1
+
+    def next_request(self):
+        with self.lock:
+            self.requests += 1
+            return self.requests
+
+    def accept(self, key):
+        with self.lock:
+            self.cameras += 1
+            if key and key in self.keys:
+                self.duplicates += 1
+                return True
+            if key:
+                self.keys.add(key)
+            return False
+
+    def accept_batch(self, request_id, count, limit):
+        with self.lock:
+            done = self.batches.setdefault(request_id, set())
+            fresh = [i for i in range(count) if i not in done]
+            if limit > 0:
+                fresh = fresh[:limit]
+            done.update(fresh)
+            self.cameras += len(fresh)
+            return len(done), len(fresh)
+
+
+totals = Totals()
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # Keep-alive, like the firmware's upload connection
+
+    def log_message(self, fmt, *args):
+        sys.stderr.write("%s %s\n" % (self.address_string(), fmt % args))
+
+    def reply(self, route, status, document=None):
+        body = json.dumps(document, separators=(",", ":")).encode() if document is not None else b""
+        self.send_response(status)
+        if body:
+            self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+        totals.count(route, status)
+
+    def read_body(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        try:
+            return json.loads(self.rfile.read(length) or b"null")
+        except ValueError:
+            return None
+
+    def injected_failure(self, number):
+        if time.monotonic() < Config.down_until:
+            return True
+        return Config.fail_every > 0 and number % Config.fail_every == 0
+
+    def do_POST(self):
+        route = urllib.parse.urlsplit(self.path).path.rstrip("/").rsplit("/", 1)[-1]
+        body = self.read_body()
+        number = totals.next_request()
+        if Config.delay:
+            time.sleep(Config.delay)
+        if self.injected_failure(number):
+            self.log_message("#%d %s -> injected %d", number, route, Config.fail_code)
+            return self.reply(route, Config.fail_code, {"status": "error", "message": "injected failure"})
+        handler = getattr(self, "route_" + route, None)
+        if handler is None or not isinstance(body, dict):
+            return self.reply(route, 404 if handler is None else 400)
+        handler(route, number, body)
+
+    def route_queue_camera(self, route, number, body):
+        key = self.headers.get("Idempotency-Key")
+        duplicate = totals.accept(key)
+        self.log_message("#%d camera %s prefix %s key %s%s", number, body.get("camera_id"),
+                         body.get("image_prefix"), key, " DUPLICATE" if duplicate else "")
+        self.reply(route, 200, {"status": "queued", "accepted": 1})
+
+    def route_queue_cameras(self, route, number, body):
+        if Config.no_batch:
+            return self.reply(route, 404)
+        cameras = body.get("cameras") or []
+        accepted, fresh = totals.accept_batch(body.get("request_id"), len(cameras), Config.accept_limit)
+        self.log_message("#%d batch %s %s: %d cameras, %d new, %d accepted", number, body.get("request_id"),
+                         body.get("station"), len(cameras), fresh, accepted)
+        self.reply(route, 200, {"status": "queued", "accepted": accepted})
+
+    def route_telemetry(self, route, number, body):
+        events = body.get("events") or []
+        self.log_message("#%d telemetry: %d events from %s", number, len(events), body.get("device"))
+        self.reply(route, 200, {"status": "ok"})
+
+
+def option(args, name, default, kind):
+    return kind(args[args.index(name) + 1]) if name in args else default
+
+
+def main():
+    args = sys.argv[1:]
+    if "-h" in args or "--help" in args:
+        print(__doc__)
+        return
+    port = option(args, "--port", 5000, int)
+    Config.delay = option(args, "--delay", 0.0, float)
+    Config.fail_every = option(args, "--fail-every", 0, int)
+    Config.fail_code = option(args, "--fail-code", 503, int)
+    Config.no_batch = "--no-batch" in args
+    Config.accept_limit = option(args, "--accept", 0, int)
+    Config.down_until = time.monotonic() + option(args, "--down-for", 0.0, float)
+
+    server = http.server.ThreadingHTTPServer(("", port), Handler)
+    print("Camera server on port %d" % port, file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print("%d requests, %d cameras accepted (%d duplicate keys)" % (totals.requests, totals.cameras,
+                                                                     totals.duplicates), file=sys.stderr)
+    for key in sorted(totals.by_status):
+        print("  %-24s %d" % (key, totals.by_status[key]), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
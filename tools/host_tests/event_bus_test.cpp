@@ -0,0 +1,127 @@
+// Event bus: event subscribers see every event in order, frame subscribers get one
+// call per frame with the union of what happened, events published from a frame
+// handler land in the next frame, and the coalescing statistics add up.
+// sources: event_bus.cpp
+
+#include "host_test.h"
+#include "event_bus.h"
+#include <vector>
+
+static const uint8_t NO_SIDE = 2; // TELEMETRY_SIDE_NONE
+
+static std::vector<AppEvent> seenEvents;
+static std::vector<uint32_t> counterFrames;
+static std::vector<uint32_t> workflowFrames;
+static std::vector<uint32_t> chainedFrames;
+
+static void onEvent(const AppEvent &event)
+{
+  seenEvents.push_back(event);
+}
+
+static void onCounterFrame(uint32_t events)
+{
+  counterFrames.push_back(events);
+}
+
+static void onWorkflowFrame(uint32_t events)
+{
+  workflowFrames.push_back(events);
+}
+
+// Reacts to a workflow stop by publishing a counter correction, as a redraw that
+// bumps a counter would
+static void onChainedFrame(uint32_t events)
+{
+  chainedFrames.push_back(events);
+  if (events & APP_EVENT_BIT(APP_EVENT_WORKFLOW_STOP))
+    eventPublish(APP_EVENT_COUNTS_CORRECTED, 1, 42);
+}
+
+static void clearSeen()
+{
+  seenEvents.clear();
+  counterFrames.clear();
+  workflowFrames.clear();
+  chainedFrames.clear();
+}
+
+static void noFrame(uint32_t) {}
+
+int main()
+{
+  CHECK(eventBusSubscribe(APP_EVENTS_ALL, onEvent));
+  CHECK(eventBusSubscribeFrame(APP_EVENTS_COUNTERS, onCounterFrame));
+  CHECK(eventBusSubscribeFrame(APP_EVENTS_WORKFLOW, onWorkflowFrame));
+  CHECK(eventBusSubscribeFrame(APP_EVENT_BIT(APP_EVENT_WORKFLOW_STOP), onChainedFrame));
+
+  // A burst in one loop pass: every event delivered, one call per frame subscriber
+  eventPublish(APP_EVENT_FLUSH, 0, 1);
+  eventPublish(APP_EVENT_WASTE_DOSE, 0, 50);
+  eventPublish(APP_EVENT_FLUSH, 1, 1);
+  eventPublish(APP_EVENT_IMAGE, 0, 3);
+  eventPublish(APP_EVENT_CYCLE_COMPLETE, NO_SIDE, 7);
+  CHECK_EQ(seenEvents.size(), 5);
+  CHECK_EQ(seenEvents[1].type, APP_EVENT_WASTE_DOSE);
+  CHECK_EQ(seenEvents[1].value, 50);
+  CHECK_EQ(seenEvents[2].side, 1);
+  CHECK(counterFrames.empty()); // Nothing until the frame closes
+
+  eventBusDispatchFrame();
+  CHECK_EQ(counterFrames.size(), 1);
+  CHECK_EQ(counterFrames[0],
+    APP_EVENT_BIT(APP_EVENT_FLUSH) | APP_EVENT_BIT(APP_EVENT_WASTE_DOSE) | APP_EVENT_BIT(APP_EVENT_IMAGE));
+  CHECK(workflowFrames.empty()); // Masked out: no call at all
+  CHECK(chainedFrames.empty());
+
+  EventBusStats stats;
+  getEventBusStats(stats);
+  CHECK_EQ(stats.published, 5);
+  CHECK_EQ(stats.frameCalls, 1);
+  CHECK_EQ(stats.coalesced, 3); // Four counter events, one call
+
+  // A quiet frame calls nobody
+  clearSeen();
+  eventBusDispatchFrame();
+  CHECK(counterFrames.empty());
+
+  // An event published by a frame handler is seen at once by event subscribers but
+  // goes to frame subscribers in the next frame, not a re-run of this one
+  clearSeen();
+  eventPublish(APP_EVENT_WORKFLOW_STOP, NO_SIDE, 0);
+  eventBusDispatchFrame();
+  CHECK_EQ(workflowFrames.size(), 1);
+  CHECK_EQ(chainedFrames.size(), 1);
+  CHECK_EQ(seenEvents.size(), 2);
+  CHECK_EQ(seenEvents[1].type, APP_EVENT_COUNTS_CORRECTED);
+  CHECK(counterFrames.empty()); // Its subscriber was already dispatched this frame
+  eventBusDispatchFrame();
+  CHECK_EQ(counterFrames.size(), 1);
+  CHECK_EQ(counterFrames[0], APP_EVENT_BIT(APP_EVENT_COUNTS_CORRECTED));
+  CHECK_EQ(chainedFrames.size(), 1); // Not re-triggered
+
+  // A long run: 100 frames of 3 flushes each cost 100 refreshes, not 300
+  getEventBusStats(stats);
+  uint32_t callsBefore = stats.frameCalls;
+  uint32_t coalescedBefore = stats.coalesced;
+  clearSeen();
+  for (int frame = 0; frame < 100; frame++)
+  {
+    for (int i = 0; i < 3; i++)
+      eventPublish(APP_EVENT_FLUSH, i & 1, frame * 3 + i);
+    eventBusDispatchFrame();
+  }
+  getEventBusStats(stats);
+  CHECK_EQ(counterFrames.size(), 100);
+  CHECK_EQ(seenEvents.size(), 300);
+  CHECK_EQ(stats.frameCalls - callsBefore, 100);
+  CHECK_EQ(stats.coalesced - coalescedBefore, 200);
+
+  // The table holds EVENT_BUS_MAX_SUBSCRIBERS
+  for (int i = 4; i < EVENT_BUS_MAX_SUBSCRIBERS; i++)
+    CHECK(eventBusSubscribeFrame(APP_EVENTS_ALL, noFrame));
+  CHECK(!eventBusSubscribeFrame(APP_EVENTS_ALL, noFrame));
+  CHECK(!eventBusSubscribe(APP_EVENTS_ALL, onEvent));
+
+  return hostTestResult("event_bus");
+}
@@ -0,0 +1,156 @@
+// Host implementations of the stubbed Arduino/ESP-IDF calls, shared by every test
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <Preferences.h>
+#include <LittleFS.h>
+#include "freertos/queue.h"
+#include <deque>
+#include "log_service.h"
+#include <stdarg.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int hostTestFailures = 0;
+int64_t hostClockUs = 0;
+
+int hostTestResult(const char *name)
+{
+  printf("%s %s\n", hostTestFailures ? "FAIL" : "PASS", name);
+  return hostTestFailures ? 1 : 0;
+}
+
+int64_t esp_timer_get_time()
+{
+  return hostClockUs;
+}
+
+unsigned long millis()
+{
+  return (unsigned long)(hostClockUs / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)hostClockUs;
+}
+
+void delay(unsigned long ms)
+{
+  hostAdvanceMillis(ms);
+}
+
+uint8_t logRuntimeLevel[LOG_CATEGORY_COUNT] = {}; // Everything compiled in reaches writeLog()
+
+// Log lines are only shown with HOST_TEST_VERBOSE set
+void writeLog(const char *format, ...)
+{
+  if (!getenv("HOST_TEST_VERBOSE"))
+    return;
+  va_list args;
+  va_start(args, format);
+  printf("  log: ");
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+}
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+uint32_t hostFreeHeap = 200000;
+uint32_t hostMinFreeHeap = UINT32_MAX; // Low-water mark - tests lower it for a dip between samples
+
+EspClass ESP;
+uint32_t EspClass::getHeapSize() { return 320000; }
+uint32_t EspClass::getFreeHeap() { return hostFreeHeap; }
+uint32_t EspClass::getMinFreeHeap()
+{
+  hostMinFreeHeap = min(hostMinFreeHeap, hostFreeHeap);
+  return hostMinFreeHeap;
+}
+uint32_t EspClass::getMaxAllocHeap() { return hostFreeHeap / 2; }
+uint64_t EspClass::getEfuseMac() { return 0xA1B2C3D4E5F6ULL; }
+
+uint32_t esp_random()
+{
+  return (uint32_t)rand();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *handle,
+  BaseType_t)
+{
+  static int fakeTask;
+  if (handle)
+    *handle = &fakeTask;
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdPASS; }
+void vTaskDelay(TickType_t ticks) { hostAdvanceMillis(ticks); }
+
+std::map<std::string, std::vector<uint8_t>> hostNvs;
+
+struct HostQueue
+{
+  size_t length;
+  size_t itemSize;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+  return new HostQueue{ length, itemSize, {} };
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void *item, TickType_t)
+{
+  HostQueue *queue = (HostQueue *)handle;
+  if (queue->items.size() >= queue->length)
+    return pdFALSE;
+  queue->items.emplace_back((const uint8_t *)item, (const uint8_t *)item + queue->itemSize);
+  return pdTRUE;
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t handle, const void *item)
+{
+  ((HostQueue *)handle)->items.clear();
+  return xQueueSend(handle, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void *item, TickType_t)
+{
+  HostQueue *queue = (HostQueue *)handle;
+  if (queue->items.empty())
+    return pdFALSE;
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle)
+{
+  return (UBaseType_t)((HostQueue *)handle)->items.size();
+}
+
+LittleFSFS LittleFS;
+std::string hostFsRoot;
+bool hostFsFailWrites = false;
+
+// One directory per process, made on first use; forked scenarios share their parent's
+std::string hostFsPath(const char *path)
+{
+  if (hostFsRoot.empty())
+  {
+    const char *tmp = getenv("TMPDIR");
+    hostFsRoot = std::string(tmp ? tmp : "/tmp") + "/sani_host_fs_" + std::to_string(getpid());
+    mkdir(hostFsRoot.c_str(), 0700);
+  }
+  return hostFsRoot + path;
+}
@@ -0,0 +1,43 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// Minimal check macros for the host tests - no framework to install.
+// CHECK() records a failure and carries on so one run reports every broken case.
+
+#include <stdint.h>
+#include <stdio.h>
+
+extern int hostTestFailures;
+
+#define CHECK(condition)                                                  \
+  do                                                                      \
+  {                                                                       \
+    if (!(condition))                                                     \
+    {                                                                     \
+      printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      hostTestFailures++;                                                 \
+    }                                                                     \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                               \
+  do                                                                                             \
+  {                                                                                              \
+    long long actualValue = (long long)(actual);                                                 \
+    long long expectedValue = (long long)(expected);                                             \
+    if (actualValue != expectedValue)                                                            \
+    {                                                                                            \
+      printf("  %s:%d: %s = %lld, expected %lld\n", __FILE__, __LINE__, #actual, actualValue,    \
+        expectedValue);                                                                          \
+      hostTestFailures++;                                                                        \
+    }                                                                                            \
+  } while (0)
+
+// Prints the verdict line; return it from main()
+int hostTestResult(const char *name);
+
+// Fake clock behind esp_timer_get_time() (and so monoMicros()/monoMillis())
+extern int64_t hostClockUs;
+inline void hostAdvanceMicros(int64_t us) { hostClockUs += us; }
+inline void hostAdvanceMillis(int64_t ms) { hostClockUs += ms * 1000; }
+
+#endif // HOST_TEST_H
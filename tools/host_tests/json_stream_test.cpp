@@ -0,0 +1,174 @@
+// JsonWriter/JsonReader round trips and edge cases, then a rough host benchmark of
+// the status-sized documents the firmware writes and the responses it parses.
+// Benchmark figures are host nanoseconds - compare runs, not against the ESP32.
+// sources:
+
+#include "host_test.h"
+#include "json_stream.h"
+#include <chrono>
+
+static const int BENCH_ITERATIONS = 200000;
+
+// Roughly the shape and size of a /status document
+static size_t writeStatusDocument(char *buffer, size_t size)
+{
+  FixedBufferPrint out(buffer, size);
+  JsonWriter json(out);
+  json.beginObject();
+  json.field(JKEY("device"), "sani-flush-01");
+  json.field(JKEY("uptime_ms"), (unsigned long long)987654321ULL);
+  json.field(JKEY("left_flushes"), 1234);
+  json.field(JKEY("right_flushes"), 987);
+  json.field(JKEY("waste_ml"), (unsigned long)45000);
+  json.field(JKEY("workflow_active"), true);
+  json.field(JKEY("last_error"), "timeout \"queue_cameras\"\n");
+  json.beginObject(JKEY("memory"));
+  json.field(JKEY("free"), 183456);
+  json.field(JKEY("largest"), 110592);
+  json.field(JKEY("trend_bytes_per_hour"), (long)-120);
+  json.endObject();
+  json.beginArray(JKEY("cameras"));
+  for (int i = 0; i < 4; i++)
+  {
+    json.beginObject();
+    json.field(JKEY("camera_id"), "CAM-LFT-01");
+    json.field(JKEY("status"), i);
+    json.endObject();
+  }
+  json.endArray();
+  json.fieldNull(JKEY("settings_etag"));
+  json.endObject();
+  return out.overflow() ? 0 : json.bytesWritten();
+}
+
+static const char RESPONSE[] =
+  "{\"status\":\"queued\",\"queue\":{\"depth\":3,\"workers\":[1,2,{\"id\":7}]},"
+  "\"message\":\"ok \\\"fine\\\" \\u0041\",\"accepted\": 2 ,\"etag\":\"abc\"}";
+
+template <typename Body>
+static void bench(const char *name, Body body)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_ITERATIONS; i++)
+    body();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_ITERATIONS;
+  printf("  bench %-28s %8.1f ns/op\n", name, ns);
+}
+
+int main()
+{
+  // Writer: escaping, numbers at their limits, nesting and separators
+  char buffer[512];
+  {
+    FixedBufferPrint out(buffer, sizeof(buffer));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field(JKEY("a"), -5);
+    json.field(JKEY("s"), "q\"x\n\x01");
+    json.beginArray(JKEY("arr"));
+    json.value(3);
+    json.value((long)-2147483647 - 1);
+    json.beginObject();
+    json.field(JKEY("b"), true);
+    json.endObject();
+    json.endArray();
+    json.field(JKEY("u"), 18446744073709551615ULL);
+    json.fieldNull(JKEY("n"));
+    json.endObject();
+    CHECK(strcmp(buffer, "{\"a\":-5,\"s\":\"q\\\"x\\n\\u0001\",\"arr\":[3,-2147483648,{\"b\":true}],"
+                         "\"u\":18446744073709551615,\"n\":null}") == 0);
+    CHECK_EQ(json.bytesWritten(), strlen(buffer));
+    CHECK(!out.overflow());
+  }
+
+  // Overflow truncates, stays NUL-terminated and is reported
+  {
+    char small[8];
+    FixedBufferPrint out(small, sizeof(small));
+    JsonWriter json(out);
+    json.beginObject();
+    json.field(JKEY("key"), "long value");
+    json.endObject();
+    CHECK(out.overflow());
+    CHECK_EQ(strlen(small), sizeof(small) - 1);
+  }
+
+  // Reader: findKey skips nested values; strings are unescaped in place
+  {
+    char input[sizeof(RESPONSE)];
+    memcpy(input, RESPONSE, sizeof(RESPONSE));
+    JsonReader reader(input, strlen(input));
+    CHECK(reader.findKey("accepted"));
+    CHECK_EQ(reader.next(), JSON_NUMBER);
+    CHECK_EQ(reader.asLong(), 2);
+    CHECK(reader.findKey("etag"));
+    CHECK_EQ(reader.next(), JSON_STRING);
+    CHECK(strcmp(reader.text(), "abc") == 0);
+
+    memcpy(input, RESPONSE, sizeof(RESPONSE));
+    JsonReader again(input, strlen(input));
+    CHECK(again.findKey("message"));
+    CHECK_EQ(again.next(), JSON_STRING);
+    CHECK(strcmp(again.text(), "ok \"fine\" A") == 0);
+  }
+
+  // Token stream of a mixed array
+  {
+    char input[] = "[1, -2.5e3, \"a\", {\"k\": null}, true, false]";
+    JsonReader reader(input, strlen(input));
+    const JsonToken expected[] = { JSON_BEGIN_ARRAY, JSON_NUMBER, JSON_NUMBER, JSON_STRING, JSON_BEGIN_OBJECT,
+      JSON_KEY, JSON_NULL, JSON_END_OBJECT, JSON_TRUE, JSON_FALSE, JSON_END_ARRAY, JSON_END };
+    for (JsonToken token : expected)
+      CHECK_EQ(reader.next(), token);
+  }
+
+  // A number must stop at a NUL inside the buffer: strchr() matches the terminator,
+  // which used to carry the reader past the end of the text into stale bytes
+  {
+    char input[] = { '[', '7', '\0', '\0', ',', '8', ']' };
+    JsonReader reader(input, sizeof(input));
+    CHECK_EQ(reader.next(), JSON_BEGIN_ARRAY);
+    CHECK_EQ(reader.next(), JSON_NUMBER);
+    CHECK_EQ(reader.asLong(), 7);
+    CHECK_EQ(reader.next(), JSON_ERROR); // Unterminated array, not the stale 8
+  }
+
+  // Truncated and malformed input
+  {
+    char truncated[] = "{\"accepted\":";
+    JsonReader reader(truncated, strlen(truncated));
+    CHECK(reader.findKey("accepted"));
+    CHECK_EQ(reader.next(), JSON_ERROR);
+
+    char garbage[] = "{\"a\" 1}";
+    JsonReader bad(garbage, strlen(garbage));
+    CHECK_EQ(bad.next(), JSON_BEGIN_OBJECT);
+    CHECK_EQ(bad.next(), JSON_ERROR);
+    CHECK_EQ(bad.next(), JSON_ERROR); // Sticky
+  }
+
+  size_t statusLength = writeStatusDocument(buffer, sizeof(buffer));
+  CHECK(statusLength > 0);
+  printf("  status document: %u bytes\n", (unsigned)statusLength);
+
+  volatile size_t sink = 0;
+  bench("write status document", [&]() { sink += writeStatusDocument(buffer, sizeof(buffer)); });
+  bench("findKey accepted", [&]() {
+    char input[sizeof(RESPONSE)];
+    memcpy(input, RESPONSE, sizeof(RESPONSE));
+    JsonReader reader(input, sizeof(RESPONSE) - 1);
+    if (reader.findKey("accepted") && reader.next() == JSON_NUMBER)
+      sink += reader.asLong();
+  });
+  bench("tokenize status document", [&]() {
+    char input[512];
+    memcpy(input, buffer, statusLength + 1);
+    JsonReader reader(input, statusLength);
+    while (reader.next() < JSON_END)
+      sink++;
+  });
+  (void)sink;
+
+  return hostTestResult("json_stream");
+}
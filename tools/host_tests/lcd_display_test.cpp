@@ -0,0 +1,131 @@
+// LCD shadow-buffer driver against an emulated panel: what it shows after every
+// update, that lcdBytes matches the bytes actually sent, and the run rules - one
+// cursor move per changed run, gaps of one unchanged character merged, the move
+// skipped when the cursor is already in place, and never a clear after init.
+// sources: lcd_display.cpp heap_tags.cpp time_base.cpp
+
+#include "host_test.h"
+#include "lcd_display.h"
+#include <LiquidCrystal_I2C.h>
+
+LiquidCrystal_I2C lcd(0x27, LCD_COLS, LCD_ROWS);
+
+static const uint32_t FULL_REWRITE_BYTES = 1 + LCD_ROWS * (1 + LCD_COLS); // clear, then each row
+
+static std::string padded(const char *text)
+{
+  std::string row(text);
+  row.resize(LCD_COLS, ' ');
+  return row;
+}
+
+struct FlushCost
+{
+  bool wrote;
+  uint32_t bytes;   // Sent to the emulated panel
+  uint32_t counted; // lcdBytes the driver accounted for
+  uint32_t moves;
+  uint32_t chars;
+};
+
+// One update, flushed straight away; checks the panel shows exactly the new text
+static FlushCost update(const char *line1, const char *line2)
+{
+  LcdStats before;
+  getLcdStats(before);
+  uint32_t sentBefore = lcd.totalBytes();
+
+  lcdSetLines(line1, line2);
+  hostAdvanceMillis(LCD_MIN_FLUSH_INTERVAL_MS);
+  FlushCost cost;
+  cost.wrote = lcdFlushNow();
+
+  LcdStats after;
+  getLcdStats(after);
+  cost.bytes = lcd.totalBytes() - sentBefore;
+  cost.counted = after.lcdBytes - before.lcdBytes;
+  cost.moves = after.cursorMoves - before.cursorMoves;
+  cost.chars = after.chars - before.chars;
+  CHECK(lcd.visibleRow(0) == padded(line1));
+  CHECK(lcd.visibleRow(1) == padded(line2));
+  CHECK_EQ(cost.counted, cost.bytes);
+  return cost;
+}
+
+int main()
+{
+  lcd.init();
+  lcdBegin();
+
+  FlushCost cost = update("SANI FLUSH 2.0", "LOADING...");
+  CHECK(cost.wrote);
+  CHECK_EQ(cost.moves, 2);
+
+  // Nothing changed: no bytes at all
+  cost = update("SANI FLUSH 2.0", "LOADING...");
+  CHECK(!cost.wrote);
+  CHECK_EQ(cost.bytes, 0);
+
+  update("G000   W0000ML", "L000 R000 I000");
+
+  // One digit: a cursor move and a character
+  cost = update("G001   W0000ML", "L000 R000 I000");
+  CHECK_EQ(cost.moves, 1);
+  CHECK_EQ(cost.chars, 1);
+
+  // Columns 2 and 4 differ with one unchanged column between: one run of 3
+  cost = update("G101   W0000ML", "L000 R000 I000");
+  cost = update("G000   W0000ML", "L000 R000 I000");
+  cost = update("G0101  W0000ML", "L000 R000 I000");
+  CHECK_EQ(cost.moves, 1);
+  CHECK_EQ(cost.chars, 3);
+
+  // Two unchanged columns between: two runs, since a move is cheaper than rewriting both
+  cost = update("G1011  W0000ML", "L000 R000 I000");
+  CHECK_EQ(cost.moves, 1);
+  update("G0000  W0000ML", "L000 R000 I000");
+  cost = update("G1001  W0000ML", "L000 R000 I000");
+  CHECK_EQ(cost.moves, 2);
+  CHECK_EQ(cost.chars, 2);
+
+  // The cursor is left after the last write; a run starting there needs no move
+  cost = update("G0000  W0000ML", "L000 R000 I000"); // Columns 1 and 4, cursor left at 5
+  CHECK_EQ(cost.moves, 2);
+  cost = update("G0000X W0000ML", "L000 R000 I000"); // Column 5
+  CHECK_EQ(cost.moves, 0);
+  CHECK_EQ(cost.chars, 1);
+  cost = update("G0000XYW0000ML", "L000 R000 I000"); // Column 6
+  CHECK_EQ(cost.moves, 0);
+  cost = update("X0000XYW0000ML", "L000 R000 I000"); // Back to column 0
+  CHECK_EQ(cost.moves, 1);
+
+  // A counter tick on each row, with the flush well under a full rewrite
+  update("G019   W0990ML", "L009 R009 I009");
+  cost = update("G020   W1000ML", "L010 R010 I010");
+  CHECK(cost.bytes < FULL_REWRITE_BYTES / 2);
+
+  // Several updates before a flush coalesce into one write of the latest text
+  LcdStats before;
+  getLcdStats(before);
+  lcdSetLines("PRESS START", "L010 R010 I010");
+  lcdSetLines("G021   W1050ML", "L011 R010 I010");
+  hostAdvanceMillis(LCD_MIN_FLUSH_INTERVAL_MS);
+  CHECK(lcdFlushNow());
+  LcdStats after;
+  getLcdStats(after);
+  CHECK_EQ(after.requests - before.requests, 2);
+  CHECK_EQ(after.flushes - before.flushes, 1);
+  CHECK(lcd.visibleRow(0) == padded("G021   W1050ML"));
+
+  // Long text is cut at 16 columns and never spills into the next row
+  update("THIS LINE IS FAR TOO LONG", "");
+  CHECK(lcd.visibleRow(0) == "THIS LINE IS FAR");
+
+  CHECK_EQ(lcd.clears, 1); // Only lcd.init()
+  LcdStats stats;
+  getLcdStats(stats);
+  CHECK_EQ(stats.lcdBytes, lcd.totalBytes() - 1);
+  CHECK(stats.lcdBytes < stats.flushes * FULL_REWRITE_BYTES / 3);
+
+  return hostTestResult("lcd_display");
+}
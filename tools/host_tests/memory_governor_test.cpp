@@ -0,0 +1,157 @@
+// Memory governor: stays normal at the series' steady-state heap, takes its baseline
+// once boot has settled, escalates level by level as free heap falls below it and
+// eases off (undoing its actions) after recovering. Each scenario runs in a forked
+// child so the module starts fresh.
+// sources: memory_governor.cpp time_base.cpp
+
+#include "host_test.h"
+#include "memory_governor.h"
+#include "log_service.h"
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern uint32_t hostFreeHeap; // host_platform.cpp - the largest block reads half of it
+
+// The rig read 248196-248256 free before the series; the new task stacks (~21 KB),
+// the log ring, flash pages, restamp buffer, telemetry ring and pools (~31 KB) put
+// the steady state near 196 KB
+static const uint32_t STEADY_FREE = 196 * 1024;
+
+// Actions the governor asks of the other modules
+bool wifiNeedsRecreation = false;
+static int connectionDrops = 0;
+static bool telemetryPaused = false;
+
+void requestConnectionDrop()
+{
+  connectionDrops++;
+}
+
+void telemetrySetPaused(bool paused)
+{
+  telemetryPaused = paused;
+}
+
+void logSetLevel(LogCategory category, uint8_t level)
+{
+  logRuntimeLevel[category] = level;
+}
+
+static MemoryGovernorStats governorStats()
+{
+  MemoryGovernorStats stats;
+  getMemoryGovernorStats(stats);
+  return stats;
+}
+
+// One loop() pass a second for the given time, free heap from the callback
+template <typename Heap>
+static void run(uint32_t seconds, Heap heap)
+{
+  for (uint32_t i = 0; i < seconds; i++)
+  {
+    hostAdvanceMillis(1000);
+    hostFreeHeap = heap();
+    serviceMemoryGovernor();
+  }
+}
+
+static void runAt(uint32_t seconds, uint32_t freeHeap)
+{
+  run(seconds, [freeHeap]() { return freeHeap; });
+}
+
+// Runs body in a child so each scenario starts from a fresh module
+static void scenario(const char *name, void (*body)())
+{
+  fflush(stdout);
+  pid_t child = fork();
+  if (child == 0)
+  {
+    hostTestFailures = 0; // Count this scenario's own failures only
+    body();
+    fflush(stdout);
+    _exit(hostTestFailures ? 1 : 0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    printf("  scenario %s failed\n", name);
+    hostTestFailures++;
+  }
+}
+
+static void steadyStateStaysNormal()
+{
+  // A day of ±4 KB jitter with a 12 KB dip for each upload every 30 s
+  std::mt19937 random(7);
+  std::uniform_int_distribution<int> jitter(-4096, 4096);
+  uint32_t second = 0;
+  run(24 * 3600, [&]() {
+    second++;
+    return STEADY_FREE + jitter(random) - (second % 30 == 0 ? 12 * 1024 : 0);
+  });
+  MemoryGovernorStats stats = governorStats();
+  CHECK_EQ(stats.level, MEM_PRESSURE_NORMAL);
+  CHECK_EQ(stats.escalations, 0);
+  CHECK(stats.baselineFree >= STEADY_FREE && stats.baselineFree <= STEADY_FREE + 4096);
+  CHECK(stats.lowestFree < 220000); // Under the old absolute CRITICAL mark all day
+  CHECK(!wifiNeedsRecreation);
+  CHECK(!telemetryPaused);
+  CHECK_EQ(connectionDrops, 0);
+}
+
+static void bootDipBeforeBaseline()
+{
+  // WiFi and TLS setup dip hard before the baseline is taken: recorded, not acted on
+  runAt(5, 250000);
+  runAt(5, 120000);
+  runAt(MEM_GOV_BASELINE_MS / 1000, STEADY_FREE);
+  MemoryGovernorStats stats = governorStats();
+  CHECK_EQ(stats.level, MEM_PRESSURE_NORMAL);
+  CHECK_EQ(stats.lowestFree, 120000);
+  CHECK_EQ(stats.baselineFree, STEADY_FREE);
+}
+
+static void escalateAndRelax()
+{
+  runAt(MEM_GOV_BASELINE_MS / 1000, STEADY_FREE);
+  CHECK_EQ(governorStats().baselineFree, STEADY_FREE);
+
+  runAt(2, STEADY_FREE - 25 * 1024);
+  CHECK_EQ(governorStats().level, MEM_PRESSURE_ELEVATED);
+  CHECK_EQ(connectionDrops, 1);
+  CHECK(logRuntimeLevel[0] >= LOG_LEVEL_WARN);
+
+  runAt(2, STEADY_FREE - 41 * 1024);
+  CHECK_EQ(governorStats().level, MEM_PRESSURE_HIGH);
+  CHECK(telemetryPaused);
+
+  runAt(2, STEADY_FREE - 57 * 1024);
+  CHECK_EQ(governorStats().level, MEM_PRESSURE_CRITICAL);
+  CHECK(wifiNeedsRecreation);
+  wifiNeedsRecreation = false; // The network task recycled
+  runAt(60, STEADY_FREE - 57 * 1024);
+  CHECK(!wifiNeedsRecreation); // Not again inside the cooldown
+  CHECK_EQ(governorStats().actions[MEM_ACTION_NETWORK_RECYCLE], 1);
+
+  // Back at the baseline: eases off to normal once clear for MEM_GOV_RELAX_MS
+  runAt(MEM_GOV_RELAX_MS / 1000 - 2, STEADY_FREE);
+  CHECK_EQ(governorStats().level, MEM_PRESSURE_CRITICAL);
+  runAt(3, STEADY_FREE);
+  MemoryGovernorStats stats = governorStats();
+  CHECK_EQ(stats.level, MEM_PRESSURE_NORMAL);
+  CHECK_EQ(stats.relaxations, 1);
+  CHECK(!telemetryPaused);
+  CHECK(logRuntimeLevel[0] < LOG_LEVEL_WARN);
+}
+
+int main()
+{
+  scenario("steady state", steadyStateStaysNormal);
+  scenario("boot dip", bootDipBeforeBaseline);
+  scenario("escalate and relax", escalateAndRelax);
+  return hostTestResult("memory_governor");
+}
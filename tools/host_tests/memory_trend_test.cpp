@@ -0,0 +1,197 @@
+// Leak-trend detector: slope recovery, t-value flagging against noise, a min-free
+// step that must not flag, the minimum-loss floor, warm-up and the self-halving
+// history. The module keeps one run's state in statics, so each scenario runs in
+// a forked child.
+// sources: memory_trend.cpp time_base.cpp
+
+#include "host_test.h"
+#include "memory_trend.h"
+#include <math.h>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern uint32_t hostFreeHeap;    // host_platform.cpp - free and largest follow it
+extern uint32_t hostMinFreeHeap; // ...and min free is its low-water mark
+
+static const int64_t CYCLE_MS = 5 * 60 * 1000;
+
+// Feed cycles 1..count with free heap = base - lossPerCycle * cycle + noise
+static void runCycles(int count, double base, double lossPerCycle, double noiseSd, unsigned seed = 1)
+{
+  std::mt19937 random(seed);
+  std::normal_distribution<double> noise(0.0, noiseSd > 0 ? noiseSd : 1.0);
+  for (int cycle = 1; cycle <= count; cycle++)
+  {
+    hostAdvanceMillis(CYCLE_MS);
+    double value = base - lossPerCycle * cycle + (noiseSd > 0 ? noise(random) : 0.0);
+    hostFreeHeap = (uint32_t)value;
+    memoryTrendRecordCycle(cycle);
+  }
+}
+
+static MemoryTrendFit fitOf(MemoryTrendSeries series)
+{
+  MemoryTrendFit fit;
+  getMemoryTrendFit(series, fit);
+  return fit;
+}
+
+struct CapturePrint : public Print
+{
+  std::string text;
+  size_t write(uint8_t c) override
+  {
+    text += (char)c;
+    return 1;
+  }
+};
+
+static int countRows(const std::string &csv)
+{
+  int rows = 0;
+  size_t start = 0;
+  while (start < csv.size())
+  {
+    size_t end = csv.find('\n', start);
+    if (end == std::string::npos)
+      end = csv.size();
+    if (csv[start] >= '0' && csv[start] <= '9')
+      rows++;
+    start = end + 1;
+  }
+  return rows;
+}
+
+// Runs body in a child so each scenario starts from a fresh module
+static void scenario(const char *name, void (*body)())
+{
+  fflush(stdout);
+  pid_t child = fork();
+  if (child == 0)
+  {
+    hostTestFailures = 0; // Count this scenario's own failures only
+    body();
+    fflush(stdout);
+    _exit(hostTestFailures ? 1 : 0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    printf("  scenario %s failed\n", name);
+    hostTestFailures++;
+  }
+}
+
+static void noiseOnly()
+{
+  runCycles(1000, 250000, 0, 2000);
+  MemoryTrendFit fit = fitOf(MEM_TREND_FREE);
+  CHECK_EQ(fit.samples, 1000 - MEM_TREND_WARMUP_CYCLES);
+  CHECK(!fit.lossFlagged);
+  CHECK(fabs(fit.tValue) < MEM_TREND_T_CRITICAL);
+}
+
+static void leakUnderNoise()
+{
+  // 20 bytes/cycle under 2 KB of noise per sample: invisible by eye, clear to the fit
+  runCycles(1000, 250000, 20, 2000);
+  MemoryTrendFit fit = fitOf(MEM_TREND_FREE);
+  CHECK(fit.lossFlagged);
+  CHECK(fit.tValue < -MEM_TREND_T_CRITICAL);
+  CHECK(fabs(fit.slope + 20) < 3 * fit.slopeError);
+  CHECK(fitOf(MEM_TREND_LARGEST).lossFlagged);
+}
+
+static void noVerdictBeforeMinSamples()
+{
+  runCycles(MEM_TREND_WARMUP_CYCLES + MEM_TREND_MIN_SAMPLES - 1, 250000, 100, 0);
+  MemoryTrendFit fit = fitOf(MEM_TREND_FREE);
+  CHECK_EQ(fit.samples, MEM_TREND_MIN_SAMPLES - 1);
+  CHECK(!fit.lossFlagged);
+  CHECK(fabs(fit.slope + 100) < 0.01);
+
+  hostAdvanceMillis(CYCLE_MS);
+  hostFreeHeap = 250000 - 100 * (MEM_TREND_WARMUP_CYCLES + MEM_TREND_MIN_SAMPLES);
+  memoryTrendRecordCycle(MEM_TREND_WARMUP_CYCLES + MEM_TREND_MIN_SAMPLES);
+  fit = fitOf(MEM_TREND_FREE);
+  CHECK(fit.lossFlagged); // A perfectly straight loss: finite t thanks to the error floor
+  CHECK(isfinite(fit.tValue));
+}
+
+static void minFreeStepNotFlagged()
+{
+  // A healthy heap, but one large handshake at cycle 100 sets a new low-water mark:
+  // the min_free fit sees a steep, clean fall and must still not call it a leak
+  std::mt19937 random(3);
+  std::normal_distribution<double> noise(0.0, 2000);
+  for (int cycle = 1; cycle <= 300; cycle++)
+  {
+    hostAdvanceMillis(CYCLE_MS);
+    hostFreeHeap = (uint32_t)(250000 + noise(random));
+    if (cycle == 100)
+      hostMinFreeHeap = 200000;
+    memoryTrendRecordCycle(cycle);
+  }
+  MemoryTrendFit minFree = fitOf(MEM_TREND_MIN_FREE);
+  CHECK(minFree.tValue < -MEM_TREND_T_CRITICAL);
+  CHECK(!minFree.lossFlagged);
+  CHECK(!fitOf(MEM_TREND_FREE).lossFlagged);
+  CHECK(!fitOf(MEM_TREND_LARGEST).lossFlagged);
+}
+
+static void lossBelowFloorIgnored()
+{
+  // Significant but tiny - MEM_TREND_MIN_LOSS keeps it quiet
+  runCycles(500, 250000, 1, 0);
+  MemoryTrendFit fit = fitOf(MEM_TREND_FREE);
+  CHECK(fit.tValue < -MEM_TREND_T_CRITICAL);
+  CHECK(!fit.lossFlagged);
+}
+
+static void growthNeverFlagged()
+{
+  runCycles(500, 200000, -30, 1000);
+  MemoryTrendFit fit = fitOf(MEM_TREND_FREE);
+  CHECK(fit.slope > 0);
+  CHECK(!fit.lossFlagged);
+}
+
+static void thirtyDayPrecision()
+{
+  // A cycle every 5 minutes for 30 days; the running sums must not drift
+  int cycles = 30 * 24 * 12;
+  runCycles(cycles, 280000, 5, 0);
+  MemoryTrendFit fit = fitOf(MEM_TREND_FREE);
+  CHECK(fabs(fit.slope + 5) < 0.001);
+  CHECK(fit.lossFlagged);
+}
+
+static void historySpansRun()
+{
+  runCycles(1000, 250000, 20, 0);
+  CapturePrint csv;
+  memoryTrendExportCsv(csv);
+  int rows = countRows(csv.text);
+  CHECK(rows <= MEM_TREND_HISTORY);
+  CHECK(rows >= MEM_TREND_HISTORY / 2);
+  CHECK(csv.text.find("\n4,") != std::string::npos); // First sampled cycle is kept
+  CHECK(csv.text.find("one per 8 cycles") != std::string::npos);
+  CHECK(csv.text.find("# end memtrend") != std::string::npos);
+  CHECK(csv.text.find("flagged=1") != std::string::npos);
+}
+
+int main()
+{
+  scenario("noise only", noiseOnly);
+  scenario("leak under noise", leakUnderNoise);
+  scenario("min samples", noVerdictBeforeMinSamples);
+  scenario("min free step", minFreeStepNotFlagged);
+  scenario("loss floor", lossBelowFloorIgnored);
+  scenario("growth", growthNeverFlagged);
+  scenario("30 days", thirtyDayPrecision);
+  scenario("history", historySpansRun);
+  return hostTestResult("memory_trend");
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Host-side regression tests for the sketch modules that do not need the hardware.
+#
+# Usage: tools/host_tests/run.sh [name ...]     e.g. run.sh time_base lcd_display
+#
+# Each <name>_test.cpp lists the sketch sources it links on a "// sources:" line and
+# any extra compiler flags on a "// flags:" line. stubs/ stands in for the Arduino
+# core and ESP-IDF headers; host_platform.cpp implements them with a settable clock
+# (hostAdvanceMicros), an in-memory NVS and a LittleFS backed by a temp directory.
+# Needs g++ with C++17. Exits non-zero if any test fails to build or fails.
+
+cd "$(dirname "$0")" || exit 1
+REPO=../..
+OUT="${TMPDIR:-/tmp}/sani_host_tests"
+mkdir -p "$OUT"
+
+if [ $# -eq 0 ]; then
+  set -- $(ls *_test.cpp | sed 's/_test\.cpp$//')
+fi
+
+failed=0
+for name in "$@"; do
+  test="${name}_test.cpp"
+  sources=$(sed -n 's|^// sources:||p' "$test")
+  flags=$(sed -n 's|^// flags:||p' "$test")
+  paths=""
+  for source in $sources; do
+    paths="$paths $REPO/$source"
+  done
+
+  if ! g++ -std=gnu++17 -O1 -g -Wall -Wextra -Wno-unused-parameter -Wno-missing-field-initializers \
+      -Istubs -I$REPO $flags -o "$OUT/$name" "$test" host_platform.cpp $paths -lpthread; then
+    echo "BUILD FAILED: $name"
+    failed=1
+    continue
+  fi
+  if ! "$OUT/$name"; then
+    echo "FAILED: $name"
+    failed=1
+  fi
+done
+exit $failed
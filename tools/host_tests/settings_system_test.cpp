@@ -0,0 +1,189 @@
+// Settings persistence: the schema v2 blob round trip, v1 key migration, blobs from
+// older and newer builds, and corrupt or mis-sized blobs, against an in-memory NVS.
+// sources: settings_system.cpp heap_tags.cpp time_base.cpp
+
+#include "host_test.h"
+#include "settings_system.h"
+#include "settings_sync.h"
+#include "esp_rom_crc.h"
+#include "global_vars.h"
+
+const int PUMP_WASTE_ML_SEC = 25; // As in global_vars.cpp
+
+// The settings screen and the settings sync are not under test
+void drawFlowDetails() {}
+void settingsSyncBegin(const int *) {}
+void settingsSyncLocalEdit(SettingId, int) {}
+bool settingsSyncTakeRemote(int *, uint32_t *) { return false; }
+
+TFT_eSPI tft; // global_vars.h
+
+static const uint32_t BLOB_MAGIC = 0x54534653;
+static const size_t BLOB_HEADER = 8; // magic, version, count
+
+static void putLegacy(const char *key, int32_t value)
+{
+  Preferences prefs;
+  prefs.putInt(key, value);
+}
+
+// A blob as some other build would have written it
+static void putBlob(uint16_t version, const std::vector<int32_t> &values)
+{
+  std::vector<uint8_t> blob(BLOB_HEADER + values.size() * sizeof(int32_t));
+  uint16_t count = (uint16_t)values.size();
+  memcpy(&blob[0], &BLOB_MAGIC, 4);
+  memcpy(&blob[4], &version, 2);
+  memcpy(&blob[6], &count, 2);
+  if (!values.empty())
+    memcpy(&blob[BLOB_HEADER], values.data(), values.size() * sizeof(int32_t));
+  uint32_t crc = esp_rom_crc32_le(0, blob.data(), blob.size());
+  blob.insert(blob.end(), (uint8_t *)&crc, (uint8_t *)&crc + sizeof(crc));
+  hostNvs["blob"] = blob;
+}
+
+static std::vector<int32_t> defaults()
+{
+  std::vector<int32_t> values;
+  for (const SettingDescriptor &setting : SETTING_DESCRIPTORS)
+    values.push_back(setting.defaultValue);
+  return values;
+}
+
+static SettingsStoreStats storeStats(SettingsSystem &settings)
+{
+  SettingsStoreStats stats;
+  settings.getStoreStats(stats);
+  return stats;
+}
+
+static bool allDefaults(SettingsSystem &settings)
+{
+  for (int i = 0; i < SETTINGS_COUNT; i++)
+  {
+    if (settings.value((SettingId)i) != SETTING_DESCRIPTORS[i].defaultValue)
+      return false;
+  }
+  return true;
+}
+
+int main()
+{
+  // Nothing stored: defaults, and nothing written until an edit
+  {
+    hostNvs.clear();
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK(allDefaults(settings));
+    CHECK_EQ(storeStats(settings).loadedVersion, 0);
+    CHECK(hostNvs.empty());
+  }
+
+  // Schema v1: one int per setting, migrated into a blob (clamped) and the old keys removed
+  {
+    hostNvs.clear();
+    putLegacy("wasteQty", 500);
+    putLegacy("timeout", 99999);
+    putLegacy("flushRelayTimeLapse", 4500);
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK_EQ(settings.value(SETTING_WASTE_QTY), 500);
+    CHECK_EQ(settings.value(SETTING_SCREEN_TIMEOUT), SETTING_DESCRIPTORS[SETTING_SCREEN_TIMEOUT].maxVal);
+    CHECK_EQ(settings.getFlushRelayTimeLapse(), 4500);
+    CHECK_EQ(settings.value(SETTING_LEFT_WATER_OZ), SETTING_DESCRIPTORS[SETTING_LEFT_WATER_OZ].defaultValue);
+    CHECK_EQ(storeStats(settings).loadedVersion, 1);
+    CHECK_EQ(storeStats(settings).commits, 1);
+    CHECK_EQ(hostNvs.size(), 1);
+    CHECK(hostNvs.count("blob") == 1);
+    CHECK_EQ(hostNvs["blob"].size(), BLOB_HEADER + SETTINGS_COUNT * sizeof(int32_t) + 4);
+  }
+
+  // ...and the next boot reads the blob it wrote
+  {
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK_EQ(storeStats(settings).loadedVersion, SETTINGS_SCHEMA_VERSION);
+    CHECK_EQ(storeStats(settings).errors, 0);
+    CHECK_EQ(settings.value(SETTING_WASTE_QTY), 500);
+    CHECK_EQ(settings.getFlushWorkflowRepeat(), SETTING_DESCRIPTORS[SETTING_WORKFLOW_REPEAT].defaultValue * 1000);
+    CHECK_EQ(settingsSnapshot().wasteQtyMl, 500);
+  }
+
+  // An older build's shorter blob: stored values load, newer settings keep their defaults
+  {
+    hostNvs.clear();
+    std::vector<int32_t> values = defaults();
+    values.resize(SETTING_LEFT_WATER_OZ);
+    values[SETTING_PIC_EVERY_N] = 5;
+    putBlob(2, values);
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK_EQ(storeStats(settings).errors, 0);
+    CHECK_EQ(settings.value(SETTING_PIC_EVERY_N), 5);
+    CHECK_EQ(settings.value(SETTING_RIGHT_WATER_OZ), SETTING_DESCRIPTORS[SETTING_RIGHT_WATER_OZ].defaultValue);
+  }
+
+  // A newer build's longer blob: the extra values are ignored, stored ones clamped
+  {
+    hostNvs.clear();
+    std::vector<int32_t> values = defaults();
+    values[SETTING_CAMERA_DELAY] = 1000000;
+    values[SETTING_LEFT_WATER_OZ] = 240;
+    values.push_back(77);
+    values.push_back(88);
+    putBlob(SETTINGS_SCHEMA_VERSION + 1, values);
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK_EQ(storeStats(settings).errors, 0);
+    CHECK_EQ(storeStats(settings).loadedVersion, SETTINGS_SCHEMA_VERSION + 1);
+    CHECK_EQ(settings.value(SETTING_CAMERA_DELAY), SETTING_DESCRIPTORS[SETTING_CAMERA_DELAY].maxVal);
+    CHECK_EQ(settings.value(SETTING_LEFT_WATER_OZ), 240);
+  }
+
+  // One flipped bit: CRC mismatch, defaults, and v1 keys are not resurrected
+  {
+    hostNvs.clear();
+    std::vector<int32_t> values = defaults();
+    values[SETTING_WASTE_QTY] = 800;
+    putBlob(2, values);
+    hostNvs["blob"][BLOB_HEADER + SETTING_WASTE_QTY * sizeof(int32_t)] ^= 0x01;
+    std::vector<uint8_t> corrupt = hostNvs["blob"];
+    putLegacy("wasteQty", 300);
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK(allDefaults(settings));
+    CHECK_EQ(storeStats(settings).errors, 1);
+    CHECK_EQ(storeStats(settings).loadedVersion, 0);
+    CHECK(hostNvs["blob"] == corrupt); // Left for the next edit to overwrite
+  }
+
+  // A header whose count disagrees with the size, and a blob too short to hold a header
+  {
+    hostNvs.clear();
+    putBlob(2, defaults());
+    uint16_t wrongCount = SETTINGS_COUNT + 1;
+    memcpy(&hostNvs["blob"][6], &wrongCount, 2);
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK(allDefaults(settings));
+    CHECK_EQ(storeStats(settings).errors, 1);
+
+    hostNvs["blob"] = { 1, 2, 3 };
+    SettingsSystem truncated(&tft);
+    truncated.begin();
+    CHECK(allDefaults(truncated));
+    CHECK_EQ(storeStats(truncated).errors, 1);
+  }
+
+  // Wrong magic
+  {
+    hostNvs.clear();
+    putBlob(2, defaults());
+    hostNvs["blob"][0] ^= 0xFF;
+    SettingsSystem settings(&tft);
+    settings.begin();
+    CHECK_EQ(storeStats(settings).errors, 1);
+  }
+
+  return hostTestResult("settings_system");
+}
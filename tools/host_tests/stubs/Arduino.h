@@ -0,0 +1,103 @@
+#pragma once
+// Host stand-in for the parts of the Arduino-ESP32 core the tested modules use
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define HIGH 1
+#define LOW 0
+
+// Enough of Arduino's String for the UI code that still builds labels with it
+class String
+{
+public:
+  String(const char *text = "") : text(text ? text : "") {}
+  String(const std::string &text) : text(text) {}
+  String(int value) : text(std::to_string(value)) {}
+  String(unsigned value) : text(std::to_string(value)) {}
+  String(long value) : text(std::to_string(value)) {}
+  String(unsigned long value) : text(std::to_string(value)) {}
+  const char *c_str() const { return text.c_str(); }
+  size_t length() const { return text.size(); }
+  String operator+(const String &other) const { return String(text + other.text); }
+  String operator+(const char *other) const { return String(text + other); }
+  friend String operator+(const char *left, const String &right) { return String(left + right.text); }
+  String &operator+=(const String &other)
+  {
+    text += other.text;
+    return *this;
+  }
+  bool operator==(const char *other) const { return text == other; }
+  bool operator!=(const char *other) const { return text != other; }
+
+private:
+  std::string text;
+};
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *data, size_t length)
+  {
+    size_t written = 0;
+    for (size_t i = 0; i < length; i++)
+      written += write(data[i]);
+    return written;
+  }
+  size_t write(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+  size_t print(const char *text) { return write(text); }
+  size_t print(const String &text) { return write(text.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  virtual void flush() {}
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+};
+
+class HardwareSerial : public Stream
+{
+public:
+  size_t write(uint8_t c) override;
+  using Print::write;
+  operator bool() const { return true; }
+};
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+inline void digitalWrite(uint8_t, uint8_t) {}
+
+class EspClass
+{
+public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint64_t getEfuseMac();
+};
+extern EspClass ESP;
+
+uint32_t esp_random();
+
+#include "freertos/FreeRTOS.h"
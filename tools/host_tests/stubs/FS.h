@@ -0,0 +1,70 @@
+#pragma once
+// Host stand-in for the Arduino FS API: paths map into hostFsRoot, a per-run temp
+// directory that tests can inspect and corrupt. hostFsFailWrites makes every write
+// come up short, as a full or worn flash would.
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+extern std::string hostFsRoot;
+extern bool hostFsFailWrites;
+std::string hostFsPath(const char *path);
+
+namespace fs
+{
+
+class File : public Stream
+{
+public:
+  File() {}
+  explicit File(FILE *handle) : handle(handle, fclose) {}
+  operator bool() const { return handle != nullptr; }
+  void close() { handle.reset(); }
+  size_t read(uint8_t *data, size_t length) { return handle ? fread(data, 1, length, handle.get()) : 0; }
+  int read() override
+  {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  size_t write(const uint8_t *data, size_t length) override
+  {
+    if (!handle || hostFsFailWrites)
+      return 0;
+    return fwrite(data, 1, length, handle.get());
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+
+private:
+  std::shared_ptr<FILE> handle;
+};
+
+class FS
+{
+public:
+  File open(const char *path, const char *mode = FILE_READ)
+  {
+    std::string mapped = hostFsPath(path);
+    return File(fopen(mapped.c_str(), *mode == 'r' ? "rb" : *mode == 'a' ? "ab" : "wb"));
+  }
+  bool exists(const char *path)
+  {
+    FILE *file = fopen(hostFsPath(path).c_str(), "rb");
+    if (file)
+      fclose(file);
+    return file != nullptr;
+  }
+  bool remove(const char *path) { return ::remove(hostFsPath(path).c_str()) == 0; }
+  bool rename(const char *from, const char *to)
+  {
+    return ::rename(hostFsPath(from).c_str(), hostFsPath(to).c_str()) == 0;
+  }
+};
+
+} // namespace fs
+
+using fs::File;
@@ -0,0 +1,59 @@
+#pragma once
+// Host stand-in for the I2C character LCD: emulates the HD44780 display RAM and
+// cursor, and counts the bytes sent to it, so tests can check both what the panel
+// shows and what it cost
+
+#include <Arduino.h>
+#include <string>
+
+class LiquidCrystal_I2C : public Print
+{
+public:
+  static const int DDRAM_COLS = 40; // Per row; columns past the visible 16 are off-screen
+
+  uint32_t dataBytes = 0;    // Characters
+  uint32_t commandBytes = 0; // Cursor moves, clears
+  uint32_t clears = 0;
+
+  LiquidCrystal_I2C(uint8_t, uint8_t cols, uint8_t rows) : cols(cols), rows(rows) { wipe(); }
+
+  void init() { clear(); }
+  void backlight() {}
+  void clear()
+  {
+    wipe();
+    commandBytes++;
+    clears++;
+  }
+  void setCursor(uint8_t col, uint8_t row)
+  {
+    cursorCol = col;
+    cursorRow = row;
+    commandBytes++;
+  }
+  size_t write(uint8_t c) override
+  {
+    ram[cursorRow % 2][cursorCol % DDRAM_COLS] = (char)c;
+    cursorCol = (cursorCol + 1) % DDRAM_COLS;
+    dataBytes++;
+    return 1;
+  }
+  using Print::write;
+
+  std::string visibleRow(int row) const { return std::string(ram[row], cols); }
+  uint32_t totalBytes() const { return dataBytes + commandBytes; }
+
+private:
+  uint8_t cols;
+  uint8_t rows;
+  char ram[2][DDRAM_COLS];
+  int cursorRow = 0;
+  int cursorCol = 0;
+
+  void wipe()
+  {
+    memset(ram, ' ', sizeof(ram));
+    cursorRow = 0;
+    cursorCol = 0;
+  }
+};
@@ -0,0 +1,13 @@
+#pragma once
+// Host stand-in for LittleFS - see FS.h
+
+#include "FS.h"
+
+class LittleFSFS : public fs::FS
+{
+public:
+  bool begin(bool = false) { return true; }
+  size_t totalBytes() { return 1536 * 1024; }
+  size_t usedBytes() { return 0; }
+};
+extern LittleFSFS LittleFS;
@@ -0,0 +1,50 @@
+#pragma once
+// Host stand-in for NVS: every namespace shares one in-memory map, which tests
+// can inspect and corrupt through hostNvs
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+extern std::map<std::string, std::vector<uint8_t>> hostNvs;
+
+class Preferences
+{
+public:
+  bool begin(const char *, bool = false) { return true; }
+  void end() {}
+  bool isKey(const char *key) { return hostNvs.count(key) != 0; }
+  bool remove(const char *key) { return hostNvs.erase(key) != 0; }
+  size_t putBytes(const char *key, const void *data, size_t length)
+  {
+    hostNvs[key].assign((const uint8_t *)data, (const uint8_t *)data + length);
+    return length;
+  }
+  size_t getBytesLength(const char *key)
+  {
+    auto entry = hostNvs.find(key);
+    return entry == hostNvs.end() ? 0 : entry->second.size();
+  }
+  size_t getBytes(const char *key, void *data, size_t length)
+  {
+    auto entry = hostNvs.find(key);
+    if (entry == hostNvs.end())
+      return 0;
+    size_t copy = min(length, entry->second.size());
+    memcpy(data, entry->second.data(), copy);
+    return copy;
+  }
+  size_t putInt(const char *key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+  int32_t getInt(const char *key, int32_t fallback = 0)
+  {
+    int32_t value = fallback;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : fallback;
+  }
+  size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint32_t getUInt(const char *key, uint32_t fallback = 0)
+  {
+    uint32_t value = fallback;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : fallback;
+  }
+};
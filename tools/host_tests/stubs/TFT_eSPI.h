@@ -0,0 +1,39 @@
+#pragma once
+// Host stand-in: drawing calls do nothing, touch never reports a press
+
+#include <Arduino.h>
+
+#define TFT_WHITE 0xFFFF
+#define TFT_BLACK 0x0000
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_BLUE 0x001F
+#define TFT_DARKGREY 0x7BEF
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define MC_DATUM 4
+
+class TFT_eSPI : public Print
+{
+public:
+  size_t write(uint8_t) override { return 1; }
+  using Print::write;
+  void init() {}
+  void setRotation(int) {}
+  void fillScreen(uint16_t) {}
+  void fillRect(int, int, int, int, uint16_t) {}
+  void drawRect(int, int, int, int, uint16_t) {}
+  void fillRoundRect(int, int, int, int, int, uint16_t) {}
+  void drawRoundRect(int, int, int, int, int, uint16_t) {}
+  void fillCircle(int, int, int, uint16_t) {}
+  void drawLine(int, int, int, int, uint16_t) {}
+  void setTextColor(uint16_t) {}
+  void setTextColor(uint16_t, uint16_t) {}
+  void setTextSize(int) {}
+  void setTextDatum(int) {}
+  void setCursor(int, int) {}
+  void drawString(const char *, int, int) {}
+  void drawString(const String &, int, int) {}
+  bool getTouch(uint16_t *, uint16_t *) { return false; }
+};
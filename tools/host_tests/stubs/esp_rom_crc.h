@@ -0,0 +1,16 @@
+#pragma once
+// Same result as the ROM routine: reflected CRC-32 (zlib), crc is the running value
+
+#include <stdint.h>
+
+inline uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buffer, uint32_t length)
+{
+  crc = ~crc;
+  while (length--)
+  {
+    crc ^= *buffer++;
+    for (int bit = 0; bit < 8; bit++)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+  }
+  return ~crc;
+}
@@ -0,0 +1,74 @@
+// Crossing the old 32-bit millis() wrap with the clock started just short of it,
+// the way -DMONO_CLOCK_START_OFFSET_MS lets a rig do it on the bench.
+// sources: time_base.cpp
+// flags: -DMONO_CLOCK_START_OFFSET_MS=4294900000ULL
+
+#include "host_test.h"
+#include "time_base.h"
+
+static const uint64_t WRAP_MS = 1ULL << 32;
+
+// The scheduling idioms used across the sketch, written against monoMillis()
+static bool intervalElapsed(uint64_t lastMs, uint64_t intervalMs)
+{
+  return monoMillis() - lastMs >= intervalMs; // updateTimers, status logging, settings debounce
+}
+
+static bool deadlinePassed(uint64_t deadlineMs)
+{
+  return monoMillis() >= deadlineMs; // Upload backoff, settings sync polling
+}
+
+int main()
+{
+  hostClockUs = 0;
+  CHECK_EQ(monoMillis(), 4294900000ULL);
+  CHECK_EQ(monoMicros(), 4294900000ULL * 1000);
+
+  // Monotonic, millisecond by millisecond, across the boundary
+  uint64_t previous = monoMillis();
+  bool crossed = false;
+  for (int i = 0; i < 70000; i++)
+  {
+    hostAdvanceMillis(1);
+    uint64_t now = monoMillis();
+    CHECK(now == previous + 1);
+    crossed |= previous < WRAP_MS && now >= WRAP_MS;
+    previous = now;
+  }
+  CHECK(crossed);
+  CHECK(monoMillis() > WRAP_MS);
+
+  // An interval started 500 ms before the wrap and checked 500 ms after it
+  hostClockUs = (int64_t)(WRAP_MS - 500 - 4294900000ULL) * 1000;
+  uint64_t startMs = monoMillis();
+  CHECK(!intervalElapsed(startMs, 1000));
+  hostAdvanceMillis(999);
+  CHECK(!intervalElapsed(startMs, 1000));
+  CHECK_EQ(monoMillis() - startMs, 999);
+  hostAdvanceMillis(1);
+  CHECK(intervalElapsed(startMs, 1000));
+  CHECK_EQ(monoMillis(), WRAP_MS + 500);
+
+  // A deadline set before the wrap that falls after it - the case a 32-bit
+  // "millis() >= deadline" got wrong by firing immediately or never
+  hostClockUs = (int64_t)(WRAP_MS - 100 - 4294900000ULL) * 1000;
+  uint64_t deadlineMs = monoMillis() + 5000;
+  CHECK(!deadlinePassed(deadlineMs));
+  hostAdvanceMillis(4999);
+  CHECK(!deadlinePassed(deadlineMs));
+  hostAdvanceMillis(1);
+  CHECK(deadlinePassed(deadlineMs));
+
+  // What the same deadline looks like truncated to 32 bits: already "passed"
+  uint32_t deadline32 = (uint32_t)deadlineMs;
+  uint32_t before32 = (uint32_t)(WRAP_MS - 100);
+  CHECK(before32 >= deadline32); // Documents the bug the 64-bit clock removes
+
+  // Several years of uptime still fit with room to spare
+  hostClockUs = 5LL * 365 * 24 * 3600 * 1000000;
+  CHECK(monoMillis() > 5ULL * 365 * 24 * 3600 * 1000);
+  CHECK_EQ(monoMillis(), monoMicros() / 1000);
+
+  return hostTestResult("time_base");
+}
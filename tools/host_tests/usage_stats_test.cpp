@@ -0,0 +1,341 @@
+// Usage rollups: events held until the wall clock is known, the last-hour ring,
+// day/week/month rollover, peak hour and averages, hold overflow and stale events,
+// and the LittleFS checkpoint round trip. The module keeps its rings in statics, so
+// each scenario runs in a forked child; the checkpoint scenarios share one directory.
+// sources: usage_stats.cpp event_bus.cpp time_base.cpp
+
+#include "host_test.h"
+#include "usage_stats.h"
+#include "event_bus.h"
+#include "storage.h"
+#include "time_service.h"
+#include <LittleFS.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const int32_t ZONE_SEC = -7 * 3600;
+static const uint32_t DAY_SEC = 86400;
+static const uint32_t SUNDAY_18_OCT = 20744 * DAY_SEC; // 2026-10-18 00:00 local
+
+// SNTP and the LittleFS mount are not under test: the clock syncs when a scenario
+// says so and the zone never changes
+static bool synced = false;
+static int64_t wallOffsetUs = 0; // UTC = mono + offset
+static bool storageMounted = false;
+
+bool timeServiceSynced()
+{
+  return synced;
+}
+
+bool monoToWallMicros(uint64_t monoUs, int64_t *wallUs)
+{
+  if (!synced)
+    return false;
+  *wallUs = (int64_t)monoUs + wallOffsetUs;
+  return true;
+}
+
+int32_t localUtcOffsetSeconds(time_t)
+{
+  return ZONE_SEC;
+}
+
+bool storageReady()
+{
+  return storageMounted;
+}
+
+// Makes the current monotonic time read as localSec
+static void syncAt(uint32_t localSec)
+{
+  synced = true;
+  wallOffsetUs = ((int64_t)localSec - ZONE_SEC) * 1000000LL - hostClockUs;
+}
+
+static void start(bool mounted)
+{
+  storageMounted = mounted;
+  usageStatsBegin();
+  usageStatsLoadCheckpoint();
+  hostAdvanceMillis(1000);
+}
+
+// Lets time pass and gives the loop task one service call
+static void pass(uint32_t seconds)
+{
+  hostAdvanceMillis((int64_t)seconds * 1000);
+  usageStatsService();
+}
+
+static void flush()
+{
+  eventPublish(APP_EVENT_FLUSH, 0, 1);
+}
+
+static UsageRollup rollup()
+{
+  UsageRollup result;
+  getUsageRollup(result);
+  return result;
+}
+
+static UsageStoreStats storeStats()
+{
+  UsageStoreStats stats;
+  getUsageStoreStats(stats);
+  return stats;
+}
+
+struct CapturePrint : public Print
+{
+  std::string text;
+  size_t write(uint8_t c) override
+  {
+    text += (char)c;
+    return 1;
+  }
+};
+
+// Runs body in a child so each scenario starts from a fresh module
+static void scenario(const char *name, void (*body)())
+{
+  fflush(stdout);
+  pid_t child = fork();
+  if (child == 0)
+  {
+    hostTestFailures = 0; // Count this scenario's own failures only
+    body();
+    fflush(stdout);
+    _exit(hostTestFailures ? 1 : 0);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+  {
+    printf("  scenario %s failed\n", name);
+    hostTestFailures++;
+  }
+}
+
+static void heldUntilSync()
+{
+  start(false);
+  flush();
+  pass(60);
+  flush();
+  CHECK(!rollup().valid);
+  CHECK_EQ(storeStats().held, 2);
+
+  // The clock syncs at 09:02: both flushes land at their real minutes
+  syncAt(SUNDAY_18_OCT + 9 * 3600 + 120);
+  pass(1);
+  UsageRollup usage = rollup();
+  CHECK(usage.valid);
+  CHECK_EQ(usage.dailyFlushes, 2);
+  CHECK_EQ(usage.flushesLastHour, 2);
+  CHECK_EQ(usage.averageFlushIntervalSec, 60);
+  CHECK_EQ(usage.peakUsageHour, 9);
+
+  flush(); // Placed at once now
+  CHECK_EQ(rollup().dailyFlushes, 3);
+  CHECK_EQ(storeStats().held, 2);
+  CHECK_EQ(storeStats().recorded, 3);
+}
+
+static void restoreWaitTimesOut()
+{
+  // No checkpoint read ever arrives: events wait out USAGE_RESTORE_WAIT_MS, then count
+  usageStatsBegin();
+  syncAt(SUNDAY_18_OCT + 12 * 3600);
+  flush();
+  pass(USAGE_RESTORE_WAIT_MS / 2000);
+  CHECK(!rollup().valid);
+  pass(USAGE_RESTORE_WAIT_MS / 1000);
+  CHECK(rollup().valid);
+  CHECK_EQ(rollup().dailyFlushes, 1);
+  CHECK(!storeStats().restored);
+}
+
+static void lastHourAndPeak()
+{
+  start(false);
+  syncAt(SUNDAY_18_OCT + 6 * 3600 + 30 * 60);
+  flush(); // 06:30
+  pass(30 * 60);
+  flush(); // 07:00
+  pass(10 * 60);
+  flush();
+  pass(10 * 60);
+  flush(); // 07:20
+  CHECK_EQ(rollup().flushesLastHour, 4);
+  CHECK_EQ(rollup().peakUsageHour, 7);
+  CHECK_EQ(rollup().averageFlushIntervalSec, 50 * 60 / 3);
+
+  pass(15 * 60); // 06:30 drops out of the minute ring
+  CHECK_EQ(rollup().flushesLastHour, 3);
+  pass(60 * 60);
+  CHECK_EQ(rollup().flushesLastHour, 0);
+  CHECK_EQ(rollup().dailyFlushes, 4);
+
+  // Past the hour ring: no peak left, and the day ring averages over 8 completed days
+  pass(8 * DAY_SEC);
+  UsageRollup usage = rollup();
+  CHECK_EQ(usage.peakUsageHour, -1);
+  CHECK_EQ(usage.dailyFlushes, 0);
+  CHECK_EQ(usage.averageFlushesPerDay, 0);
+  CHECK_EQ(usage.averageFlushIntervalSec, 0);
+}
+
+static void dayWeekMonthRollover()
+{
+  start(false);
+  syncAt(SUNDAY_18_OCT + 12 * DAY_SEC + 22 * 3600); // Friday 30 Oct, 22:00
+  for (int i = 0; i < 3; i++)
+  {
+    flush();
+    pass(60);
+  }
+  UsageRollup usage = rollup();
+  CHECK_EQ(usage.dailyFlushes, 3);
+  CHECK_EQ(usage.weeklyFlushes, 3);
+  CHECK_EQ(usage.monthlyFlushes, 3);
+
+  pass(DAY_SEC); // Saturday 31 Oct
+  usage = rollup();
+  CHECK_EQ(usage.dailyFlushes, 0);
+  CHECK_EQ(usage.weeklyFlushes, 3);
+  CHECK_EQ(usage.averageFlushesPerDay, 3);
+  flush();
+  flush();
+  CHECK_EQ(rollup().weeklyFlushes, 5);
+  CHECK_EQ(rollup().monthlyFlushes, 5);
+
+  pass(DAY_SEC); // Sunday 1 Nov: new month, same week
+  usage = rollup();
+  CHECK_EQ(usage.weeklyFlushes, 5);
+  CHECK_EQ(usage.monthlyFlushes, 0);
+  flush();
+
+  pass(DAY_SEC); // Monday 2 Nov: new week
+  usage = rollup();
+  CHECK_EQ(usage.weeklyFlushes, 0);
+  CHECK_EQ(usage.monthlyFlushes, 1);
+  CHECK_EQ(usage.averageFlushesPerDay, (3 + 2 + 1) / 3);
+}
+
+static void holdOverflowAndStale()
+{
+  start(false);
+  for (int i = 0; i <= USAGE_HOLD_EVENTS; i++)
+    flush();
+  CHECK_EQ(storeStats().held, USAGE_HOLD_EVENTS);
+  CHECK_EQ(storeStats().dropped, 1);
+
+  // SNTP only syncs 40 days later: the held flushes land on their own day, which
+  // has rolled out of every ring by now
+  pass(40 * DAY_SEC);
+  syncAt(SUNDAY_18_OCT + 12 * 3600);
+  pass(1);
+  CHECK_EQ(rollup().dailyFlushes, 0);
+  CHECK_EQ(rollup().averageFlushesPerDay, 0);
+
+  // A re-sync that steps the clock back past every ring counts the flush nowhere
+  flush();
+  syncAt(SUNDAY_18_OCT - 40 * DAY_SEC);
+  flush();
+  CHECK_EQ(storeStats().stale, 1);
+  syncAt(SUNDAY_18_OCT + 12 * 3600);
+  CHECK_EQ(rollup().dailyFlushes, 1);
+}
+
+static void checkpointWrite()
+{
+  start(true); // No checkpoint yet
+  syncAt(SUNDAY_18_OCT + 10 * 3600);
+  pass(1);
+  flush();
+  flush();
+  flush();
+  eventPublish(APP_EVENT_IMAGE, 0, 1);
+  eventPublish(APP_EVENT_WASTE_DOSE, 0, 50);
+  usageStatsWriteCheckpoint(); // Nothing queued yet
+  CHECK(!LittleFS.exists(USAGE_CHECKPOINT_FILE));
+
+  pass(USAGE_CHECKPOINT_INTERVAL_MS / 1000);
+  usageStatsWriteCheckpoint();
+  CHECK_EQ(storeStats().checkpoints, 1);
+  CHECK(LittleFS.exists(USAGE_CHECKPOINT_FILE));
+  CHECK(!LittleFS.exists(USAGE_CHECKPOINT_TMP_FILE));
+
+  CapturePrint csv;
+  usageStatsExportCsv(csv);
+  CHECK(csv.text.find("day,2026-10-18T00:00,3,1,50\r\n") != std::string::npos);
+  CHECK(csv.text.find("hour,2026-10-18T10:00,3,1,50\r\n") != std::string::npos);
+  CHECK(csv.text.find("# end usage") != std::string::npos);
+
+  // A failed write is counted and leaves the last good checkpoint in place
+  hostFsFailWrites = true;
+  flush();
+  pass(USAGE_CHECKPOINT_INTERVAL_MS / 1000);
+  usageStatsWriteCheckpoint();
+  hostFsFailWrites = false;
+  CHECK_EQ(storeStats().checkpoints, 1);
+  CHECK_EQ(storeStats().checkpointErrors, 1);
+}
+
+static void checkpointRestore()
+{
+  start(true);
+  pass(1);
+  CHECK(storeStats().restored);
+  syncAt(SUNDAY_18_OCT + 10 * 3600 + 30 * 60);
+  UsageRollup usage = rollup();
+  CHECK_EQ(usage.dailyFlushes, 3); // The failed write's flush is lost
+  CHECK_EQ(usage.dailyImages, 1);
+  CHECK_EQ(usage.dailyWasteMl, 50);
+  CHECK_EQ(usage.monthlyFlushes, 3);
+  flush();
+  CHECK_EQ(rollup().dailyFlushes, 4);
+}
+
+static void corruptCheckpointIgnored()
+{
+  FILE *file = fopen(hostFsPath(USAGE_CHECKPOINT_FILE).c_str(), "r+b");
+  CHECK(file != nullptr);
+  if (file)
+  {
+    fseek(file, 40, SEEK_SET);
+    int c = fgetc(file);
+    fseek(file, 40, SEEK_SET);
+    fputc(c ^ 0x01, file);
+    fclose(file);
+  }
+
+  start(true);
+  pass(1);
+  CHECK(!storeStats().restored);
+  syncAt(SUNDAY_18_OCT + 11 * 3600);
+  CHECK(rollup().valid);
+  CHECK_EQ(rollup().dailyFlushes, 0);
+}
+
+int main()
+{
+  LittleFS.remove(USAGE_CHECKPOINT_FILE); // Also fixes the directory the children share
+
+  scenario("held until sync", heldUntilSync);
+  scenario("restore wait", restoreWaitTimesOut);
+  scenario("last hour and peak", lastHourAndPeak);
+  scenario("rollover", dayWeekMonthRollover);
+  scenario("hold overflow", holdOverflowAndStale);
+  scenario("checkpoint write", checkpointWrite);
+  scenario("checkpoint restore", checkpointRestore);
+  scenario("corrupt checkpoint", corruptCheckpointIgnored);
+
+  LittleFS.remove(USAGE_CHECKPOINT_FILE);
+  LittleFS.remove(USAGE_CHECKPOINT_TMP_FILE);
+  rmdir(hostFsRoot.c_str());
+  return hostTestResult("usage_stats");
+}
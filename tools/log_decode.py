@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+"""Decode the binary serial log written by a LOG_BINARY_MODE=1 build.
+
+Usage: python3 tools/log_decode.py <firmware.elf> [capture.bin | -] [--port /dev/ttyACM0 [--baud 115200]]
+
+The device sends format string addresses instead of text; this tool looks the
+strings up in the ELF of the exact build that produced the log (Arduino IDE:
+Sketch > Export Compiled Binary, or the .elf in the build folder) and prints the
+usual "YYMMDD.HH:MM:SS.zzz - message" lines. Reads a capture file, stdin ('-'),
+or a serial port (needs pyserial).
+
+Lines logged before the device's first SNTP sync are held and printed
+retro-stamped once the time base arrives, like the text logger does. At the end
+a summary on stderr compares the binary bytes received with the text they
+expanded to.
+"""
+import datetime
+import re
+import struct
+import sys
+
+FRAME_TRUNCATED = 0x40
+FRAME_SYNC = 0xF0
+FRAME_DEFINE = 0xF1
+
+HOLD_MAX_US = 20000000  # Matches TIME_LOG_HOLD_MAX_MS on the device
+
+SPEC_RE = re.compile(r"%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d*))?"
+                     r"(?P<length>hh|h|ll|l|z|t|j|L)?(?P<conversion>[diouxXcfFeEgGaAspn%])")
+
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+
+class FormatStrings:
+    """Reads NUL-terminated strings out of the ELF's loaded sections by address."""
+
+    def __init__(self, path):
+        self.sections = []
+        self.cache = {}
+        with open(path, "rb") as f:
+            elf = f.read()
+        if elf[:4] != b"\x7fELF" or elf[5] != 1:
+            raise SystemExit("%s is not a little-endian ELF file" % path)
+        if elf[4] == 1:  # ELF32 (the ESP32 build)
+            shoff, = struct.unpack_from("<I", elf, 0x20)
+            shentsize, shnum = struct.unpack_from("<HH", elf, 0x2E)
+            header = "<IIIIII"
+        else:  # ELF64, only for host builds of the logger
+            shoff, = struct.unpack_from("<Q", elf, 0x28)
+            shentsize, shnum = struct.unpack_from("<HH", elf, 0x3A)
+            header = "<IIQQQQ"
+        for i in range(shnum):
+            _, kind, flags, addr, offset, size = struct.unpack_from(header, elf, shoff + i * shentsize)
+            if addr and kind != SHT_NOBITS and flags & SHF_ALLOC:
+                self.sections.append((addr, elf[offset:offset + size]))
+
+    def lookup(self, address):
+        if address in self.cache:
+            return self.cache[address]
+        text = None
+        for base, data in self.sections:
+            if base <= address < base + len(data):
+                start = address - base
+                end = data.find(b"\0", start)
+                text = data[start:end if end >= 0 else len(data)].decode("utf-8", "replace")
+                break
+        self.cache[address] = text
+        return text
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise IndexError
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    def zigzag(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def raw(self, count):
+        if self.pos + count > len(self.data):
+            raise IndexError
+        self.pos += count
+        return self.data[self.pos - count:self.pos]
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def crc8(data):
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def render(fmt, reader):
+    """printf-style expansion of fmt with arguments read from the frame."""
+    out = []
+    last = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        conversion = m.group("conversion")
+        if conversion == "%":
+            out.append("%")
+            continue
+        try:
+            width = m.group("width") or ""
+            if width == "*":
+                width = str(reader.zigzag())
+            precision = m.group("precision")
+            if precision == "*":
+                precision = str(reader.zigzag())
+            spec = "%" + m.group("flags") + width + ("." + precision if precision is not None else "")
+            if conversion in "di":
+                out.append((spec + "d") % reader.zigzag())
+            elif conversion in "ouxXc":
+                out.append((spec + conversion) % reader.varint())
+            elif conversion in "fFeEgGaA":
+                value = struct.unpack("<d", reader.raw(8))[0]
+                out.append((spec + ("e" if conversion in "aA" else conversion)) % value)
+            elif conversion == "p":
+                out.append("0x%x" % reader.varint())
+            elif conversion == "s":
+                out.append((spec + "s") % reader.raw(reader.byte()).decode("utf-8", "replace"))
+        except IndexError:
+            # Arguments were truncated on the device - rest of the format verbatim
+            out.append(fmt[m.start():])
+            return "".join(out)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+class Decoder:
+    def __init__(self, strings):
+        self.strings = strings
+        self.formats = {}
+        self.last_us = None
+        self.wall_offset_us = None
+        self.utc_offset_s = 0
+        self.dropped = 0
+        self.held = []
+        self.holding = True
+        self.binary_bytes = 0
+        self.text_bytes = 0
+        self.records = 0
+        self.bad_frames = 0
+
+    def stamp(self, mono_us):
+        if self.wall_offset_us is None:
+            ms = mono_us // 1000
+            seconds = ms // 1000
+            return "000000.%02d:%02d:%02d.%03d" % (seconds // 3600 % 100, seconds // 60 % 60, seconds % 60, ms % 1000)
+        local_us = mono_us + self.wall_offset_us + self.utc_offset_s * 1000000
+        when = datetime.datetime(1970, 1, 1) + datetime.timedelta(microseconds=local_us)
+        return when.strftime("%y%m%d.%H:%M:%S") + ".%03d" % (when.microsecond // 1000)
+
+    def emit(self, mono_us, message):
+        if self.holding and self.wall_offset_us is None and (not self.held or mono_us - self.held[0][0] < HOLD_MAX_US):
+            self.held.append((mono_us, message))
+            return
+        self.holding = False
+        self.flush_held()
+        self.print_line(mono_us, message)
+
+    def print_line(self, mono_us, message):
+        line = "%s - %s" % (self.stamp(mono_us), message)
+        self.text_bytes += len(line) + 2
+        print(line, flush=True)
+
+    def flush_held(self):
+        for mono_us, message in self.held:
+            self.print_line(mono_us, message)
+        self.held = []
+
+    def frame(self, raw):
+        self.binary_bytes += len(raw) + 1
+        data = cobs_decode(raw)
+        if not data or len(data) < 2 or crc8(data[:-1]) != data[-1]:
+            # Not one of ours - boot ROM or panic output between frames
+            text = raw.decode("ascii", "replace").strip()
+            if text:
+                self.bad_frames += 1
+                print(text, flush=True)
+            return
+        reader = Reader(data[:-1])
+        kind = reader.byte()
+        try:
+            if kind == FRAME_SYNC:
+                if reader.raw(3) != b"SF\x01":
+                    raise ValueError("unsupported log frame version")
+                mono_us = reader.varint()
+                synced = reader.byte()
+                wall_offset_us = reader.zigzag()
+                self.utc_offset_s = reader.zigzag()
+                dropped = reader.varint()
+                if synced:
+                    self.wall_offset_us = wall_offset_us
+                    self.flush_held()
+                if dropped > self.dropped:
+                    self.emit(mono_us, "[LOG] %d records dropped on the device" % (dropped - self.dropped))
+                self.dropped = dropped
+                self.formats = {}
+                self.last_us = mono_us // 1000 * 1000
+            elif kind == FRAME_DEFINE:
+                slot = reader.byte()
+                self.formats[slot] = struct.unpack("<I", reader.raw(4))[0]
+            elif kind < 0x80:
+                slot = kind & ~FRAME_TRUNCATED
+                delta = reader.zigzag()
+                if self.last_us is None or slot not in self.formats:
+                    return  # Joined mid-stream; wait for the next sync
+                self.last_us += delta * 1000
+                fmt = self.strings.lookup(self.formats[slot])
+                if fmt is None:
+                    message = "<unknown format 0x%08x - wrong ELF?>" % self.formats[slot]
+                else:
+                    message = render(fmt, reader)
+                self.records += 1
+                self.emit(self.last_us, message)
+        except (IndexError, ValueError) as e:
+            self.bad_frames += 1
+            print("<bad frame: %s>" % e, file=sys.stderr)
+
+    def summary(self):
+        self.flush_held()
+        ratio = self.text_bytes / self.binary_bytes if self.binary_bytes else 0
+        print("%d records, %d binary bytes -> %d text bytes (%.1fx), %d dropped on device, %d bad frames" % (
+            self.records, self.binary_bytes, self.text_bytes, ratio, self.dropped, self.bad_frames), file=sys.stderr)
+
+
+def chunks(stream):
+    pending = bytearray()
+    while True:
+        data = stream.read(max(1, stream.in_waiting)) if hasattr(stream, "in_waiting") else stream.read(4096)
+        if not data:
+            return
+        pending += data
+        while True:
+            end = pending.find(b"\0")
+            if end < 0:
+                break
+            yield bytes(pending[:end])
+            del pending[:end + 1]
+
+
+def main():
+    args = sys.argv[1:]
+    if not args:
+        print(__doc__)
+        sys.exit(1)
+    decoder = Decoder(FormatStrings(args[0]))
+    if "--port" in args:
+        import serial
+        baud = int(args[args.index("--baud") + 1]) if "--baud" in args else 115200
+        stream = serial.Serial(args[args.index("--port") + 1], baud)
+    elif len(args) > 1 and args[1] != "-":
+        stream = open(args[1], "rb")
+    else:
+        stream = sys.stdin.buffer
+    try:
+        for raw in chunks(stream):
+            if raw:
+                decoder.frame(raw)
+    except KeyboardInterrupt:
+        pass
+    decoder.summary()
+
+
+if __name__ == "__main__":
+    main()
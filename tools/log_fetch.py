@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""Download the device's persistent flash log.
+
+Usage: python3 tools/log_fetch.py <device-ip> [-o output] [--elf firmware.elf]
+
+Fetches GET /log (the whole LittleFS log ring, oldest bytes first) and writes it
+to the output file (default sani_flush_<ip>_<time>.log). Text builds store the
+same lines the serial port shows. Binary builds (LOG_BINARY_MODE=1) store the
+tokenized frames; pass --elf to also decode them to text with log_decode.py.
+The first line may be cut short where the ring wrapped.
+"""
+import http.client
+import os
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+
+def fetch(host, path):
+    conn = http.client.HTTPConnection(host, 80, timeout=30)
+    conn.request("GET", "/log")
+    resp = conn.getresponse()
+    if resp.status != 200:
+        raise SystemExit("GET /log returned %d %s" % (resp.status, resp.reason))
+    log_format = resp.getheader("X-Log-Format", "text")
+    total = 0
+    start = time.perf_counter()
+    with open(path, "wb") as out:
+        while True:
+            data = resp.read(4096)
+            if not data:
+                break
+            out.write(data)
+            total += len(data)
+            print("\r%d KB" % (total // 1024), end="", file=sys.stderr, flush=True)
+    conn.close()
+    elapsed = time.perf_counter() - start
+    print("\r%d bytes (%s) in %.1fs -> %s" % (total, log_format, elapsed, path), file=sys.stderr)
+    return log_format
+
+
+def main():
+    args = sys.argv[1:]
+    if not args or args[0].startswith("-"):
+        print(__doc__)
+        sys.exit(1)
+    host = args[0]
+    output = args[args.index("-o") + 1] if "-o" in args else \
+        "sani_flush_%s_%s.log" % (host.replace(":", "_"), time.strftime("%Y%m%d_%H%M%S"))
+    elf = args[args.index("--elf") + 1] if "--elf" in args else None
+
+    log_format = fetch(host, output)
+    if log_format == "binary":
+        if not elf:
+            print("Binary log - decode with: python3 tools/log_decode.py <firmware.elf> %s" % output, file=sys.stderr)
+            return
+        import log_decode
+        decoder = log_decode.Decoder(log_decode.FormatStrings(elf))
+        with open(output, "rb") as stream:
+            for raw in log_decode.chunks(stream):
+                if raw:
+                    decoder.frame(raw)
+        decoder.summary()
+
+
+if __name__ == "__main__":
+    main()
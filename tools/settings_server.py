@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""Local stand-in for the settings sync server, plus a client to change rigs remotely.
+
+Usage:
+  python3 tools/settings_server.py serve [--port 5000] [--state settings.json]
+  python3 tools/settings_server.py show <host:port> [device]
+  python3 tools/settings_server.py set <host:port> <device|--all> key=value [key=value ...]
+
+serve runs the server side of settings_sync.h. Point uploadServerURL at this machine
+(any path on the same host:port) and each rig creates its document on first contact,
+then polls it once a minute. One document per device:
+  {"revision": 7, "settings": {"flush_workflow_repeat_sec": 120, ...}}
+served with ETag "7". Routes:
+  GET   /settings                 all documents, {"devices": {"<id>": document}}
+  GET   /settings?device=<id>     404 unknown, 304 when If-None-Match matches
+  PATCH /settings?device=<id>     {"settings": {changed fields}}, needs If-Match (428/412)
+  PUT   /settings?device=<id>     whole document; If-None-Match: * creates, If-Match replaces
+Every accepted change bumps the revision and answers with the merged document.
+Keys are the settings' /status names (SETTINGS_TABLE in settings_system.h); the
+server stores whatever integer fields it is given and the rig clamps on arrival.
+--state keeps the documents in a JSON file across restarts.
+
+set changes fields on one rig or on every rig the server knows, with the same
+If-Match handshake the firmware uses (retrying on 412); rigs pick the change up
+on their next poll.
+"""
+import http.client
+import http.server
+import json
+import os
+import sys
+import threading
+import urllib.parse
+
+
+class SettingsStore:
+    def __init__(self, path=None):
+        self.path = path
+        self.lock = threading.Lock()
+        self.documents = {}
+        if path and os.path.exists(path):
+            with open(path) as f:
+                self.documents = json.load(f)
+
+    def save(self):
+        if not self.path:
+            return
+        tmp = self.path + ".tmp"
+        with open(tmp, "w") as f:
+            json.dump(self.documents, f, indent=1, sort_keys=True)
+        os.replace(tmp, self.path)
+
+
+def etag_of(document):
+    return '"%d"' % document["revision"]
+
+
+def valid_fields(body):
+    fields = body.get("settings") if isinstance(body, dict) else None
+    if not isinstance(fields, dict):
+        return None
+    for value in fields.values():
+        if not isinstance(value, int) or isinstance(value, bool):
+            return None
+    return fields
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"  # Keep-alive, like the firmware's upload connection
+    store = None
+
+    def log_message(self, fmt, *args):
+        sys.stderr.write("%s %s\n" % (self.address_string(), fmt % args))
+
+    def reply(self, status, document=None, extra=None):
+        body = json.dumps(extra if extra is not None else document, separators=(",", ":")).encode() \
+            if (document is not None or extra is not None) else b""
+        self.send_response(status)
+        if document is not None:
+            self.send_header("ETag", etag_of(document))
+        if body:
+            self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def route(self):
+        url = urllib.parse.urlsplit(self.path)
+        if url.path.rstrip("/").rsplit("/", 1)[-1] != "settings":
+            return None, False
+        device = urllib.parse.parse_qs(url.query).get("device", [None])[0]
+        return device, True
+
+    def read_body(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        try:
+            return json.loads(self.rfile.read(length) or b"null")
+        except ValueError:
+            return None
+
+    def do_GET(self):
+        device, ok = self.route()
+        if not ok:
+            return self.reply(404)
+        with self.store.lock:
+            if device is None:
+                return self.reply(200, extra={"devices": self.store.documents})
+            document = self.store.documents.get(device)
+            if document is None:
+                return self.reply(404)
+            if self.headers.get("If-None-Match") == etag_of(document):
+                self.send_response(304)
+                self.send_header("ETag", etag_of(document))
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            return self.reply(200, document)
+
+    def do_PATCH(self):
+        device, ok = self.route()
+        body = self.read_body()
+        if not ok or device is None:
+            return self.reply(404)
+        fields = valid_fields(body)
+        if fields is None:
+            return self.reply(400)
+        with self.store.lock:
+            document = self.store.documents.get(device)
+            if document is None:
+                return self.reply(404)
+            if_match = self.headers.get("If-Match")
+            if not if_match:
+                return self.reply(428)
+            if if_match != etag_of(document):
+                return self.reply(412, document)
+            changed = {k: v for k, v in fields.items() if document["settings"].get(k) != v}
+            if changed:
+                document["settings"].update(changed)
+                document["revision"] += 1
+                self.store.save()
+                self.log_message("%s revision %d: %s", device, document["revision"], changed)
+            return self.reply(200, document)
+
+    def do_PUT(self):
+        device, ok = self.route()
+        body = self.read_body()
+        if not ok or device is None:
+            return self.reply(404)
+        fields = valid_fields(body)
+        if fields is None:
+            return self.reply(400)
+        with self.store.lock:
+            document = self.store.documents.get(device)
+            if self.headers.get("If-None-Match") == "*" and document is not None:
+                return self.reply(412, document)
+            if_match = self.headers.get("If-Match")
+            if if_match and (document is None or if_match != etag_of(document)):
+                return self.reply(412, document)
+            created = document is None
+            revision = 1 if created else document["revision"] + 1
+            document = {"revision": revision, "settings": dict(fields)}
+            self.store.documents[device] = document
+            self.store.save()
+            self.log_message("%s %s at revision %d", device, "created" if created else "replaced", revision)
+            return self.reply(201 if created else 200, document)
+
+
+def serve(args):
+    port = int(args[args.index("--port") + 1]) if "--port" in args else 5000
+    state = args[args.index("--state") + 1] if "--state" in args else None
+    Handler.store = SettingsStore(state)
+    server = http.server.ThreadingHTTPServer(("", port), Handler)
+    print("Settings server on port %d (%d documents)" % (port, len(Handler.store.documents)), file=sys.stderr)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+def request(host, method, device=None, body=None, headers=None):
+    conn = http.client.HTTPConnection(host, timeout=10)
+    path = "/settings" + ("?device=" + urllib.parse.quote(device) if device else "")
+    data = json.dumps(body).encode() if body is not None else None
+    all_headers = dict(headers or {})
+    if data is not None:
+        all_headers["Content-Type"] = "application/json"
+    conn.request(method, path, body=data, headers=all_headers)
+    resp = conn.getresponse()
+    raw = resp.read()
+    conn.close()
+    return resp.status, resp.getheader("ETag"), json.loads(raw) if raw else None
+
+
+def show(args):
+    if not args:
+        raise SystemExit(__doc__)
+    status, etag, document = request(args[0], "GET", args[1] if len(args) > 1 else None)
+    if status != 200:
+        raise SystemExit("GET returned %d" % status)
+    print(json.dumps(document, indent=2, sort_keys=True))
+
+
+def set_fields(host, device, fields):
+    for _ in range(5):
+        status, etag, document = request(host, "GET", device)
+        if status != 200:
+            raise SystemExit("%s: GET returned %d" % (device, status))
+        status, etag, document = request(host, "PATCH", device, {"settings": fields}, {"If-Match": etag})
+        if status == 200:
+            print("%s: revision %d" % (device, document["revision"]))
+            return
+        if status != 412:
+            raise SystemExit("%s: PATCH returned %d" % (device, status))
+    raise SystemExit("%s: document kept changing - gave up" % device)
+
+
+def set_command(args):
+    if len(args) < 3:
+        raise SystemExit(__doc__)
+    host, target = args[0], args[1]
+    fields = {}
+    for pair in args[2:]:
+        key, _, value = pair.partition("=")
+        try:
+            fields[key] = int(value)
+        except ValueError:
+            raise SystemExit("%s: values must be integers" % pair)
+    if target == "--all":
+        status, _, listing = request(host, "GET")
+        if status != 200:
+            raise SystemExit("GET /settings returned %d" % status)
+        devices = sorted(listing["devices"])
+    else:
+        devices = [target]
+    for device in devices:
+        set_fields(host, device, fields)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    command, args = sys.argv[1], sys.argv[2:]
+    if command == "serve":
+        serve(args)
+    elif command == "show":
+        show(args)
+    elif command == "set":
+        set_command(args)
+    else:
+        print(__doc__)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
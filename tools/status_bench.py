@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""Benchmark the device's /status endpoint from a machine on the same network.
+
+Usage: python3 tools/status_bench.py <device-ip> [requests]
+
+Runs the given number of plain GETs, then the same number of conditional GETs
+using the returned ETag, and prints requests/s, latency and bytes for each.
+The device logs its own side ([HTTP] serve time and heap delta) every 100 requests.
+"""
+import http.client
+import sys
+import time
+
+
+def run(host, count, etag=None):
+    latencies = []
+    codes = {}
+    total_bytes = 0
+    last_etag = etag
+    start = time.perf_counter()
+    for _ in range(count):
+        headers = {"If-None-Match": etag} if etag else {}
+        t0 = time.perf_counter()
+        conn = http.client.HTTPConnection(host, 80, timeout=5)
+        conn.request("GET", "/status", headers=headers)
+        resp = conn.getresponse()
+        body = resp.read()
+        conn.close()
+        latencies.append((time.perf_counter() - t0) * 1000)
+        codes[resp.status] = codes.get(resp.status, 0) + 1
+        total_bytes += len(body)
+        last_etag = resp.getheader("ETag") or last_etag
+    elapsed = time.perf_counter() - start
+    latencies.sort()
+    print("  %d requests in %.2fs: %.1f req/s, codes %s" % (count, elapsed, count / elapsed, codes))
+    print("  latency ms: min %.1f  p50 %.1f  p95 %.1f  max %.1f" % (
+        latencies[0], latencies[len(latencies) // 2], latencies[int(len(latencies) * 0.95)], latencies[-1]))
+    print("  body bytes: %d total, %.0f avg" % (total_bytes, total_bytes / count))
+    return last_etag
+
+
+def main():
+    if len(sys.argv) < 2:
+        print(__doc__)
+        sys.exit(1)
+    host = sys.argv[1]
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 200
+    print("Full responses:")
+    etag = run(host, count)
+    print("Conditional (If-None-Match: %s):" % etag)
+    run(host, count, etag)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,223 @@
+#include "upload_queue.h"
+#include "draw_functions.h" // For writeLog
+#include "storage.h"
+#include <LittleFS.h>
+
+static_assert(sizeof(UploadRecord) <= UPLOAD_RECORD_SIZE, "UploadRecord does not fit in a ring slot");
+
+static const uint32_t UPLOAD_QUEUE_MAGIC = 0x55514631; // "UQF1"
+static const uint16_t UPLOAD_QUEUE_VERSION = 1;
+static const uint16_t UPLOAD_RECORD_MAGIC = 0xA55A;
+static const size_t UPLOAD_HEADER_SIZE = 32;
+
+// Ring file header - lives at offset 0, slots follow
+struct UploadQueueHeader
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t capacity;
+  uint32_t head;      // Slot index of the oldest record
+  uint32_t count;     // Records currently stored
+  uint32_t bootCount; // Incremented once per boot, part of every idempotency key
+  uint32_t dropped;   // Records discarded because the ring was full
+  uint32_t nextSeq;
+  uint32_t reserved;
+};
+
+static_assert(sizeof(UploadQueueHeader) <= UPLOAD_HEADER_SIZE, "Header too large");
+
+static File queueFile;
+static UploadQueueHeader header;
+static volatile int pendingUploads = 0;
+static bool queueReady = false;
+
+static size_t slotOffset(uint32_t slot)
+{
+  return UPLOAD_HEADER_SIZE + (size_t)slot * UPLOAD_RECORD_SIZE;
+}
+
+static bool writeHeader()
+{
+  if (!queueFile.seek(0))
+    return false;
+  bool ok = queueFile.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+  queueFile.flush();
+  pendingUploads = header.count;
+  return ok;
+}
+
+static bool writeSlot(uint32_t slot, const UploadRecord &record)
+{
+  if (!queueFile.seek(slotOffset(slot)))
+    return false;
+  return queueFile.write((const uint8_t *)&record, sizeof(record)) == sizeof(record);
+}
+
+static bool readSlot(uint32_t slot, UploadRecord &record)
+{
+  if (!queueFile.seek(slotOffset(slot)))
+    return false;
+  if (queueFile.read((uint8_t *)&record, sizeof(record)) != sizeof(record))
+    return false;
+  return record.magic == UPLOAD_RECORD_MAGIC;
+}
+
+// Create a fresh ring file, preallocated to its full size so flash usage never grows
+static bool createQueueFile()
+{
+  queueFile = LittleFS.open(UPLOAD_QUEUE_FILE, FILE_WRITE);
+  if (!queueFile)
+    return false;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = UPLOAD_QUEUE_MAGIC;
+  header.version = UPLOAD_QUEUE_VERSION;
+  header.capacity = UPLOAD_QUEUE_CAPACITY;
+
+  uint8_t zeros[64];
+  memset(zeros, 0, sizeof(zeros));
+  size_t total = slotOffset(UPLOAD_QUEUE_CAPACITY);
+  for (size_t written = 0; written < total; written += sizeof(zeros))
+  {
+    queueFile.write(zeros, min(sizeof(zeros), total - written));
+  }
+  queueFile.close();
+
+  queueFile = LittleFS.open(UPLOAD_QUEUE_FILE, "r+");
+  return queueFile && writeHeader();
+}
+
+// Without the ring file there is no persisted boot count. A random boot id with the
+// top bit set still keeps this boot's idempotency keys apart from every other boot's.
+static void useRandomBootId()
+{
+  header.bootCount = esp_random() | 0x80000000u;
+  writeLog("[UPLOADQ] Using random boot id %08lx", (unsigned long)header.bootCount);
+}
+
+bool uploadQueueBegin()
+{
+  if (queueReady)
+    return true;
+
+  if (!storageBegin())
+  {
+    writeLog("[UPLOADQ] LittleFS mount failed - durable queue disabled");
+    useRandomBootId();
+    return false;
+  }
+
+  bool valid = false;
+  if (LittleFS.exists(UPLOAD_QUEUE_FILE))
+  {
+    queueFile = LittleFS.open(UPLOAD_QUEUE_FILE, "r+");
+    if (queueFile && queueFile.read((uint8_t *)&header, sizeof(header)) == sizeof(header))
+    {
+      valid = header.magic == UPLOAD_QUEUE_MAGIC && header.version == UPLOAD_QUEUE_VERSION &&
+              header.capacity == UPLOAD_QUEUE_CAPACITY && header.head < UPLOAD_QUEUE_CAPACITY &&
+              header.count <= UPLOAD_QUEUE_CAPACITY;
+    }
+    if (!valid)
+    {
+      writeLog("[UPLOADQ] Ring file invalid or resized - recreating");
+      if (queueFile)
+        queueFile.close();
+    }
+  }
+
+  if (!valid && !createQueueFile())
+  {
+    writeLog("[UPLOADQ] Could not create %s - durable queue disabled", UPLOAD_QUEUE_FILE);
+    useRandomBootId();
+    return false;
+  }
+
+  header.bootCount++;
+  writeHeader();
+  queueReady = true;
+  writeLog("[UPLOADQ] Ready - %lu pending, %lu dropped, boot #%lu", (unsigned long)header.count,
+    (unsigned long)header.dropped, (unsigned long)header.bootCount);
+  return true;
+}
+
+bool uploadQueuePush(const UploadRecord &record)
+{
+  if (!queueReady)
+    return false;
+
+  UploadRecord stored = record;
+  stored.magic = UPLOAD_RECORD_MAGIC;
+  stored.seq = header.nextSeq;
+
+  // When full this is the oldest record's slot - bounded flash usage
+  uint32_t slot = (header.head + header.count) % UPLOAD_QUEUE_CAPACITY;
+  if (!writeSlot(slot, stored))
+  {
+    writeLog("[UPLOADQ] Write to slot %lu failed", (unsigned long)slot);
+    return false;
+  }
+  header.nextSeq++;
+
+  // Only now that the new record is on flash is the oldest one given up
+  if (header.count >= UPLOAD_QUEUE_CAPACITY)
+  {
+    header.head = (header.head + 1) % UPLOAD_QUEUE_CAPACITY;
+    header.dropped++;
+    writeLog("[UPLOADQ] Queue full - oldest record dropped (total dropped: %lu)", (unsigned long)header.dropped);
+  }
+  else
+  {
+    header.count++;
+  }
+  return writeHeader();
+}
+
+bool uploadQueuePeek(UploadRecord &record)
+{
+  if (!queueReady || header.count == 0)
+    return false;
+
+  if (!readSlot(header.head, record))
+  {
+    // Corrupt slot - skip it rather than wedging the queue
+    writeLog("[UPLOADQ] Corrupt record at slot %lu - skipping", (unsigned long)header.head);
+    uploadQueuePop();
+    return false;
+  }
+  return true;
+}
+
+bool uploadQueuePop()
+{
+  if (!queueReady || header.count == 0)
+    return false;
+
+  header.head = (header.head + 1) % UPLOAD_QUEUE_CAPACITY;
+  header.count--;
+  return writeHeader();
+}
+
+bool uploadQueueUpdateHead(const UploadRecord &record)
+{
+  if (!queueReady || header.count == 0)
+    return false;
+
+  bool ok = writeSlot(header.head, record);
+  queueFile.flush();
+  return ok;
+}
+
+int uploadQueuePending()
+{
+  return pendingUploads;
+}
+
+uint32_t uploadQueueDropped()
+{
+  return header.dropped;
+}
+
+uint32_t uploadQueueBootCount()
+{
+  return header.bootCount;
+}
@@ -0,0 +1,50 @@
+#ifndef UPLOAD_QUEUE_H
+#define UPLOAD_QUEUE_H
+
+#include <Arduino.h>
+#include "network_task.h"
+
+// Durable outbound request queue.
+// Requests that cannot reach the upload server are kept in a fixed-size ring file
+// on LittleFS so captures survive server outages and reboots. Records are fixed
+// size, so flash usage is bounded by UPLOAD_QUEUE_CAPACITY * UPLOAD_RECORD_SIZE;
+// when full the oldest record is dropped. Only the network task touches the queue.
+
+#define UPLOAD_QUEUE_FILE "/upload_queue.bin"
+#define UPLOAD_QUEUE_CAPACITY 64      // Records kept on flash (64 x 512 B = 32 KB)
+#define UPLOAD_RECORD_SIZE 512
+#define UPLOAD_BODY_MAX 440           // JSON body for non-capture records
+
+enum UploadType : uint8_t
+{
+  UPLOAD_CAPTURE = 1,   // CameraRequest - sent via the batch/per-camera routes
+  UPLOAD_TELEMETRY = 2  // Pre-serialized JSON body for the telemetry route
+};
+
+struct UploadRecord
+{
+  uint16_t magic;
+  UploadType type;
+  uint8_t attempts;
+  uint32_t seq;
+  union
+  {
+    CameraRequest capture;
+    struct
+    {
+      uint16_t length;
+      char body[UPLOAD_BODY_MAX];
+    } telemetry;
+  };
+};
+
+bool uploadQueueBegin();                           // Mount LittleFS and open/validate the ring file
+bool uploadQueuePush(const UploadRecord &record);  // Append, dropping the oldest record when full
+bool uploadQueuePeek(UploadRecord &record);        // Oldest record, false when empty
+bool uploadQueuePop();                             // Remove the oldest record
+bool uploadQueueUpdateHead(const UploadRecord &record); // Rewrite the oldest record (attempt count)
+int uploadQueuePending();                          // Safe to call from any task
+uint32_t uploadQueueDropped();
+uint32_t uploadQueueBootCount();                   // Persisted boot count, random id when the queue is unavailable
+
+#endif // UPLOAD_QUEUE_H
@@ -0,0 +1,504 @@
+#include "usage_stats.h"
+#include "event_bus.h"
+#include "log_service.h"
+#include "time_base.h"
+#include "time_service.h"
+#include "storage.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include <LittleFS.h>
+#include <time.h>
+
+static const uint32_t USAGE_CHECKPOINT_MAGIC = 0x55534731; // "USG1"
+static const uint16_t USAGE_CHECKPOINT_VERSION = 1;
+static const uint32_t SECONDS_PER_DAY = 86400;
+
+struct UsageBucket
+{
+  uint32_t key; // Local minute/hour/day number since 1970; 0 = never used
+  uint16_t flushes;
+  uint16_t images;
+  uint32_t wasteMl;
+};
+
+// Everything the rollups read. Checkpointed as one block so the running sums always
+// come back together with the buckets they summarize.
+struct UsageState
+{
+  uint32_t minuteKey; // Newest bucket of each ring, 0 before the first event
+  uint32_t hourKey;
+  uint32_t dayKey;
+  uint32_t firstDayKey;
+  UsageBucket minutes[USAGE_MINUTE_BUCKETS];
+  UsageBucket hours[USAGE_HOUR_BUCKETS];
+  UsageBucket days[USAGE_DAY_BUCKETS];
+  uint32_t minuteRingFlushes;    // = sum of minutes[].flushes
+  uint32_t hourOfDayFlushes[24]; // = hours[].flushes folded by local hour
+  uint32_t dayRingFlushes;       // = sum of days[].flushes
+  uint32_t weekKey;
+  uint32_t weekFlushes;
+  uint32_t monthKey; // year * 12 + month
+  uint32_t monthFlushes;
+  uint32_t firstFlushSec; // Today's first and last flush, local seconds
+  uint32_t lastFlushSec;
+};
+
+struct UsageCheckpoint
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t size;
+  UsageState state;
+  uint32_t crc; // CRC-32 over state
+};
+
+struct HeldEvent
+{
+  uint64_t atUs;
+  int32_t value;
+  AppEventType type;
+};
+
+enum RestoreState : uint8_t
+{
+  RESTORE_WAITING, // Network task has not read the checkpoint yet
+  RESTORE_READY,   // checkpoint holds the restored state for the loop task
+  RESTORE_DONE
+};
+
+// Loop task only
+static UsageState state;
+static HeldEvent held[USAGE_HOLD_EVENTS];
+static uint8_t heldCount = 0;
+static bool dirty = false;
+static uint64_t lastServiceMs = 0;
+static uint64_t lastCheckpointMs = 0;
+static int64_t offsetHour = -1; // UTC hour the cached zone offset belongs to
+static int32_t zoneOffsetSec = 0;
+
+// Handed between the loop task and the network task under usageLock
+static portMUX_TYPE usageLock = portMUX_INITIALIZER_UNLOCKED;
+static UsageCheckpoint checkpoint;
+static RestoreState restoreState = RESTORE_WAITING;
+static bool checkpointQueued = false;
+static UsageStoreStats storeStats = {};
+
+static bool localSecondsAt(uint64_t monoUs, uint32_t *localSec)
+{
+  int64_t wallUs;
+  if (!monoToWallMicros(monoUs, &wallUs))
+    return false;
+  time_t utc = (time_t)(wallUs / 1000000LL);
+  if (utc / 3600 != offsetHour) // Zone offset only changes on the hour
+  {
+    zoneOffsetSec = localUtcOffsetSeconds(utc);
+    offsetHour = utc / 3600;
+  }
+  *localSec = (uint32_t)(utc + zoneOffsetSec);
+  return true;
+}
+
+static uint32_t weekOf(uint32_t day)
+{
+  return (day + 3) / 7; // 1970-01-01 was a Thursday; weeks start on Monday
+}
+
+static uint32_t monthOf(uint32_t day)
+{
+  time_t t = (time_t)day * SECONDS_PER_DAY;
+  struct tm date;
+  gmtime_r(&t, &date); // Day numbers are already local
+  return (uint32_t)(date.tm_year * 12 + date.tm_mon);
+}
+
+static void evictMinute(const UsageBucket &bucket)
+{
+  state.minuteRingFlushes -= bucket.flushes;
+}
+
+static void evictHour(const UsageBucket &bucket)
+{
+  state.hourOfDayFlushes[bucket.key % 24] -= bucket.flushes;
+}
+
+static void evictDay(const UsageBucket &bucket)
+{
+  state.dayRingFlushes -= bucket.flushes;
+}
+
+// Moves a ring's newest bucket up to key, clearing every slot it passes and taking
+// the old contents out of the running sums. A gap longer than the ring clears it once.
+static void advanceRing(UsageBucket *ring, uint16_t size, uint32_t &headKey, uint32_t key,
+  void (*evict)(const UsageBucket &))
+{
+  if (headKey != 0 && key <= headKey)
+    return;
+  uint32_t first = (headKey == 0 || key - headKey > size) ? key - size + 1 : headKey + 1;
+  for (uint32_t k = first; k <= key; k++)
+  {
+    UsageBucket &bucket = ring[k % size];
+    if (bucket.key != 0)
+      evict(bucket);
+    bucket = { k, 0, 0, 0 };
+  }
+  headKey = key;
+}
+
+static UsageBucket *bucketFor(UsageBucket *ring, uint16_t size, uint32_t key)
+{
+  UsageBucket &bucket = ring[key % size];
+  return bucket.key == key ? &bucket : nullptr;
+}
+
+static void advanceTo(uint32_t localSec)
+{
+  uint32_t day = localSec / SECONDS_PER_DAY;
+  advanceRing(state.minutes, USAGE_MINUTE_BUCKETS, state.minuteKey, localSec / 60, evictMinute);
+  advanceRing(state.hours, USAGE_HOUR_BUCKETS, state.hourKey, localSec / 3600, evictHour);
+  if (state.dayKey != 0 && day <= state.dayKey)
+    return;
+
+  advanceRing(state.days, USAGE_DAY_BUCKETS, state.dayKey, day, evictDay);
+  if (state.firstDayKey == 0)
+    state.firstDayKey = day;
+  state.firstFlushSec = 0;
+  state.lastFlushSec = 0;
+  if (weekOf(day) != state.weekKey)
+  {
+    state.weekKey = weekOf(day);
+    state.weekFlushes = 0;
+  }
+  if (monthOf(day) != state.monthKey)
+  {
+    state.monthKey = monthOf(day);
+    state.monthFlushes = 0;
+  }
+}
+
+// Events older than the newest bucket (held ones, or a clock stepped back by a
+// re-sync) still count in whichever rings reach back far enough
+static void place(uint32_t localSec, AppEventType type, int32_t value)
+{
+  advanceTo(localSec);
+
+  uint32_t day = localSec / SECONDS_PER_DAY;
+  UsageBucket *minute = bucketFor(state.minutes, USAGE_MINUTE_BUCKETS, localSec / 60);
+  UsageBucket *hour = bucketFor(state.hours, USAGE_HOUR_BUCKETS, localSec / 3600);
+  UsageBucket *today = bucketFor(state.days, USAGE_DAY_BUCKETS, day);
+  if (!minute && !hour && !today)
+  {
+    storeStats.stale++;
+    return;
+  }
+
+  switch (type)
+  {
+  case APP_EVENT_FLUSH:
+    if (minute)
+    {
+      minute->flushes++;
+      state.minuteRingFlushes++;
+    }
+    if (hour)
+    {
+      hour->flushes++;
+      state.hourOfDayFlushes[hour->key % 24]++;
+    }
+    if (today)
+    {
+      today->flushes++;
+      state.dayRingFlushes++;
+    }
+    if (weekOf(day) == state.weekKey)
+      state.weekFlushes++;
+    if (day == state.dayKey || monthOf(day) == state.monthKey)
+      state.monthFlushes++;
+    if (day == state.dayKey)
+    {
+      if (state.firstFlushSec == 0 || localSec < state.firstFlushSec)
+        state.firstFlushSec = localSec;
+      if (localSec > state.lastFlushSec)
+        state.lastFlushSec = localSec;
+    }
+    break;
+  case APP_EVENT_IMAGE:
+    if (minute)
+      minute->images++;
+    if (hour)
+      hour->images++;
+    if (today)
+      today->images++;
+    break;
+  case APP_EVENT_WASTE_DOSE:
+    if (minute)
+      minute->wasteMl += value;
+    if (hour)
+      hour->wasteMl += value;
+    if (today)
+      today->wasteMl += value;
+    break;
+  default:
+    break;
+  }
+  dirty = true;
+}
+
+static bool readyToPlace()
+{
+  RestoreState restore;
+  portENTER_CRITICAL(&usageLock);
+  restore = restoreState;
+  portEXIT_CRITICAL(&usageLock);
+  return restore == RESTORE_DONE && timeServiceSynced();
+}
+
+static void onUsageEvent(const AppEvent &event)
+{
+  uint64_t nowUs = monoMicros();
+  storeStats.recorded++;
+
+  uint32_t localSec;
+  if (heldCount == 0 && readyToPlace() && localSecondsAt(nowUs, &localSec))
+  {
+    place(localSec, event.type, event.value);
+    return;
+  }
+
+  if (heldCount >= USAGE_HOLD_EVENTS)
+  {
+    storeStats.dropped++;
+    return;
+  }
+  held[heldCount++] = { nowUs, event.value, event.type };
+  storeStats.held++;
+}
+
+void usageStatsBegin()
+{
+  eventBusSubscribe(APP_EVENT_BIT(APP_EVENT_FLUSH) | APP_EVENT_BIT(APP_EVENT_IMAGE) |
+      APP_EVENT_BIT(APP_EVENT_WASTE_DOSE),
+    onUsageEvent);
+}
+
+// Takes the restored state once the network task has read it, or gives up waiting
+static void settleRestore(uint64_t nowMs)
+{
+  portENTER_CRITICAL(&usageLock);
+  RestoreState restore = restoreState;
+  if (restore == RESTORE_READY)
+  {
+    memcpy(&state, &checkpoint.state, sizeof(state));
+    storeStats.restored = true;
+    restoreState = RESTORE_DONE;
+  }
+  else if (restore == RESTORE_WAITING && nowMs > USAGE_RESTORE_WAIT_MS)
+  {
+    restoreState = RESTORE_DONE;
+  }
+  portEXIT_CRITICAL(&usageLock);
+
+  if (restore == RESTORE_READY)
+  {
+    writeLog("[USAGE] Restored rollups - today %u flushes, this month %lu", state.days[state.dayKey % USAGE_DAY_BUCKETS].flushes,
+      (unsigned long)state.monthFlushes);
+  }
+  else if (restore == RESTORE_WAITING && nowMs > USAGE_RESTORE_WAIT_MS)
+  {
+    writeLog("[USAGE] No checkpoint read after %ds - starting fresh rollups", USAGE_RESTORE_WAIT_MS / 1000);
+  }
+}
+
+static void queueCheckpoint(uint64_t nowMs)
+{
+  portENTER_CRITICAL(&usageLock);
+  bool busy = checkpointQueued;
+  portEXIT_CRITICAL(&usageLock);
+  if (busy)
+    return; // The network task is still writing the last one
+
+  checkpoint.magic = USAGE_CHECKPOINT_MAGIC;
+  checkpoint.version = USAGE_CHECKPOINT_VERSION;
+  checkpoint.size = sizeof(UsageState);
+  memcpy(&checkpoint.state, &state, sizeof(state));
+  checkpoint.crc = esp_rom_crc32_le(0, (const uint8_t *)&checkpoint.state, sizeof(checkpoint.state));
+
+  portENTER_CRITICAL(&usageLock);
+  checkpointQueued = true;
+  portEXIT_CRITICAL(&usageLock);
+  dirty = false;
+  lastCheckpointMs = nowMs;
+}
+
+void usageStatsService()
+{
+  uint64_t nowMs = monoMillis();
+  if (nowMs - lastServiceMs < 1000)
+    return;
+  lastServiceMs = nowMs;
+
+  settleRestore(nowMs);
+  if (!readyToPlace())
+    return;
+
+  for (uint8_t i = 0; i < heldCount; i++)
+  {
+    uint32_t localSec;
+    if (localSecondsAt(held[i].atUs, &localSec))
+      place(localSec, held[i].type, held[i].value);
+  }
+  heldCount = 0;
+
+  uint32_t nowSec;
+  if (localSecondsAt(monoMicros(), &nowSec))
+    advanceTo(nowSec); // Today, this week and this month read 0 once they roll over without events
+
+  if (dirty && nowMs - lastCheckpointMs >= USAGE_CHECKPOINT_INTERVAL_MS)
+    queueCheckpoint(nowMs);
+}
+
+void getUsageRollup(UsageRollup &rollup)
+{
+  memset(&rollup, 0, sizeof(rollup)); // Callers hash it for the /status ETag
+  rollup.peakUsageHour = -1;
+
+  uint32_t nowSec;
+  if (!readyToPlace() || !localSecondsAt(monoMicros(), &nowSec))
+    return;
+  advanceTo(nowSec);
+  rollup.valid = true;
+
+  const UsageBucket &today = state.days[state.dayKey % USAGE_DAY_BUCKETS];
+  rollup.flushesLastHour = state.minuteRingFlushes;
+  rollup.dailyFlushes = today.flushes;
+  rollup.dailyImages = today.images;
+  rollup.dailyWasteMl = today.wasteMl;
+  rollup.weeklyFlushes = state.weekFlushes;
+  rollup.monthlyFlushes = state.monthFlushes;
+  if (today.flushes >= 2)
+    rollup.averageFlushIntervalSec = (state.lastFlushSec - state.firstFlushSec) / (today.flushes - 1);
+
+  uint32_t completedDays = min(state.dayKey - state.firstDayKey, (uint32_t)USAGE_DAY_BUCKETS - 1);
+  if (completedDays > 0)
+    rollup.averageFlushesPerDay = (state.dayRingFlushes - today.flushes) / completedDays;
+
+  uint32_t peakFlushes = 0;
+  for (int hour = 0; hour < 24; hour++)
+  {
+    if (state.hourOfDayFlushes[hour] > peakFlushes)
+    {
+      peakFlushes = state.hourOfDayFlushes[hour];
+      rollup.peakUsageHour = hour;
+    }
+  }
+}
+
+void getUsageStoreStats(UsageStoreStats &stats)
+{
+  portENTER_CRITICAL(&usageLock);
+  stats = storeStats;
+  portEXIT_CRITICAL(&usageLock);
+}
+
+static void exportRing(Print &out, const char *name, const UsageBucket *ring, uint16_t size, uint32_t headKey,
+  uint32_t secondsPerKey)
+{
+  char row[80];
+  for (uint16_t i = 1; i <= size && headKey != 0; i++)
+  {
+    const UsageBucket &bucket = ring[(headKey + i) % size];
+    if (bucket.key == 0)
+      continue;
+    time_t start = (time_t)bucket.key * secondsPerKey;
+    struct tm date;
+    gmtime_r(&start, &date);
+    char stamp[20];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M", &date);
+    snprintf(row, sizeof(row), "%s,%s,%u,%u,%lu\r\n", name, stamp, bucket.flushes, bucket.images,
+      (unsigned long)bucket.wasteMl);
+    out.print(row);
+  }
+}
+
+// Each row goes out in one write so log lines from the log task can only land between rows
+void usageStatsExportCsv(Print &out)
+{
+  char row[96];
+  snprintf(row, sizeof(row), "# usage: %lu events, %u held, restored %d\r\n", (unsigned long)storeStats.recorded,
+    heldCount, storeStats.restored);
+  out.print(row);
+  out.print("ring,local_start,flushes,images,waste_ml\r\n");
+  exportRing(out, "day", state.days, USAGE_DAY_BUCKETS, state.dayKey, SECONDS_PER_DAY);
+  exportRing(out, "hour", state.hours, USAGE_HOUR_BUCKETS, state.hourKey, 3600);
+  out.print("# end usage\r\n");
+}
+
+void usageStatsLoadCheckpoint()
+{
+  if (!storageReady() || !LittleFS.exists(USAGE_CHECKPOINT_FILE))
+  {
+    writeLog("[USAGE] No checkpoint - rollups start empty");
+    portENTER_CRITICAL(&usageLock);
+    if (restoreState == RESTORE_WAITING)
+      restoreState = RESTORE_DONE;
+    portEXIT_CRITICAL(&usageLock);
+    return;
+  }
+
+  // The loop task does not touch checkpoint until restoreState leaves RESTORE_WAITING
+  File file = LittleFS.open(USAGE_CHECKPOINT_FILE, FILE_READ);
+  bool valid = file && file.read((uint8_t *)&checkpoint, sizeof(checkpoint)) == sizeof(checkpoint) &&
+               checkpoint.magic == USAGE_CHECKPOINT_MAGIC && checkpoint.version == USAGE_CHECKPOINT_VERSION &&
+               checkpoint.size == sizeof(UsageState) &&
+               esp_rom_crc32_le(0, (const uint8_t *)&checkpoint.state, sizeof(checkpoint.state)) == checkpoint.crc;
+  if (file)
+    file.close();
+  if (!valid)
+    writeLog("[USAGE] Checkpoint is corrupt or from another layout - rollups start empty");
+
+  portENTER_CRITICAL(&usageLock);
+  if (restoreState == RESTORE_WAITING)
+    restoreState = valid ? RESTORE_READY : RESTORE_DONE;
+  portEXIT_CRITICAL(&usageLock);
+}
+
+// Written beside the old file and renamed over it, so a reset mid-write keeps the previous checkpoint
+void usageStatsWriteCheckpoint()
+{
+  portENTER_CRITICAL(&usageLock);
+  bool queued = checkpointQueued;
+  portEXIT_CRITICAL(&usageLock);
+  if (!queued)
+    return;
+
+  uint64_t startUs = monoMicros();
+  bool ok = false;
+  if (storageReady())
+  {
+    File file = LittleFS.open(USAGE_CHECKPOINT_TMP_FILE, FILE_WRITE);
+    if (file)
+    {
+      ok = file.write((const uint8_t *)&checkpoint, sizeof(checkpoint)) == sizeof(checkpoint);
+      file.close();
+    }
+    ok = ok && LittleFS.rename(USAGE_CHECKPOINT_TMP_FILE, USAGE_CHECKPOINT_FILE);
+  }
+  uint32_t elapsedUs = (uint32_t)(monoMicros() - startUs);
+
+  portENTER_CRITICAL(&usageLock);
+  checkpointQueued = false;
+  if (ok)
+  {
+    storeStats.checkpoints++;
+    storeStats.lastCheckpointUs = elapsedUs;
+  }
+  else
+  {
+    storeStats.checkpointErrors++;
+  }
+  portEXIT_CRITICAL(&usageLock);
+
+  if (ok)
+    LOG_D(TIMER, "[USAGE] Checkpoint written (%u bytes) in %luus", (unsigned)sizeof(checkpoint), (unsigned long)elapsedUs);
+  else
+    writeLog("[USAGE] Checkpoint write failed");
+}
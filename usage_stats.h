@@ -0,0 +1,66 @@
+#ifndef USAGE_STATS_H
+#define USAGE_STATS_H
+
+#include <Arduino.h>
+
+// Time-series rollups of flushes, images and waste for daily/weekly/monthly counts.
+// Flush, image and waste-dose events from the event bus land in three fixed rings
+// of local-time buckets - minutes (last hour), hours (last 7 days) and days (last
+// 5 weeks). Each ring keeps running sums that are adjusted as events arrive and as
+// old buckets are evicted, alongside today/week/month totals, so recording is O(1)
+// and queries read the sums without walking the buckets.
+//
+// Buckets need the wall clock: events published before SNTP sync (or before the
+// checkpoint has been restored) are held, then placed at their real time.
+// The loop task owns the rollups. Every USAGE_CHECKPOINT_INTERVAL_MS with changes,
+// it copies them into a checkpoint image; the network task writes that image to
+// LittleFS and restores it at boot, so counts survive a reboot losing at most one
+// interval. Type "usage" on the serial monitor to dump the day and hour buckets as CSV.
+
+#define USAGE_MINUTE_BUCKETS 60              // Last hour
+#define USAGE_HOUR_BUCKETS 168               // Last 7 days - peak_usage_hour
+#define USAGE_DAY_BUCKETS 35                 // Last 5 weeks - average_flushes_per_day
+#define USAGE_HOLD_EVENTS 32                 // Events kept until the wall clock is known
+#define USAGE_CHECKPOINT_INTERVAL_MS 600000  // Flash write at most every 10 minutes
+#define USAGE_RESTORE_WAIT_MS 30000          // Start fresh if no checkpoint was read by then
+#define USAGE_CHECKPOINT_FILE "/usage.bin"
+#define USAGE_CHECKPOINT_TMP_FILE "/usage.tmp"
+
+struct UsageRollup
+{
+  bool valid;                       // false until the wall clock is known
+  int8_t peakUsageHour;             // Local hour with the most flushes over the last 7 days, -1 if none
+  uint32_t flushesLastHour;
+  uint32_t dailyFlushes;            // Since local midnight
+  uint32_t dailyImages;
+  uint32_t dailyWasteMl;
+  uint32_t weeklyFlushes;           // Since Monday 00:00
+  uint32_t monthlyFlushes;          // Since the 1st
+  uint32_t averageFlushIntervalSec; // Between today's first and last flush, 0 below two flushes
+  uint32_t averageFlushesPerDay;    // Over the completed days in the day ring, 0 before the first one
+};
+
+struct UsageStoreStats
+{
+  uint32_t recorded;
+  uint32_t held;            // Recorded before the clock or the checkpoint was ready
+  uint32_t dropped;         // Hold buffer full
+  uint32_t stale;           // Older than every ring - counted nowhere
+  uint32_t checkpoints;
+  uint32_t checkpointErrors;
+  uint32_t lastCheckpointUs;
+  bool restored;            // Rollups came back from flash at boot
+};
+
+void usageStatsBegin();   // Loop task, in setup() - subscribes to the event bus
+void usageStatsService(); // Loop task, every pass - places held events, rolls buckets, queues checkpoints
+void getUsageRollup(UsageRollup &rollup); // Loop task
+void getUsageStoreStats(UsageStoreStats &stats);
+void usageStatsExportCsv(Print &out);     // Day then hour buckets, oldest first
+
+// Network task: read the checkpoint once after LittleFS is mounted, then write
+// whatever the loop task has queued
+void usageStatsLoadCheckpoint();
+void usageStatsWriteCheckpoint();
+
+#endif // USAGE_STATS_H